@@ -1,6 +1,6 @@
 TEMPLATE = app
 
-QT += core gui widgets xml network
+QT += core gui widgets xml network concurrent
 CONFIG += c++11
 
 TARGET = apk-editor-studio
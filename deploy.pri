@@ -14,11 +14,21 @@ defineReplace(executable) {
     return(chmod +x $$path($$1) $$escape_expand(\\n\\t))
 }
 
+# The apktool daemon is compiled if a JDK is available; otherwise it's launched from the source (requires Java 11+):
+JAVAC_VERSION = $$system(javac -version 2>&1)
+defineReplace(javac) {
+    contains(JAVAC_VERSION, javac) {
+        return(javac -source 8 -target 8 -nowarn -d $$path($$DESTDIR/$$1) $$path($$PWD/res/deploy/all/tools/ApktoolDaemon.java) $$escape_expand(\\n\\t))
+    }
+    return()
+}
+
 win32 {
     isEmpty(DESTDIR): DESTDIR = $$PWD/bin/win32
     RC_ICONS = $$PWD/res/logo/application.ico
     QMAKE_POST_LINK += $$copy(all, .)
     QMAKE_POST_LINK += $$copy(win32, .)
+    QMAKE_POST_LINK += $$javac(tools)
 }
 
 unix:!macx {
@@ -27,6 +37,7 @@ unix:!macx {
     QMAKE_POST_LINK += $$mkdir($$DESTDIR/../share/$$TARGET)
     QMAKE_POST_LINK += $$copy(all/., ../share/$$TARGET)
     QMAKE_POST_LINK += $$copy(linux/share, ..)
+    QMAKE_POST_LINK += $$javac(../share/$$TARGET/tools)
     isEmpty(PACKAGE) {
         QMAKE_POST_LINK += $$copy(linux/bin, ..)
         QMAKE_POST_LINK += $$executable($$DESTDIR/adb)
@@ -40,6 +51,12 @@ unix:!macx {
     share2.files  = $$PWD/res/deploy/linux/share/*
     share2.path   = $$PREFIX/share
     INSTALLS     += target share1 share2
+    contains(JAVAC_VERSION, javac) {
+        daemon.files  = $$DESTDIR/../share/$$TARGET/tools/ApktoolDaemon.class
+        daemon.path   = $$PREFIX/share/apk-editor-studio/tools
+        daemon.CONFIG = no_check_exist
+        INSTALLS     += daemon
+    }
     isEmpty(PACKAGE) {
         bin.files  = $$PWD/res/deploy/linux/bin/*
         bin.path   = $$PREFIX/bin
@@ -51,6 +68,7 @@ macx {
     isEmpty(DESTDIR): DESTDIR = $$PWD/bin/macos
     QMAKE_POST_LINK += $$copy(all/., $${TARGET}.app/Contents/MacOS)
     QMAKE_POST_LINK += $$copy(macos/bundle/., $${TARGET}.app)
+    QMAKE_POST_LINK += $$javac($${TARGET}.app/Contents/MacOS/tools)
     QMAKE_POST_LINK += $$executable($$DESTDIR/$${TARGET}.app/Contents/MacOS/adb)
     QMAKE_POST_LINK += $$executable($$DESTDIR/$${TARGET}.app/Contents/MacOS/zipalign)
     QMAKE_INFO_PLIST = $$PWD/res/deploy/macos/Info.plist
@@ -0,0 +1,150 @@
+import java.io.BufferedReader;
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.io.InputStreamReader;
+import java.io.OutputStream;
+import java.io.PrintStream;
+import java.lang.reflect.InvocationTargetException;
+import java.lang.reflect.Method;
+import java.nio.charset.StandardCharsets;
+import java.security.Permission;
+
+/**
+ * Keeps a warm JVM which runs apktool commands received over the standard input.
+ *
+ * Launched by APK Editor Studio as "java -cp apktool.jar:tools ApktoolDaemon" if the class was compiled on deploy,
+ * or as "java -cp apktool.jar ApktoolDaemon.java" otherwise (requires Java 11+). Apktool is loaded by reflection,
+ * so that the class can be compiled without it.
+ * Protocol:
+ *   - On startup, "READY\n" is written to the standard output. If apktool's exit calls can't be trapped,
+ *     "NO-EXIT-TRAP\t<reason>\n" is written instead and the daemon exits.
+ *   - Request: tab-separated apktool arguments terminated by "\n".
+ *   - Progress: each apktool output line is forwarded as ">" + line + "\n" while the request is running.
+ *   - Response: "<exit code>\t<output length>\n" followed by the UTF-8 encoded apktool output.
+ */
+public class ApktoolDaemon {
+    private static class ProgressStream extends OutputStream {
+        private final OutputStream capture;
+        private final PrintStream stdout;
+        private final ByteArrayOutputStream line = new ByteArrayOutputStream();
+
+        ProgressStream(OutputStream capture, PrintStream stdout) {
+            this.capture = capture;
+            this.stdout = stdout;
+        }
+
+        @Override
+        public synchronized void write(int b) throws IOException {
+            capture.write(b);
+            if (b == '\n') {
+                forward();
+            } else {
+                line.write(b);
+            }
+        }
+
+        @Override
+        public synchronized void flush() {
+            // Partial lines are kept until they are terminated or the request is finished.
+        }
+
+        synchronized void forward() {
+            if (line.size() > 0) {
+                stdout.print(">");
+                stdout.write(line.toByteArray(), 0, line.size());
+                stdout.print("\n");
+                stdout.flush();
+                line.reset();
+            }
+        }
+    }
+
+    private static class ExitException extends SecurityException {
+        final int status;
+
+        ExitException(int status) {
+            this.status = status;
+        }
+    }
+
+    public static void main(String[] args) throws IOException {
+        final PrintStream stdout = System.out;
+        final PrintStream stderr = System.err;
+        final BufferedReader stdin = new BufferedReader(new InputStreamReader(System.in, StandardCharsets.UTF_8));
+
+        final Method apktool;
+        try {
+            apktool = Class.forName("brut.apktool.Main").getMethod("main", String[].class);
+        } catch (ReflectiveOperationException e) {
+            stdout.print("NO-APKTOOL\t" + e + "\n");
+            stdout.flush();
+            return;
+        }
+
+        final String trapError = trapExit();
+        if (trapError != null) {
+            stdout.print("NO-EXIT-TRAP\t" + trapError + "\n");
+            stdout.flush();
+            return;
+        }
+        stdout.print("READY\n");
+        stdout.flush();
+
+        String line;
+        while ((line = stdin.readLine()) != null) {
+            if (line.isEmpty()) {
+                continue;
+            }
+            final ByteArrayOutputStream buffer = new ByteArrayOutputStream();
+            final ProgressStream progress = new ProgressStream(buffer, stdout);
+            final PrintStream capture = new PrintStream(progress, true, "UTF-8");
+            System.setOut(capture);
+            System.setErr(capture);
+            int status = 0;
+            try {
+                apktool.invoke(null, (Object) line.split("\t", -1));
+            } catch (InvocationTargetException e) {
+                if (e.getCause() instanceof ExitException) {
+                    status = ((ExitException) e.getCause()).status;
+                } else {
+                    e.getCause().printStackTrace(capture);
+                    status = 1;
+                }
+            } catch (Throwable e) {
+                e.printStackTrace(capture);
+                status = 1;
+            } finally {
+                capture.flush();
+                progress.forward();
+                System.setOut(stdout);
+                System.setErr(stderr);
+            }
+            final byte[] output = buffer.toByteArray();
+            stdout.print(status + "\t" + output.length + "\n");
+            stdout.write(output);
+            stdout.flush();
+        }
+    }
+
+    @SuppressWarnings("removal")
+    private static String trapExit() {
+        // Apktool calls System.exit() on failures, so the daemon is not started without the trap.
+        // Java 18+ forbids it unless launched with "-Djava.security.manager=allow", Java 24+ altogether.
+        // Returns null on success, or the reason of the failure.
+        try {
+            System.setSecurityManager(new SecurityManager() {
+                @Override
+                public void checkExit(int status) {
+                    throw new ExitException(status);
+                }
+
+                @Override
+                public void checkPermission(Permission permission) {
+                }
+            });
+        } catch (UnsupportedOperationException | SecurityException e) {
+            return String.valueOf(e.getMessage());
+        }
+        return null;
+    }
+}
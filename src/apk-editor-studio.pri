@@ -1,4 +1,6 @@
 SOURCES += \
+    $$PWD/apk/changetracker.cpp \
+    $$PWD/apk/contentssnapshot.cpp \
     $$PWD/apk/filesystemmodel.cpp \
     $$PWD/apk/iconitemsmodel.cpp \
     $$PWD/apk/logentry.cpp \
@@ -14,12 +16,14 @@ SOURCES += \
     $$PWD/apk/resourceitemsmodel.cpp \
     $$PWD/apk/resourcemodelindex.cpp \
     $$PWD/apk/resourcenode.cpp \
+    $$PWD/apk/resourcescanner.cpp \
     $$PWD/apk/sortfilterproxymodel.cpp \
     $$PWD/apk/titleitemsmodel.cpp \
     $$PWD/apk/titlenode.cpp \
     $$PWD/apk/xmlmodel.cpp \
     $$PWD/apk/xmlnode.cpp \
     $$PWD/base/application.cpp \
+    $$PWD/base/batchrunner.cpp \
     $$PWD/base/device.cpp \
     $$PWD/base/deviceitemsmodel.cpp \
     $$PWD/base/fileformat.cpp \
@@ -29,9 +33,13 @@ SOURCES += \
     $$PWD/base/main.cpp \
     $$PWD/base/password.cpp \
     $$PWD/base/recent.cpp \
+    $$PWD/base/scheduler.cpp \
     $$PWD/base/settings.cpp \
     $$PWD/base/tasks.cpp \
+    $$PWD/base/thumbnailprovider.cpp \
+    $$PWD/base/thumbnailstore.cpp \
     $$PWD/base/treenode.cpp \
+    $$PWD/base/unpackcache.cpp \
     $$PWD/base/updater.cpp \
     $$PWD/base/utils.cpp \
     $$PWD/base/xmlhighlighter.cpp \
@@ -46,15 +54,23 @@ SOURCES += \
     $$PWD/editors/viewer.cpp \
     $$PWD/editors/welcomeactionviewer.cpp \
     $$PWD/tools/adb.cpp \
+    $$PWD/tools/apkinfo.cpp \
+    $$PWD/tools/apkpatcher.cpp \
     $$PWD/tools/apksigner.cpp \
     $$PWD/tools/apktool.cpp \
+    $$PWD/tools/apktooldaemon.cpp \
+    $$PWD/tools/der.cpp \
     $$PWD/tools/executable.cpp \
     $$PWD/tools/jar.cpp \
     $$PWD/tools/java.cpp \
     $$PWD/tools/javac.cpp \
     $$PWD/tools/keytool.cpp \
+    $$PWD/tools/outputbuffer.cpp \
+    $$PWD/tools/signingkey.cpp \
     $$PWD/tools/which.cpp \
     $$PWD/tools/zipalign.cpp \
+    $$PWD/tools/ziparchive.cpp \
+    $$PWD/tools/zipwriter.cpp \
     $$PWD/widgets/decorationsizedelegate.cpp \
     $$PWD/widgets/elidedlabel.cpp \
     $$PWD/widgets/filebox.cpp \
@@ -80,10 +96,13 @@ SOURCES += \
     $$PWD/windows/keymanager.cpp \
     $$PWD/windows/mainwindow.cpp \
     $$PWD/windows/optionsdialog.cpp \
+    $$PWD/windows/projectselector.cpp \
     $$PWD/windows/selectdialog.cpp \
     $$PWD/windows/waitdialog.cpp
 
 HEADERS += \
+    $$PWD/apk/changetracker.h \
+    $$PWD/apk/contentssnapshot.h \
     $$PWD/apk/filesystemmodel.h \
     $$PWD/apk/iconitemsmodel.h \
     $$PWD/apk/iresourceitemsmodel.h \
@@ -100,12 +119,14 @@ HEADERS += \
     $$PWD/apk/resourceitemsmodel.h \
     $$PWD/apk/resourcemodelindex.h \
     $$PWD/apk/resourcenode.h \
+    $$PWD/apk/resourcescanner.h \
     $$PWD/apk/sortfilterproxymodel.h \
     $$PWD/apk/titleitemsmodel.h \
     $$PWD/apk/titlenode.h \
     $$PWD/apk/xmlmodel.h \
     $$PWD/apk/xmlnode.h \
     $$PWD/base/application.h \
+    $$PWD/base/batchrunner.h \
     $$PWD/base/device.h \
     $$PWD/base/deviceitemsmodel.h \
     $$PWD/base/fileformat.h \
@@ -115,9 +136,13 @@ HEADERS += \
     $$PWD/base/password.h \
     $$PWD/base/recent.h \
     $$PWD/base/result.h \
+    $$PWD/base/scheduler.h \
     $$PWD/base/settings.h \
     $$PWD/base/tasks.h \
+    $$PWD/base/thumbnailprovider.h \
+    $$PWD/base/thumbnailstore.h \
     $$PWD/base/treenode.h \
+    $$PWD/base/unpackcache.h \
     $$PWD/base/updater.h \
     $$PWD/base/utils.h \
     $$PWD/base/xmlhighlighter.h \
@@ -132,17 +157,25 @@ HEADERS += \
     $$PWD/editors/viewer.h \
     $$PWD/editors/welcomeactionviewer.h \
     $$PWD/tools/adb.h \
+    $$PWD/tools/apkinfo.h \
+    $$PWD/tools/apkpatcher.h \
     $$PWD/tools/apksigner.h \
     $$PWD/tools/apktool.h \
+    $$PWD/tools/apktooldaemon.h \
+    $$PWD/tools/der.h \
     $$PWD/tools/executable.h \
     $$PWD/tools/jar.h \
     $$PWD/tools/java.h \
     $$PWD/tools/javac.h \
     $$PWD/tools/keystore.h \
     $$PWD/tools/keytool.h \
+    $$PWD/tools/outputbuffer.h \
+    $$PWD/tools/signingkey.h \
     $$PWD/tools/tools.h \
     $$PWD/tools/which.h \
     $$PWD/tools/zipalign.h \
+    $$PWD/tools/ziparchive.h \
+    $$PWD/tools/zipwriter.h \
     $$PWD/widgets/decorationsizedelegate.h \
     $$PWD/widgets/elidedlabel.h \
     $$PWD/widgets/filebox.h \
@@ -168,9 +201,12 @@ HEADERS += \
     $$PWD/windows/keymanager.h \
     $$PWD/windows/mainwindow.h \
     $$PWD/windows/optionsdialog.h \
+    $$PWD/windows/projectselector.h \
     $$PWD/windows/selectdialog.h \
     $$PWD/windows/waitdialog.h
 
 INCLUDEPATH += $$PWD
 
+unix: LIBS += -lz
+
 TRANSLATIONS = $$PWD/../res/translations/apk-editor-studio.en.ts
@@ -0,0 +1,134 @@
+#include "apk/changetracker.h"
+#include "apk/resourcescanner.h"
+#include <QDateTime>
+#include <QDirIterator>
+#include <QtConcurrent/QtConcurrent>
+
+ChangeTracker::ChangeTracker(ResourceItemsModel *model, QObject *parent) : QObject(parent)
+{
+    this->model = model;
+
+    // Bursts of notifications (e.g., an external tool rewriting a directory) are coalesced:
+
+    timer.setSingleShot(true);
+    timer.setInterval(200);
+    connect(&timer, &QTimer::timeout, this, &ChangeTracker::flush);
+
+    connect(&watcher, &QFileSystemWatcher::directoryChanged, [=](const QString &path) {
+        dirty.insert(path);
+        timer.start();
+    });
+
+    connect(&capturing, &QFutureWatcher<Snapshot>::finished, [=]() {
+        snapshot = capturing.result();
+        watcher.addPath(root);
+        const QStringList directories = snapshot.keys();
+        if (!directories.isEmpty()) {
+            watcher.addPaths(directories);
+        }
+    });
+}
+
+void ChangeTracker::watch(const QString &path)
+{
+    // The initial snapshot is captured in the background; changes are tracked once it's ready.
+    // Paths are kept in the same form as produced by ResourceScanner, so they match the model index.
+    root = path;
+    capturing.setFuture(QtConcurrent::run(&ChangeTracker::capture, root));
+}
+
+ChangeTracker::Snapshot ChangeTracker::capture(const QString &path)
+{
+    Snapshot snapshot;
+    for (const QString &directory : ResourceScanner::listDirectories(path)) {
+        snapshot.insert(directory, list(directory));
+    }
+    return snapshot;
+}
+
+ChangeTracker::Listing ChangeTracker::list(const QString &directory)
+{
+    Listing listing;
+    QDirIterator it(directory, QDir::Files);
+    while (it.hasNext()) {
+        const QString path = it.next();
+        const QFileInfo fileInfo = it.fileInfo();
+        listing.insert(path, qMakePair(fileInfo.size(), fileInfo.lastModified().toMSecsSinceEpoch()));
+    }
+    return listing;
+}
+
+void ChangeTracker::flush()
+{
+    // Resource directories which were added or removed:
+
+    QStringList existing; // Dirty directories which still exist
+    if (dirty.remove(root)) {
+        if (QFileInfo(root).isDir()) {
+            existing.append(root);
+        }
+        const QStringList listed = ResourceScanner::listDirectories(root);
+        const QSet<QString> directories(listed.begin(), listed.end());
+        for (const QString &directory : directories) {
+            if (!snapshot.contains(directory)) {
+                snapshot.insert(directory, Listing());
+                watcher.addPath(directory);
+                dirty.insert(directory);
+            }
+        }
+        for (const QString &directory : snapshot.keys()) {
+            if (!directories.contains(directory)) {
+                dirty.insert(directory);
+            }
+        }
+    }
+
+    // Files which were added, removed or modified:
+
+    QStringList added;
+    QStringList removed;
+    QStringList modified;
+    for (const QString &directory : dirty) {
+        const Listing before = snapshot.value(directory);
+        const Listing after = list(directory);
+        for (auto it = after.constBegin(); it != after.constEnd(); ++it) {
+            auto previous = before.find(it.key());
+            if (previous == before.constEnd()) {
+                added.append(it.key());
+            } else if (previous.value() != it.value()) {
+                modified.append(it.key());
+            }
+        }
+        for (auto it = before.constBegin(); it != before.constEnd(); ++it) {
+            if (!after.contains(it.key())) {
+                removed.append(it.key());
+            }
+        }
+        if (QFileInfo(directory).isDir()) {
+            snapshot.insert(directory, after);
+            existing.append(directory);
+        } else {
+            snapshot.remove(directory);
+        }
+    }
+    dirty.clear();
+
+    // Directories which were replaced (e.g., removed and created anew, or renamed over) are dropped from the watcher:
+
+    const QStringList watched = watcher.directories();
+    for (const QString &directory : existing) {
+        if (!watched.contains(directory)) {
+            watcher.addPath(directory);
+        }
+    }
+
+    if (!removed.isEmpty()) {
+        model->dropFiles(removed);
+    }
+    if (!added.isEmpty()) {
+        model->addFiles(added);
+    }
+    if (!modified.isEmpty()) {
+        model->refreshFiles(modified);
+    }
+}
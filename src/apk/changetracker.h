@@ -0,0 +1,37 @@
+#ifndef CHANGETRACKER_H
+#define CHANGETRACKER_H
+
+#include "apk/resourceitemsmodel.h"
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
+#include <QSet>
+#include <QTimer>
+
+class ChangeTracker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ChangeTracker(ResourceItemsModel *model, QObject *parent = nullptr);
+
+    void watch(const QString &path);
+
+private:
+    typedef QHash<QString, QPair<qint64, qint64>> Listing; // File path -> <size, modification time>
+    typedef QHash<QString, Listing> Snapshot; // Directory path -> listing
+
+    static Snapshot capture(const QString &path);
+    static Listing list(const QString &directory);
+
+    void flush();
+
+    ResourceItemsModel *model;
+    QFileSystemWatcher watcher;
+    QFutureWatcher<Snapshot> capturing;
+    QTimer timer;
+    QString root;
+    Snapshot snapshot;
+    QSet<QString> dirty;
+};
+
+#endif // CHANGETRACKER_H
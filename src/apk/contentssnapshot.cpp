@@ -0,0 +1,83 @@
+#include "apk/contentssnapshot.h"
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+
+ContentsSnapshot::ContentsSnapshot()
+{
+    captured = 0;
+}
+
+ContentsSnapshot ContentsSnapshot::capture(const QString &path)
+{
+    // Paths are relative to the contents directory and use forward slashes.
+    // The output of "apktool build" (the "build" and "dist" directories) is not a part of the contents.
+
+    ContentsSnapshot snapshot;
+    snapshot.captured = QDateTime::currentMSecsSinceEpoch();
+    const QDir root(path);
+    QDirIterator it(path, QDir::Files | QDir::Hidden, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const QString filePath = root.relativeFilePath(it.next());
+        if (filePath.startsWith("build/") || filePath.startsWith("dist/")) {
+            continue;
+        }
+        const QFileInfo fileInfo = it.fileInfo();
+        snapshot.listing.insert(filePath, qMakePair(fileInfo.size(), fileInfo.lastModified().toMSecsSinceEpoch()));
+    }
+    return snapshot;
+}
+
+ContentsSnapshot::Changes ContentsSnapshot::compare(const ContentsSnapshot &current) const
+{
+    // Files which were modified while this snapshot was being captured are also reported as modified.
+
+    Changes changes;
+    for (auto it = current.listing.constBegin(); it != current.listing.constEnd(); ++it) {
+        const auto previous = listing.find(it.key());
+        if (previous == listing.constEnd()) {
+            changes.added.append(it.key());
+        } else if (previous.value() != it.value() || it.value().second >= captured) {
+            changes.modified.append(it.key());
+        }
+    }
+    for (auto it = listing.constBegin(); it != listing.constEnd(); ++it) {
+        if (!current.listing.contains(it.key())) {
+            changes.removed.append(it.key());
+        }
+    }
+    return changes;
+}
+
+ContentsSnapshot ContentsSnapshot::combine(const ContentsSnapshot &other, const std::function<bool(const QString &)> &isTaken) const
+{
+    // The entries for which isTaken() holds are taken from the other snapshot, the rest are kept from this one.
+
+    ContentsSnapshot snapshot;
+    snapshot.captured = qMax(captured, other.captured);
+    for (auto it = listing.constBegin(); it != listing.constEnd(); ++it) {
+        if (!isTaken(it.key())) {
+            snapshot.listing.insert(it.key(), it.value());
+        }
+    }
+    for (auto it = other.listing.constBegin(); it != other.listing.constEnd(); ++it) {
+        if (isTaken(it.key())) {
+            snapshot.listing.insert(it.key(), it.value());
+        }
+    }
+    return snapshot;
+}
+
+qint64 ContentsSnapshot::getSize() const
+{
+    qint64 size = 0;
+    for (const auto &entry : listing) {
+        size += entry.first;
+    }
+    return size;
+}
+
+int ContentsSnapshot::getCount() const
+{
+    return listing.size();
+}
@@ -0,0 +1,34 @@
+#ifndef CONTENTSSNAPSHOT_H
+#define CONTENTSSNAPSHOT_H
+
+#include <QHash>
+#include <QPair>
+#include <QStringList>
+#include <functional>
+
+class ContentsSnapshot
+{
+public:
+    struct Changes
+    {
+        QStringList modified;
+        QStringList added;
+        QStringList removed;
+    };
+
+    ContentsSnapshot();
+
+    static ContentsSnapshot capture(const QString &path);
+    Changes compare(const ContentsSnapshot &current) const;
+    ContentsSnapshot combine(const ContentsSnapshot &other, const std::function<bool(const QString &)> &isTaken) const;
+    qint64 getSize() const;
+    int getCount() const;
+
+private:
+    typedef QHash<QString, QPair<qint64, qint64>> Listing; // Relative file path -> <size, modification time>
+
+    Listing listing;
+    qint64 captured;
+};
+
+#endif // CONTENTSSNAPSHOT_H
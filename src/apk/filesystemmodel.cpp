@@ -1,11 +1,17 @@
 #include "apk/filesystemmodel.h"
 #include "apk/resourcemodelindex.h"
-#include <QTimer>
 
 #ifdef QT_DEBUG
     #include <QDebug>
 #endif
 
+FileSystemModel::FileSystemModel(QObject *parent) : QFileSystemModel(parent), sourceModel(nullptr)
+{
+    updateTimer.setSingleShot(true);
+    updateTimer.setInterval(10);
+    connect(&updateTimer, &QTimer::timeout, this, &FileSystemModel::flushUpdates);
+}
+
 void FileSystemModel::setSourceModel(ResourceItemsModel *model)
 {
     if (sourceModel) {
@@ -14,10 +20,13 @@ void FileSystemModel::setSourceModel(ResourceItemsModel *model)
     sourceModel = model;
     if (model) {
         connect(model, &ResourceItemsModel::dataChanged, [=](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles) {
-            const auto fromIndex = index(ResourceModelIndex(topLeft).path());
-            const auto toIndex = index(ResourceModelIndex(bottomRight).path());
-            updated(fromIndex.sibling(fromIndex.row(), 0),
-                      toIndex.sibling(toIndex.row(), columnCount() - 1), roles);
+            // The files of a single resource group may reside in different directories, so the rows are mapped one by one:
+            for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+                const auto fileIndex = index(ResourceModelIndex(topLeft.sibling(row, 0)).path());
+                if (fileIndex.isValid()) {
+                    updated(fileIndex.sibling(fileIndex.row(), 0), fileIndex.sibling(fileIndex.row(), columnCount() - 1), roles);
+                }
+            }
         });
     }
 }
@@ -58,36 +67,78 @@ QVariant FileSystemModel::data(const QModelIndex &index, int role) const
 
 bool FileSystemModel::removeRows(int row, int count, const QModelIndex &parent)
 {
-    Q_UNUSED(count)
+    // The rows themselves are removed by QFileSystemModel: right away for the files removed with remove(),
+    // and once the file watcher notices the files removed through the resource model.
+
     if (!sourceModel) {
         return false;
     }
-    bool success = true;
-    beginRemoveRows(parent, row, row + count - 1);
+    QStringList paths;
     for (int i = row; i < row + count; ++i) {
-        const auto path = filePath(index(row, 0, parent));
+        paths.append(filePath(index(i, 0, parent)));
+    }
+    bool success = true;
+    for (const QString &path : paths) {
         const auto resourceIndex = sourceModel->findIndex(path);
         if (resourceIndex.isValid()) {
             if (!sourceModel->removeResource(resourceIndex)) {
                 success = false;
             }
         } else {
-            if (!QFile::remove(path)) {
+            if (!remove(index(path))) {
                 success = false;
             }
         }
     }
-    endRemoveRows();
     return success;
 }
 
 void FileSystemModel::updated(const QModelIndex &from, const QModelIndex &to, const QVector<int> &roles)
 {
-    auto timer = new QTimer(this);
-    connect(timer, &QTimer::timeout, [=]() {
-        emit dataChanged(from, to, roles);
-        timer->deleteLater();
-    });
-    timer->setSingleShot(true);
-    timer->start(10);
+    // Updates are deferred and coalesced with the ones arriving within the same interval:
+    updates.append({from, to, roles});
+    if (!updateTimer.isActive()) {
+        updateTimer.start();
+    }
+}
+
+void FileSystemModel::flushUpdates()
+{
+    // Merge updates into a single row range per parent:
+
+    struct Range
+    {
+        int first;
+        int last;
+        QVector<int> roles;
+        bool allRoles;
+    };
+
+    QHash<QPersistentModelIndex, Range> ranges;
+    for (const Update &update : updates) {
+        if (!update.from.isValid() || !update.to.isValid()) {
+            continue;
+        }
+        const QPersistentModelIndex parent(update.from.parent());
+        auto it = ranges.find(parent);
+        if (it == ranges.end()) {
+            ranges.insert(parent, {update.from.row(), update.to.row(), update.roles, update.roles.isEmpty()});
+        } else {
+            it->first = qMin(it->first, update.from.row());
+            it->last = qMax(it->last, update.to.row());
+            it->allRoles = it->allRoles || update.roles.isEmpty();
+            for (int role : update.roles) {
+                if (!it->roles.contains(role)) {
+                    it->roles.append(role);
+                }
+            }
+        }
+    }
+    updates.clear();
+
+    for (auto it = ranges.constBegin(); it != ranges.constEnd(); ++it) {
+        const QModelIndex from = index(it->first, 0, it.key());
+        const QModelIndex to = index(it->last, columnCount(it.key()) - 1, it.key());
+        emit dataChanged(from, to, it->allRoles ? QVector<int>() : it->roles);
+    }
 }
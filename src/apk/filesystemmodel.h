@@ -3,6 +3,7 @@
 
 #include "apk/resourceitemsmodel.h"
 #include <QFileSystemModel>
+#include <QTimer>
 
 class FileSystemModel : public QFileSystemModel, public IResourceItemsModel
 {
@@ -10,8 +11,7 @@ class FileSystemModel : public QFileSystemModel, public IResourceItemsModel
     Q_INTERFACES(IResourceItemsModel)
 
 public:
-    explicit FileSystemModel(QObject *parent = nullptr) :
-        QFileSystemModel(parent), sourceModel(nullptr) {}
+    explicit FileSystemModel(QObject *parent = nullptr);
 
     void setSourceModel(ResourceItemsModel *model);
 
@@ -23,8 +23,18 @@ public:
 
 private:
     void updated(const QModelIndex &from, const QModelIndex &to, const QVector<int> &roles = {});
+    void flushUpdates();
+
+    struct Update
+    {
+        QPersistentModelIndex from;
+        QPersistentModelIndex to;
+        QVector<int> roles;
+    };
 
     ResourceItemsModel *sourceModel;
+    QList<Update> updates;
+    QTimer updateTimer;
 };
 
 #endif // FILESYSTEMMODEL_H
@@ -7,6 +7,7 @@ IconItemsModel::IconItemsModel(QObject *parent) : QAbstractProxyModel(parent)
 {
     applicationNode = new TreeNode();
     activitiesNode = new TreeNode();
+    populating = false;
 }
 
 IconItemsModel::~IconItemsModel()
@@ -19,7 +20,8 @@ void IconItemsModel::setSourceModel(QAbstractItemModel *newSourceModel)
 {
     beginResetModel();
         if (sourceModel()) {
-            disconnect(sourceModel(), &ResourceItemsModel::added, this, &IconItemsModel::onResourceAdded);
+            disconnect(sourceModel(), &ResourceItemsModel::added, this, &IconItemsModel::onResourcesAdded);
+            disconnect(sourceModel(), &QAbstractItemModel::modelReset, this, &IconItemsModel::onResourcesReset);
             disconnect(sourceModel(), &QAbstractItemModel::rowsAboutToBeRemoved, this, &IconItemsModel::sourceRowsAboutToBeRemoved);
             disconnect(sourceModel(), &QAbstractItemModel::dataChanged, this, &IconItemsModel::sourceDataChanged);
             disconnect(apk(), &Project::unpacked, this, &IconItemsModel::ready);
@@ -27,7 +29,8 @@ void IconItemsModel::setSourceModel(QAbstractItemModel *newSourceModel)
         Q_ASSERT(qobject_cast<ResourceItemsModel *>(newSourceModel));
         QAbstractProxyModel::setSourceModel(newSourceModel);
         if (sourceModel()) {
-            connect(sourceModel(), &ResourceItemsModel::added, this, &IconItemsModel::onResourceAdded);
+            connect(sourceModel(), &ResourceItemsModel::added, this, &IconItemsModel::onResourcesAdded);
+            connect(sourceModel(), &QAbstractItemModel::modelReset, this, &IconItemsModel::onResourcesReset);
             connect(sourceModel(), &QAbstractItemModel::rowsAboutToBeRemoved, this, &IconItemsModel::sourceRowsAboutToBeRemoved);
             connect(sourceModel(), &QAbstractItemModel::dataChanged, this, &IconItemsModel::sourceDataChanged);
             connect(apk(), &Project::unpacked, this, &IconItemsModel::ready);
@@ -46,8 +49,11 @@ QIcon IconItemsModel::getIcon() const
     for (auto node : applicationNode->getChildren()) {
         auto iconNode = static_cast<IconNode *>(node);
         if (iconNode->type == Icon) {
-            const QPixmap pixmap = Utils::iconToPixmap(proxyToSourceMap.value(iconNode).data(Qt::DecorationRole).value<QIcon>());
-            icon.addPixmap(pixmap);
+            // Application icons are read directly, bypassing the asynchronous thumbnails:
+            const QString path = proxyToSourceMap.value(iconNode).data(PathRole).toString();
+            if (Utils::isImageReadable(path)) {
+                icon.addPixmap(QPixmap(path));
+            }
         }
     }
     return icon;
@@ -106,9 +112,9 @@ bool IconItemsModel::replaceApplicationIcons(const QString &path)
     if (path.isEmpty()) {
         return false;
     }
-    bool success = false;
     auto applicationIndex = index(ApplicationRow, 0);
     auto applicationIconCount = applicationNode->childCount();
+    bool success = applicationIconCount > 0;
     for (int row = 0; row < applicationIconCount; ++row) {
         auto iconIndex = index(row, PathColumn, applicationIndex);
         auto iconType = getIconType(iconIndex);
@@ -243,19 +249,16 @@ void IconItemsModel::sort(int column, Qt::SortOrder order)
 
     beginResetModel();
 
-    auto &applicationIcons = applicationNode->getChildren();
-    std::sort(applicationIcons.begin(), applicationIcons.end(), sortIcons);
+    applicationNode->sortChildren(sortIcons);
 
-    auto &activityScopes = activitiesNode->getChildren();
-    std::sort(activityScopes.begin(), activityScopes.end(), [](const TreeNode *node1, const TreeNode *node2) -> bool {
+    activitiesNode->sortChildren([](const TreeNode *node1, const TreeNode *node2) -> bool {
         auto activity1 = static_cast<const ActivityNode *>(node1);
         auto activity2 = static_cast<const ActivityNode *>(node2);
         return activity1->scope->type() < activity2->scope->type();
     });
 
-    for (auto activityNode : activityScopes) {
-        auto &activityIcons = activityNode->getChildren();
-        std::sort(activityIcons.begin(), activityIcons.end(), sortIcons);
+    for (auto activityNode : activitiesNode->getChildren()) {
+        activityNode->sortChildren(sortIcons);
     }
 
     endResetModel();
@@ -285,16 +288,21 @@ bool IconItemsModel::removeRows(int row, int count, const QModelIndex &parent)
 
 bool IconItemsModel::appendIcon(const QPersistentModelIndex &index, ManifestScope *scope, IconType type)
 {
+    // Row insertion notifications are omitted while the model is being populated within a reset.
     if (!sourceToProxyMap.contains(index)) {
         switch (scope->type()) {
         case ManifestScope::Type::Application: {
             const int row = applicationNode->childCount();
-            beginInsertRows(this->index(ApplicationRow, 0), row, row);
-                auto iconNode = new IconNode(type);
-                applicationNode->addChild(iconNode);
-                sourceToProxyMap.insert(index, iconNode);
-                proxyToSourceMap.insert(iconNode, index);
-            endInsertRows();
+            if (!populating) {
+                beginInsertRows(this->index(ApplicationRow, 0), row, row);
+            }
+            auto iconNode = new IconNode(type);
+            applicationNode->addChild(iconNode);
+            sourceToProxyMap.insert(index, iconNode);
+            proxyToSourceMap.insert(iconNode, index);
+            if (!populating) {
+                endInsertRows();
+            }
             return true;
         }
         case ManifestScope::Type::Activity: {
@@ -310,18 +318,26 @@ bool IconItemsModel::appendIcon(const QPersistentModelIndex &index, ManifestScop
             if (!activityNode) {
                 // Create new activity node:
                 const int row = activitiesNode->childCount();
-                beginInsertRows(this->index(ActivitiesRow, 0), row, row);
-                    activityNode = new ActivityNode(scope);
-                    activitiesNode->addChild(activityNode);
-                endInsertRows();
+                if (!populating) {
+                    beginInsertRows(this->index(ActivitiesRow, 0), row, row);
+                }
+                activityNode = new ActivityNode(scope);
+                activitiesNode->addChild(activityNode);
+                if (!populating) {
+                    endInsertRows();
+                }
             }
             const int row = activityNode->childCount();
-            beginInsertRows(this->index(activityNode->row(), 0, this->index(ActivitiesRow, 0)), row, row);
-                auto iconNode = new IconNode(type);
-                activityNode->addChild(iconNode);
-                sourceToProxyMap.insert(index, iconNode);
-                proxyToSourceMap.insert(iconNode, index);
-            endInsertRows();
+            if (!populating) {
+                beginInsertRows(this->index(activityNode->row(), 0, this->index(ActivitiesRow, 0)), row, row);
+            }
+            auto iconNode = new IconNode(type);
+            activityNode->addChild(iconNode);
+            sourceToProxyMap.insert(index, iconNode);
+            proxyToSourceMap.insert(iconNode, index);
+            if (!populating) {
+                endInsertRows();
+            }
             return true;
         }
         }
@@ -329,8 +345,14 @@ bool IconItemsModel::appendIcon(const QPersistentModelIndex &index, ManifestScop
     return false;
 }
 
-void IconItemsModel::onResourceAdded(const QModelIndex &index)
+void IconItemsModel::appendResourceIcons(const QModelIndex &index)
 {
+    // Groups are traversed recursively:
+    const int rows = sourceModel()->rowCount(index);
+    for (int row = 0; row < rows; ++row) {
+        appendResourceIcons(sourceModel()->index(row, 0, index));
+    }
+
     auto resource = sourceModel()->getResource(index);
     if (resource && Utils::isDrawableResource(resource->getFilePath())) {
         auto resourceName = resource->getName();
@@ -349,6 +371,29 @@ void IconItemsModel::onResourceAdded(const QModelIndex &index)
     }
 }
 
+void IconItemsModel::onResourcesAdded(const QModelIndex &parent, int first, int last)
+{
+    for (int row = first; row <= last; ++row) {
+        appendResourceIcons(sourceModel()->index(row, 0, parent));
+    }
+}
+
+void IconItemsModel::onResourcesReset()
+{
+    beginResetModel();
+    populating = true;
+
+    applicationNode->deleteChildren();
+    activitiesNode->deleteChildren();
+    sourceToProxyMap.clear();
+    proxyToSourceMap.clear();
+
+    appendResourceIcons(QModelIndex());
+
+    populating = false;
+    endResetModel();
+}
+
 void IconItemsModel::sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last)
 {
     for (int row = first; row <= last; ++row) {
@@ -366,9 +411,9 @@ void IconItemsModel::sourceRowsAboutToBeRemoved(const QModelIndex &parent, int f
     }
 }
 
-void IconItemsModel::sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
+void IconItemsModel::sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
 {
-    emit dataChanged(mapFromSource(topLeft), mapFromSource(bottomRight));
+    emit dataChanged(mapFromSource(topLeft), mapFromSource(bottomRight), roles);
 }
 
 const Project *IconItemsModel::apk() const
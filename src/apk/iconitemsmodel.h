@@ -77,15 +77,18 @@ private:
     };
 
     bool appendIcon(const QPersistentModelIndex &index, ManifestScope *scope, IconType type = Icon);
-    void onResourceAdded(const QModelIndex &index);
+    void appendResourceIcons(const QModelIndex &index);
+    void onResourcesAdded(const QModelIndex &parent, int first, int last);
+    void onResourcesReset();
     void sourceRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
-    void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    void sourceDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles);
     const Project *apk() const;
 
     QHash<QPersistentModelIndex, IconNode *> sourceToProxyMap;
     QHash<IconNode *, QPersistentModelIndex> proxyToSourceMap;
     TreeNode *applicationNode;
     TreeNode *activitiesNode;
+    bool populating;
 };
 
 #endif // ICONITEMSMODEL_H
@@ -2,6 +2,11 @@
 #include "base/application.h"
 #include <QPalette>
 
+void LogEntry::setBrief(const QString &brief)
+{
+    this->brief = brief;
+}
+
 QString LogEntry::getBrief() const
 {
     return brief;
@@ -16,6 +16,8 @@ public:
     LogEntry(const QString &brief, const QString &descriptive, Type type)
         : brief(brief), descriptive(descriptive), type(type) {}
 
+    void setBrief(const QString &brief);
+
     QString getBrief() const;
     QString getDescriptive() const;
     Type getType() const;
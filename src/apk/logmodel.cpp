@@ -4,6 +4,19 @@
 LogModel::LogModel()
 {
     isLoading = false;
+    loadingProgress = -1;
+    queueEntry = nullptr;
+    outputEntry = nullptr;
+
+    // Output lines may arrive at a high rate, so the view is updated at most 10 times per second:
+    outputTimer.setInterval(100);
+    outputTimer.setSingleShot(true);
+    connect(&outputTimer, &QTimer::timeout, [=]() {
+        if (outputEntry) {
+            const QModelIndex outputIndex = index(entries.indexOf(outputEntry));
+            emit dataChanged(outputIndex, outputIndex, {Qt::DisplayRole});
+        }
+    });
 }
 
 LogModel::~LogModel()
@@ -32,6 +45,8 @@ void LogModel::clear()
         beginRemoveRows(QModelIndex(), 0, rowCount() - 1);
             qDeleteAll(entries);
             entries.clear();
+            queueEntry = nullptr;
+            outputEntry = nullptr;
         endRemoveRows();
     }
 }
@@ -46,6 +61,57 @@ bool LogModel::getLoadingState() const
     return isLoading;
 }
 
+void LogModel::setLoadingProgress(int percentage)
+{
+    // Negative value stands for the indeterminate progress.
+    loadingProgress = qMin(percentage, 100);
+}
+
+int LogModel::getLoadingProgress() const
+{
+    return loadingProgress;
+}
+
+void LogModel::setQueuePosition(int position)
+{
+    // A single entry reflects the current position in the task queue; zero removes it.
+
+    if (position > 0) {
+        const QString brief = tr("Waiting in queue (position %1)...").arg(position);
+        if (!queueEntry) {
+            queueEntry = new LogEntry(brief, QString(), LogEntry::Information);
+            add(queueEntry);
+        } else {
+            queueEntry->setBrief(brief);
+            const QModelIndex queueIndex = index(entries.indexOf(queueEntry));
+            emit dataChanged(queueIndex, queueIndex, {Qt::DisplayRole});
+        }
+    } else if (queueEntry) {
+        remove(queueEntry);
+        queueEntry = nullptr;
+    }
+}
+
+void LogModel::setLiveOutput(const QString &line)
+{
+    // A single entry shows the latest output line of the running tool; an empty line removes it.
+
+    if (!line.isEmpty()) {
+        if (!outputEntry) {
+            outputEntry = new LogEntry(line, QString(), LogEntry::Information);
+            add(outputEntry);
+        } else {
+            outputEntry->setBrief(line);
+            if (!outputTimer.isActive()) {
+                outputTimer.start();
+            }
+        }
+    } else if (outputEntry) {
+        remove(outputEntry);
+        outputEntry = nullptr;
+    }
+}
+
 QVariant LogModel::data(const QModelIndex &index, int role) const
 {
     if (index.isValid()) {
@@ -79,3 +145,12 @@ int LogModel::rowCount(const QModelIndex &parent) const
     Q_UNUSED(parent)
     return entries.count();
 }
+
+void LogModel::remove(LogEntry *entry)
+{
+    const int row = entries.indexOf(entry);
+    beginRemoveRows(QModelIndex(), row, row);
+        entries.removeAt(row);
+        delete entry;
+    endRemoveRows();
+}
@@ -3,6 +3,7 @@
 
 #include "apk/logentry.h"
 #include <QAbstractListModel>
+#include <QTimer>
 
 class LogModel : public QAbstractListModel
 {
@@ -25,6 +26,10 @@ public:
 
     void setLoadingState(bool state);
     bool getLoadingState() const;
+    void setLoadingProgress(int percentage);
+    int getLoadingProgress() const;
+    void setQueuePosition(int position);
+    void setLiveOutput(const QString &line);
 
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     QModelIndex index(int row, int column = 0, const QModelIndex &parent = QModelIndex()) const override;
@@ -34,8 +39,14 @@ signals:
     void added(LogEntry *entry);
 
 private:
+    void remove(LogEntry *entry);
+
     QList<LogEntry *> entries;
     bool isLoading;
+    int loadingProgress;
+    LogEntry *queueEntry;
+    LogEntry *outputEntry;
+    QTimer outputTimer;
 };
 
 #endif // LOGMODEL_H
@@ -56,6 +56,11 @@ Manifest::~Manifest()
     qDeleteAll(scopes);
 }
 
+QString Manifest::getApplicationLabel() const
+{
+    return !scopes.isEmpty() ? scopes.first()->label().getValue() : QString();
+}
+
 int Manifest::getMinSdk() const
 {
     return minSdk;
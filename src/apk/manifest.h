@@ -12,6 +12,7 @@ public:
     Manifest(const QString &xmlPath, const QString &ymlPath);
     ~Manifest();
 
+    QString getApplicationLabel() const;
     int getMinSdk() const;
     int getTargetSdk() const;
     int getVersionCode() const;
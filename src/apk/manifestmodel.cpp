@@ -13,6 +13,15 @@ void ManifestModel::initialize(Manifest *manifest)
     emit dataChanged(index(0, 0), index(RowCount - 1, 0));
 }
 
+void ManifestModel::setPreview(const ApkInfo &preview)
+{
+    // Read-only values shown until the manifest is decoded.
+    this->preview = preview;
+    if (!manifest) {
+        emit dataChanged(index(0, 0), index(RowCount - 1, 0));
+    }
+}
+
 QString ManifestModel::getApplicationLabel() const
 {
     return manifest->scopes.first()->label().getValue();
@@ -157,6 +166,27 @@ QVariant ManifestModel::data(const QModelIndex &index, int role) const
         } else if (role >= Qt::UserRole) {
             return userdata.at(index.row())[role];
         }
+    } else if (preview.isValid() && index.isValid()) {
+        return getPreviewData(index.row(), role);
+    }
+    return QVariant();
+}
+
+QVariant ManifestModel::getPreviewData(int row, int role) const
+{
+    if (role == Qt::DisplayRole) {
+        switch (row) {
+        case ApplicationLabel:
+            return preview.getApplicationLabel();
+        case VersionCode:
+            return preview.getVersionCode();
+        case VersionName:
+            return preview.getVersionName();
+        case MinimumSdk:
+            return preview.getMinSdk() ? QVariant(preview.getMinSdk()) : QVariant();
+        case TargetSdk:
+            return preview.getTargetSdk() ? QVariant(preview.getTargetSdk()) : QVariant();
+        }
     }
     return QVariant();
 }
@@ -193,5 +223,8 @@ int ManifestModel::rowCount(const QModelIndex &parent) const
 
 Qt::ItemFlags ManifestModel::flags(const QModelIndex &index) const
 {
+    if (!manifest) {
+        return QAbstractItemModel::flags(index);
+    }
     return QAbstractItemModel::flags(index) | Qt::ItemIsEditable;
 }
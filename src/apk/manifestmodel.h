@@ -2,6 +2,7 @@
 #define MANIFESTMODEL_H
 
 #include "apk/manifest.h"
+#include "tools/apkinfo.h"
 #include <QAbstractItemModel>
 #include <QFile>
 
@@ -26,6 +27,7 @@ public:
     explicit ManifestModel(QObject *parent = nullptr);
 
     void initialize(Manifest *manifest);
+    void setPreview(const ApkInfo &preview);
 
     QString getApplicationLabel() const;
     int getVersionCode() const;
@@ -47,7 +49,10 @@ public:
     Qt::ItemFlags flags(const QModelIndex &index) const override;
 
 private:
+    QVariant getPreviewData(int row, int role) const;
+
     Manifest *manifest;
+    ApkInfo preview;
     QVector<QMap<int, QVariant>> userdata;
 };
 
@@ -1,6 +1,9 @@
 #include "apk/project.h"
+#include "apk/changetracker.h"
+#include "apk/resourcescanner.h"
 #include "base/application.h"
 #include "base/utils.h"
+#include "tools/apkpatcher.h"
 #include "tools/apktool.h"
 #include "tools/apksigner.h"
 #include "tools/zipalign.h"
@@ -8,9 +11,12 @@
 #include "windows/dialogs.h"
 #include "windows/keymanager.h"
 #include <QUuid>
-#include <QDirIterator>
 #include <QInputDialog>
 #include <QDebug>
+#include <QFutureWatcher>
+#include <QRegularExpression>
+#include <QSharedPointer>
+#include <QtConcurrent/QtConcurrent>
 
 Project::Project(const QString &path) : resourcesModel(this)
 {
@@ -18,6 +24,8 @@ Project::Project(const QString &path) : resourcesModel(this)
     title = fileInfo.fileName();
     originalPath = fileInfo.absoluteFilePath();
     manifest = nullptr;
+    decodeProfile = DecodeResources;
+    decodeElapsed = 0;
     filesystemModel.setSourceModel(&resourcesModel);
     iconsProxy.setSourceModel(&resourcesModel);
     connect(&state, &ProjectState::changed, [this]() {
@@ -38,29 +46,232 @@ Project::~Project()
     }
 }
 
-void Project::unpack()
+Project::DecodeProfile Project::getDefaultDecodeProfile()
+{
+    const QString profile = app->settings->getDecodeProfile();
+    if (profile == "manifest") {
+        return DecodeManifest;
+    } else if (profile == "full") {
+        return DecodeFull;
+    }
+    return DecodeResources;
+}
+
+QString Project::getDecodeProfileTitle(DecodeProfile profile)
+{
+    switch (profile) {
+    case DecodeManifest:
+        return tr("Manifest only");
+    case DecodeResources:
+        return tr("Resources only");
+    case DecodeFull:
+        return tr("Full decode");
+    }
+    return QString();
+}
+
+void Project::unpack(DecodeProfile profile)
 {
     logModel.clear();
 
-    auto taskOpen = createUnpackTask(getOriginalPath());
+    auto taskOpen = createUnpackTask(getOriginalPath(), profile);
+
+    // The manifest summary and the icon are read straight from the APK and shown while it's being decoded:
+
+    auto preview = new QFutureWatcher<ApkInfo>(this);
+    connect(preview, &QFutureWatcher<ApkInfo>::finished, this, [=]() {
+        const ApkInfo info = preview->result();
+        preview->deleteLater();
+        if (info.isValid()) {
+            manifestModel.setPreview(info);
+            if (!info.getIcon().isNull()) {
+                thumbnail = QIcon(QPixmap::fromImage(info.getIcon()));
+            }
+            emit changed();
+        }
+    });
+    preview->setFuture(QtConcurrent::run(&ApkInfo::read, getOriginalPath()));
 
     connect(taskOpen, &Tasks::Task::started, this, [=]() {
         state.setLastActionFailed(false);
     }, Qt::QueuedConnection);
 
-    connect(taskOpen, &Tasks::Task::success, this, [=]() {
-        state.setCurrentAction(ProjectState::ProjectIdle);
-        journal(tr("Done."), LogEntry::Success);
-    }, Qt::QueuedConnection);
+    // Resources are read asynchronously after the unpack task succeeds:
+
+    connect(this, &Project::unpacked, this, [=](bool success) {
+        if (success) {
+            journalDecode(profile, decodeElapsed, unpackedSnapshot);
+            state.setCurrentAction(ProjectState::ProjectIdle);
+            journal(tr("Done."), LogEntry::Success);
+        }
+    });
 
     connect(taskOpen, &Tasks::Task::error, this, [=]() {
         state.setCurrentAction(ProjectState::ProjectIdle);
         state.setLastActionFailed(true);
     }, Qt::QueuedConnection);
 
+    currentTask = taskOpen;
     taskOpen->run();
 }
 
+void Project::decodeFully()
+{
+    // Upgrades the project which was opened with a lighter decode profile. The APK is decoded anew
+    // into a temporary directory, and the missing parts are then moved into the current contents.
+
+    if (decodeProfile == DecodeFull) {
+        return;
+    }
+
+    logModel.clear();
+
+    const DecodeProfile previous = decodeProfile;
+    const QString target = createTemporaryPath();
+    const QString frameworks = app->settings->getFrameworksDirectory();
+    QDir().mkpath(target);
+
+    auto taskDecode = new Tasks::Unpack(unpackedPath, target, frameworks, true, true);
+    taskDecode->setTitle(tr("Decoding"));
+    taskDecode->setTimeout(app->settings->getTaskTimeout("Unpack"));
+    queue(taskDecode);
+
+    connect(taskDecode, &Tasks::Unpack::finished, this, [=]() {
+        decodeElapsed = taskDecode->getElapsed();
+    });
+
+    connect(taskDecode, &Tasks::Unpack::started, this, [=]() {
+        journal(tr("Decoding APK..."));
+        qDebug() << qPrintable(QString("Decoding\n  from: %1\n    to: %2\n").arg(unpackedPath, target));
+        state.setCurrentAction(ProjectState::ProjectUnpacking);
+        state.setLastActionFailed(false);
+    }, Qt::QueuedConnection);
+
+    connect(taskDecode, &Tasks::Unpack::success, this, [=]() {
+        journal(tr("Merging APK contents..."));
+
+        // The changes made since the APK was opened are collected in background:
+        auto changes = new QFutureWatcher<ContentsSnapshot::Changes>(this);
+        connect(changes, &QFutureWatcher<ContentsSnapshot::Changes>::finished, this, [=]() {
+            mergeDecodedContents(target, previous, changes->result());
+            changes->deleteLater();
+        });
+        changes->setFuture(getChanges());
+    }, Qt::QueuedConnection);
+
+    connect(taskDecode, &Tasks::Unpack::error, this, [=](const QString &message) {
+        journal(tr("Error decoding APK."), message, LogEntry::Error);
+        Utils::rmdir(target, true);
+        state.setCurrentAction(ProjectState::ProjectIdle);
+        state.setLastActionFailed(true);
+    }, Qt::QueuedConnection);
+
+    currentTask = taskDecode;
+    taskDecode->run();
+}
+
+void Project::mergeDecodedContents(const QString &target, DecodeProfile previous, const ContentsSnapshot::Changes &changes)
+{
+    // Files changed since the APK was opened are carried over into the decoded tree, if their format
+    // is the same in both profiles (e.g., images). The changed files which can't be carried over
+    // are listed by getDecodeConflicts(), so that the user is asked before the decode is started.
+
+    QStringList carried;
+    for (const QString &path : changes.modified + changes.added) {
+        if (isCarriedOnDecode(path, previous)) {
+            carried.append(path);
+        }
+    }
+
+    // If the resources were not decoded before, the manifest is replaced as well (its resource references
+    // are only resolved now). The values edited in the manifest table and a changed label are carried over.
+
+    const int minSdk = manifest ? manifest->getMinSdk() : 0;
+    const int targetSdk = manifest ? manifest->getTargetSdk() : 0;
+    const int versionCode = manifest ? manifest->getVersionCode() : 0;
+    const QString versionName = manifest ? manifest->getVersionName() : QString();
+    const bool isLabelChanged = changes.modified.contains("AndroidManifest.xml");
+    const QString label = (manifest && isLabelChanged) ? manifest->getApplicationLabel() : QString();
+    if (previous == DecodeManifest) {
+        manifestModel.initialize(nullptr);
+        delete manifest;
+        manifest = nullptr;
+    }
+
+    // Only directories and files are renamed here, so the contents are swapped within a single event.
+    // If any of the renames fails, the previous contents are restored. The leftovers are removed in the
+    // background, unless they still hold the files which could not be restored:
+
+    const QString trash = createTemporaryPath();
+    bool restored = false;
+    const bool merged = mergeDecoded(target, contentsPath, trash, previous, carried, &restored);
+    if (merged || restored) {
+        Utils::rmdir(target, true);
+        Utils::rmdir(trash, true);
+    }
+
+    if (previous == DecodeManifest) {
+        manifest = new Manifest(contentsPath + "/AndroidManifest.xml", contentsPath + "/apktool.yml");
+        if (merged) {
+            if (manifest->getMinSdk() != minSdk) { manifest->setMinSdk(minSdk); }
+            if (manifest->getTargetSdk() != targetSdk) { manifest->setTargetSdk(targetSdk); }
+            if (manifest->getVersionCode() != versionCode) { manifest->setVersionCode(versionCode); }
+            if (manifest->getVersionName() != versionName) { manifest->setVersionName(versionName); }
+            if (!label.isEmpty() && !label.startsWith('@') && manifest->getApplicationLabel() != label) {
+                manifest->setApplicationLabel(label);
+            }
+        }
+        manifestModel.initialize(manifest);
+    }
+
+    if (merged) {
+        // The decoded entries become a part of the baseline for patching. The carried files keep their previous
+        // baseline, as they differ from the APK, and so do the kept entries (assets, native libraries, etc.):
+        const QFuture<ContentsSnapshot> baseline = unpackedSnapshot;
+        const QString contents = contentsPath;
+        unpackedSnapshot = QtConcurrent::run([=]() -> ContentsSnapshot {
+            return baseline.result().combine(ContentsSnapshot::capture(contents), [=](const QString &path) {
+                return isReplacedOnDecode(path, previous) && !carried.contains(path);
+            });
+        });
+        decodeProfile = DecodeFull;
+        journalDecode(DecodeFull, decodeElapsed, QtConcurrent::run(&ContentsSnapshot::capture, contentsPath));
+        journal(tr("Done."), LogEntry::Success);
+    } else if (restored) {
+        journal(tr("Error merging APK contents. The previous contents were restored."), LogEntry::Error);
+        state.setLastActionFailed(true);
+    } else {
+        //: "%1" and "%2" will be replaced with paths to directories.
+        const QString descriptive = tr("The replaced files were kept in %1, the decoded files in %2.").arg(trash, target);
+        journal(tr("Error merging APK contents."), descriptive, LogEntry::Error);
+        state.setLastActionFailed(true);
+    }
+    state.setCurrentAction(ProjectState::ProjectIdle);
+}
+
+QFuture<QStringList> Project::getDecodeConflicts() const
+{
+    // Changed files which decodeFully() would replace with their decoded counterparts, i.e., the changes it would lose.
+    // Changes to the application label and to the values of the manifest table are carried over, so apktool.yml is not listed.
+
+    const DecodeProfile profile = decodeProfile;
+    const QFuture<ContentsSnapshot::Changes> changes = profile != DecodeFull ? getChanges() : QFuture<ContentsSnapshot::Changes>();
+    return QtConcurrent::run([=]() -> QStringList {
+        QStringList conflicts;
+        if (profile == DecodeFull) {
+            return conflicts;
+        }
+        const ContentsSnapshot::Changes result = changes.result();
+        for (const QString &path : result.modified + result.added) {
+            if (isReplacedOnDecode(path, profile) && !isCarriedOnDecode(path, profile)) {
+                conflicts.append(path);
+            }
+        }
+        conflicts.sort();
+        return conflicts;
+    });
+}
+
 void Project::save(QString path)
 {
     logModel.clear();
@@ -72,24 +283,29 @@ void Project::save(QString path)
 
     auto taskSave = createSaveTask(path);
 
-    connect(taskSave, &Tasks::Batch::started, this, [=]() {
+    connect(taskSave, &Tasks::Graph::finished, this, [=]() {
+        journalStages(taskSave);
+    });
+
+    connect(taskSave, &Tasks::Graph::started, this, [=]() {
         state.setLastActionFailed(false);
     }, Qt::QueuedConnection);
 
-    connect(taskSave, &Tasks::Batch::success, this, [=]() {
+    connect(taskSave, &Tasks::Graph::success, this, [=]() {
         state.setCurrentAction(ProjectState::ProjectIdle);
         journal(tr("Done."), LogEntry::Success);
     }, Qt::QueuedConnection);
 
-    connect(taskSave, &Tasks::Batch::error, this, [=]() {
+    connect(taskSave, &Tasks::Graph::error, this, [=]() {
         state.setCurrentAction(ProjectState::ProjectIdle);
         state.setLastActionFailed(true);
     }, Qt::QueuedConnection);
 
+    currentTask = taskSave;
     taskSave->run();
 }
 
-void Project::saveAndInstall(QString path, const QString &serial)
+void Project::saveAndInstall(QString path, const QList<Device> &devices)
 {
     logModel.clear();
 
@@ -98,115 +314,129 @@ void Project::saveAndInstall(QString path, const QString &serial)
     const QString directory = fileInfo.absolutePath();
     app->settings->setLastDirectory(directory);
 
-    auto tasks = new Tasks::Batch;
+    auto tasks = new Tasks::Graph;
+    auto taskSave = createSaveTask(path);
+    tasks->add(taskSave, {}, true);
+    tasks->add(createInstallTask(path, devices), {taskSave}, true);
 
-    tasks->add(createSaveTask(path), true);
-    tasks->add(createInstallTask(serial), true);
+    connect(tasks, &Tasks::Graph::finished, this, [=]() {
+        journalStages(tasks);
+    });
 
-    connect(tasks, &Tasks::Batch::started, this, [=]() {
+    connect(tasks, &Tasks::Graph::started, this, [=]() {
         state.setLastActionFailed(false);
     }, Qt::QueuedConnection);
 
-    connect(tasks, &Tasks::Batch::success, this, [=]() {
+    connect(tasks, &Tasks::Graph::success, this, [=]() {
         state.setCurrentAction(ProjectState::ProjectIdle);
         journal(tr("Done."), LogEntry::Success);
     }, Qt::QueuedConnection);
 
-    connect(tasks, &Tasks::Batch::error, this, [=]() {
+    connect(tasks, &Tasks::Graph::error, this, [=]() {
         state.setCurrentAction(ProjectState::ProjectIdle);
         state.setLastActionFailed(true);
     }, Qt::QueuedConnection);
 
+    currentTask = tasks;
     tasks->run();
 }
 
-void Project::install(const QString &serial)
+void Project::install(const QList<Device> &devices)
 {
     logModel.clear();
 
-    auto taskInstall = createInstallTask(serial);
+    auto taskInstall = createInstallTask(originalPath, devices);
 
-    connect(taskInstall, &Tasks::Install::started, this, [=]() {
+    connect(taskInstall, &Tasks::Graph::finished, this, [=]() {
+        journalStages(taskInstall);
+    });
+
+    connect(taskInstall, &Tasks::Graph::started, this, [=]() {
         state.setLastActionFailed(false);
     }, Qt::QueuedConnection);
 
-    connect(taskInstall, &Tasks::Install::success, this, [=]() {
+    connect(taskInstall, &Tasks::Graph::success, this, [=]() {
         state.setCurrentAction(ProjectState::ProjectIdle);
         journal(tr("Done."), LogEntry::Success);
     }, Qt::QueuedConnection);
 
-    connect(taskInstall, &Tasks::Install::error, this, [=]() {
+    connect(taskInstall, &Tasks::Graph::error, this, [=]() {
         state.setCurrentAction(ProjectState::ProjectIdle);
         state.setLastActionFailed(true);
     }, Qt::QueuedConnection);
 
+    currentTask = taskInstall;
     taskInstall->run();
 }
 
+void Project::cancel()
+{
+    // The error and state handling of the cancelled task is the same as for the failed one.
+    if (currentTask) {
+        currentTask->cancel();
+    }
+}
+
+void Project::setKeystore(const Keystore &keystore)
+{
+    presetKeystore = keystore;
+}
+
 Manifest *Project::initialize()
 {
     qDebug() << qPrintable(QString("Initializing \"%1\"...").arg(getOriginalPath()));
 
     filesystemModel.setRootPath(contentsPath);
 
+    // Changes made since the unpacking decide whether the APK can be patched on save instead of rebuilt:
+    unpackedSnapshot = QtConcurrent::run(&ContentsSnapshot::capture, contentsPath);
+
     // Parse application manifest:
 
     manifest = new Manifest(contentsPath + "/AndroidManifest.xml", contentsPath + "/apktool.yml");
     manifestModel.initialize(manifest);
 
-    // Parse resource directories:
-
-    QMap<QString, QModelIndex> mapResourceTypes;
-    QMap<QString, QModelIndex> mapResourceGroups;
-
-    QDirIterator resourceDirectories(contentsPath + "/res/", QDir::Dirs | QDir::NoDotAndDotDot);
-    while (resourceDirectories.hasNext()) {
-
-        const QFileInfo resourceDirectory = QFileInfo(resourceDirectories.next());
-        const QString resourceTypeTitle = resourceDirectory.fileName().split('-').first(); // E.g., "drawable", "values"...
-        QModelIndex resourceTypeIndex = mapResourceTypes.value(resourceTypeTitle, QModelIndex());
-        ResourceNode *resourceTypeNode = nullptr;
-        if (resourceTypeIndex.isValid()) {
-            resourceTypeNode = static_cast<ResourceNode *>(resourceTypeIndex.internalPointer());
-        } else {
-            resourceTypeNode = new ResourceNode(resourceTypeTitle, nullptr);
-            resourceTypeIndex = resourcesModel.addNode(resourceTypeNode);
-            mapResourceTypes[resourceTypeTitle] = resourceTypeIndex;
-        }
-
-        // Parse resource files:
-
-        QDirIterator resourceFiles(resourceDirectory.filePath(), QDir::Files);
-        while (resourceFiles.hasNext()) {
+    // Parse resource directories. Type nodes are shown right away and populated
+    // when expanded, while the full index is built in the background:
 
-            const QFileInfo resourceFile(resourceFiles.next());
-            const QString resourceFilename = resourceFile.fileName();
-
-            QModelIndex resourceGroupIndex = mapResourceGroups.value(resourceFilename, QModelIndex());
-            ResourceNode *resourceGroupNode = nullptr;
-            if (resourceGroupIndex.isValid()) {
-                resourceGroupNode = static_cast<ResourceNode *>(resourceGroupIndex.internalPointer());
-            } else {
-                resourceGroupNode = new ResourceNode(resourceFilename, nullptr);
-                resourceGroupIndex = resourcesModel.addNode(resourceGroupNode, resourceTypeIndex);
-                mapResourceGroups[resourceFilename] = resourceGroupIndex;
-            }
-
-            ResourceNode *fileNode = new ResourceNode(resourceFilename, new ResourceFile(resourceFile.filePath()));
-            resourcesModel.addNode(fileNode, resourceGroupIndex);
+    const QString resourcesPath = contentsPath + "/res/";
+    const QStringList directories = ResourceScanner::listDirectories(resourcesPath);
+    resourcesModel.setDirectories(directories);
+    auto scanner = new ResourceScanner(this);
+    connect(scanner, &ResourceScanner::progress, [=](int value, int total) {
+        logModel.setLoadingProgress(total > 0 ? value * 100 / total : -1);
+    });
+    connect(scanner, &ResourceScanner::finished, [=](ResourceNode *root) {
+        resourcesModel.merge(root);
+        iconsProxy.sort();
+        // Keep the resources in sync with the changes made outside of the application:
+        auto tracker = new ChangeTracker(&resourcesModel, this);
+        tracker->watch(resourcesPath);
+        logModel.setLoadingProgress(-1);
+        scanner->deleteLater();
+        state.setUnpacked(true);
+        emit unpacked(true);
+    });
+    scanner->scan(directories);
+
+    // Decoration updates (e.g., loaded thumbnails) do not modify the project:
+    auto isContentChanged = [](const QVector<int> &roles) {
+        return roles.isEmpty() || roles.contains(Qt::DisplayRole) || roles.contains(Qt::EditRole);
+    };
+    connect(&resourcesModel, &ResourceItemsModel::dataChanged, [=] (const QModelIndex &, const QModelIndex &, const QVector<int> &roles) {
+        if (isContentChanged(roles)) {
+            state.setModified(true);
         }
-    }
-
-    iconsProxy.sort();
-
-    connect(&resourcesModel, &ResourceItemsModel::dataChanged, [=] () {
-        state.setModified(true);
     });
-    connect(&filesystemModel, &QFileSystemModel::dataChanged, [=] () {
-        state.setModified(true);
+    connect(&filesystemModel, &QFileSystemModel::dataChanged, [=] (const QModelIndex &, const QModelIndex &, const QVector<int> &roles) {
+        if (isContentChanged(roles)) {
+            state.setModified(true);
+        }
     });
-    connect(&iconsProxy, &IconItemsModel::dataChanged, [=] () {
-        state.setModified(true);
+    connect(&iconsProxy, &IconItemsModel::dataChanged, [=] (const QModelIndex &, const QModelIndex &, const QVector<int> &roles) {
+        if (isContentChanged(roles)) {
+            state.setModified(true);
+        }
     });
     connect(&manifestModel, &ManifestModel::dataChanged, [=] (const QModelIndex &, const QModelIndex &, const QVector<int> &roles) {
         if (roles.contains(Qt::DisplayRole) || roles.contains(Qt::EditRole)) {
@@ -233,9 +463,18 @@ QString Project::getContentsPath() const
     return QDir::toNativeSeparators(contentsPath);
 }
 
+Project::DecodeProfile Project::getDecodeProfile() const
+{
+    return decodeProfile;
+}
+
 QIcon Project::getThumbnail() const
 {
-    QIcon thumbnail = iconsProxy.getIcon();
+    // The icon read from the APK is used until the resources are decoded.
+    const QIcon icon = iconsProxy.getIcon();
+    if (!icon.isNull()) {
+        return icon;
+    }
     return !thumbnail.isNull() ? thumbnail : app->icons.get("application.png");
 }
 
@@ -259,24 +498,30 @@ void Project::journal(const QString &brief, const QString &descriptive, LogEntry
     logModel.add(brief, descriptive, type);
 }
 
-Tasks::Task *Project::createUnpackTask(const QString &source)
+Tasks::Task *Project::createUnpackTask(const QString &source, DecodeProfile profile)
 {
-    QString target;
-    do {
-        const QString uuid = QUuid::createUuid().toString();
-        target = QDir::toNativeSeparators(QString("%1/%2").arg(app->settings->getOutputDirectory(), uuid));
-    } while (target.isEmpty() || QDir(target).exists());
+    const QString target = createTemporaryPath();
     const QString frameworks = app->settings->getFrameworksDirectory();
-    const bool resources = true;
-    const bool sources = app->settings->getDecompileSources();
+    const bool resources = (profile != DecodeManifest);
+    const bool sources = (profile == DecodeFull);
 
     QDir().mkpath(target);
     QDir().mkpath(frameworks);
 
     // Be careful with the "contentsPath" variable: this directory is recursively removed in the destructor.
     this->contentsPath = target;
+    this->unpackedPath = source;
+    this->unpackedFingerprint = QtConcurrent::run(&ApkPatcher::getFingerprint, source);
+    this->decodeProfile = profile;
 
     auto taskUnpack = new Tasks::Unpack(source, target, frameworks, resources, sources);
+    taskUnpack->setTitle(tr("Unpacking"));
+    taskUnpack->setTimeout(app->settings->getTaskTimeout("Unpack"));
+    queue(taskUnpack);
+
+    connect(taskUnpack, &Tasks::Unpack::finished, this, [=]() {
+        decodeElapsed = taskUnpack->getElapsed();
+    });
 
     connect(taskUnpack, &Tasks::Pack::started, this, [=]() {
         journal(tr("Unpacking APK..."));
@@ -288,8 +533,6 @@ Tasks::Task *Project::createUnpackTask(const QString &source)
     connect(taskUnpack, &Tasks::Unpack::success, this, [=]() {
         journal(tr("Reading APK contents..."));
         initialize();
-        state.setUnpacked(true);
-        emit unpacked(true);
     }, Qt::QueuedConnection);
 
     connect(taskUnpack, &Tasks::Unpack::error, this, [=](const QString &message) {
@@ -300,43 +543,48 @@ Tasks::Task *Project::createUnpackTask(const QString &source)
     return taskUnpack;
 }
 
-Tasks::Task *Project::createSaveTask(const QString &target) // Combines Pack, Zipalign and Sign tasks
+Tasks::Graph *Project::createSaveTask(const QString &target) // Combines Pack, Zipalign and Sign tasks
 {
-    auto taskSave = new Tasks::Batch;
+    // Each stage depends on the previous one, while the stages of different projects
+    // are free to overlap within the limits of the scheduler.
+
+    auto taskSave = new Tasks::Graph;
 
     // Pack APK:
 
-    taskSave->add(createPackTask(target), true);
+    Tasks::Task *previous = createPackTask(target);
+    taskSave->add(previous, {}, true);
 
-    // Optimize APK:
+    // Optimize and sign APK (in a single write, if both stages are enabled):
 
-    if (app->settings->getOptimizeApk()) {
-        taskSave->add(createZipalignTask(target));
-    }
+    const Keystore *keystore = app->settings->getSignApk() ? getKeystore() : nullptr;
+    const bool optimize = app->settings->getOptimizeApk();
+    const bool singlePass = optimize && keystore && app->settings->getSinglePassOutput();
 
-    // Sign APK:
+    if (optimize && !singlePass) {
+        auto taskZipalign = createZipalignTask(target);
+        taskSave->add(taskZipalign, {previous});
+        previous = taskZipalign;
+    }
 
-    if (app->settings->getSignApk()) {
-        const Keystore *keystore = getKeystore();
-        if (keystore) {
-            taskSave->add(createSignTask(target, keystore));
-        }
+    if (keystore) {
+        taskSave->add(createSignTask(target, keystore, singlePass), {previous});
     }
 
     // Done:
 
-    connect(taskSave, &Tasks::Batch::finished, this, [=]() {
+    connect(taskSave, &Tasks::Graph::finished, this, [=]() {
         QFileInfo fileInfo(target);
         title = fileInfo.fileName();
         originalPath = target;
     });
 
-    connect(taskSave, &Tasks::Batch::success, this, [=]() {
+    connect(taskSave, &Tasks::Graph::success, this, [=]() {
         state.setModified(false);
         emit packed(true);
     }, Qt::QueuedConnection);
 
-    connect(taskSave, &Tasks::Batch::error, this, [=]() {
+    connect(taskSave, &Tasks::Graph::error, this, [=]() {
         emit packed(false);
     }, Qt::QueuedConnection);
 
@@ -347,10 +595,16 @@ Tasks::Task *Project::createPackTask(const QString &target)
 {
     const QString source = getContentsPath();
     const QString frameworks = app->settings->getFrameworksDirectory();
-    const bool resources = true;
-    const bool sources = !app->settings->getDecompileSources();
+    const bool resources = (decodeProfile != DecodeManifest);
+    const bool sources = (decodeProfile == DecodeFull);
 
     auto taskPack = new Tasks::Pack(source, target, frameworks, resources, sources);
+    if (app->settings->getIncrementalRepack()) {
+        taskPack->setPatchSource(unpackedPath, unpackedFingerprint, unpackedSnapshot);
+    }
+    taskPack->setTitle(tr("Packing"));
+    taskPack->setTimeout(app->settings->getTaskTimeout("Pack"));
+    queue(taskPack);
 
     connect(taskPack, &Tasks::Pack::started, this, [=]() {
         journal(tr("Packing APK..."));
@@ -368,6 +622,9 @@ Tasks::Task *Project::createPackTask(const QString &target)
 Tasks::Task *Project::createZipalignTask(const QString &target)
 {
     auto taskZipalign = new Tasks::Align(target);
+    taskZipalign->setTitle(tr("Optimizing"));
+    taskZipalign->setTimeout(app->settings->getTaskTimeout("Align"));
+    queue(taskZipalign);
 
     connect(taskZipalign, &Tasks::Align::started, this, [=]() {
         state.setCurrentAction(ProjectState::ProjectOptimizing);
@@ -381,9 +638,12 @@ Tasks::Task *Project::createZipalignTask(const QString &target)
     return taskZipalign;
 }
 
-Tasks::Task *Project::createSignTask(const QString &target, const Keystore *keystore)
+Tasks::Task *Project::createSignTask(const QString &target, const Keystore *keystore, bool align)
 {
-    auto taskSign = new Tasks::Sign(target, keystore);
+    auto taskSign = new Tasks::Sign(target, keystore, align);
+    taskSign->setTitle(align ? tr("Optimizing and signing") : tr("Signing"));
+    taskSign->setTimeout(app->settings->getTaskTimeout("Sign"));
+    queue(taskSign);
 
     connect(taskSign, &Tasks::Sign::finished, [=]() {
         delete keystore;
@@ -391,39 +651,298 @@ Tasks::Task *Project::createSignTask(const QString &target, const Keystore *keys
 
     connect(taskSign, &Tasks::Sign::started, this, [=]() {
         state.setCurrentAction(ProjectState::ProjectSigning);
-        journal(tr("Signing APK..."));
+        journal(align ? tr("Optimizing and signing APK...") : tr("Signing APK..."));
     }, Qt::QueuedConnection);
 
     connect(taskSign, &Tasks::Sign::error, this, [=](const QString &message) {
-        journal(tr("Error signing APK."), message, LogEntry::Error);
+        journal(align ? tr("Error optimizing and signing APK.") : tr("Error signing APK."), message, LogEntry::Error);
     }, Qt::QueuedConnection);
 
     return taskSign;
 }
 
-Tasks::Task *Project::createInstallTask(const QString &serial)
+Tasks::Graph *Project::createInstallTask(const QString &apk, const QList<Device> &devices)
+{
+    // Devices are installed to in parallel. Each install is critical, so that the graph fails if any of them fails,
+    // but as they don't depend on each other, the installs to the other devices are still finished.
+
+    auto taskInstall = new Tasks::Graph;
+    auto installedCount = QSharedPointer<int>::create(0);
+
+    for (const Device &device : devices) {
+        auto taskDevice = createInstallTask(apk, device);
+        connect(taskDevice, &Tasks::Install::success, this, [=]() {
+            ++*installedCount;
+        });
+        taskInstall->add(taskDevice, {}, true);
+    }
+
+    auto journalSummary = [=](LogEntry::Type type) {
+        if (devices.count() > 1) {
+            //: "%1" will be replaced with a number of devices the APK was installed to, "%2" with a total number of devices.
+            journal(tr("Installed to %1 of %2 devices.").arg(*installedCount).arg(devices.count()), type);
+        }
+    };
+
+    connect(taskInstall, &Tasks::Graph::success, this, [=]() {
+        journalSummary(LogEntry::Success);
+        emit installed(true);
+    }, Qt::QueuedConnection);
+
+    connect(taskInstall, &Tasks::Graph::error, this, [=]() {
+        journalSummary(LogEntry::Error);
+        emit installed(false);
+    }, Qt::QueuedConnection);
+
+    return taskInstall;
+}
+
+Tasks::Task *Project::createInstallTask(const QString &apk, const Device &device)
 {
-    auto taskInstall = new Tasks::Install(originalPath, serial);
+    const QString serial = device.getSerial();
+    const QString name = device.getAlias().isEmpty() ? serial : device.getAlias();
+
+    auto taskInstall = new Tasks::Install(apk, serial);
+    //: "%1" will be replaced with a device name.
+    taskInstall->setTitle(tr("Installing to %1").arg(name));
+    taskInstall->setTimeout(app->settings->getTaskTimeout("Install"));
+    queue(taskInstall);
 
     connect(taskInstall, &Tasks::Install::started, this, [=]() {
-        journal(tr("Installing APK..."));
+        //: "%1" will be replaced with a device name.
+        journal(tr("Installing APK to %1...").arg(name));
         state.setCurrentAction(ProjectState::ProjectInstalling);
     }, Qt::QueuedConnection);
 
+    connect(taskInstall, &Tasks::Install::retrying, this, [=](int attempt, int maxAttempts, const QString &message) {
+        //: "%1" will be replaced with a device name, "%2" with an attempt number, "%3" with a maximum number of attempts.
+        journal(tr("Lost connection to %1, retrying (attempt %2 of %3)...").arg(name).arg(attempt).arg(maxAttempts), message, LogEntry::Warning);
+    }, Qt::QueuedConnection);
+
     connect(taskInstall, &Tasks::Install::success, this, [=]() {
-        emit installed(true);
+        //: "%1" will be replaced with a device name.
+        journal(tr("Installed to %1.").arg(name), LogEntry::Success);
     }, Qt::QueuedConnection);
 
     connect(taskInstall, &Tasks::Install::error, this, [=](const QString &message) {
-        journal(tr("Error installing APK."), message, LogEntry::Error);
-        emit installed(false);
+        //: "%1" will be replaced with a device name.
+        journal(tr("Error installing APK to %1.").arg(name), message, LogEntry::Error);
     }, Qt::QueuedConnection);
 
     return taskInstall;
 }
 
-const Keystore *Project::getKeystore() const
+void Project::journalStages(const Tasks::Graph *graph)
+{
+    // Stages which produce the APK also report the number of bytes written to disk. The bytes written
+    // by the external tools (apktool, and the zipalign and apksigner fallbacks) are not measured.
+
+    QStringList stages;
+    qint64 bytesWritten = 0;
+    bool isMeasured = true;
+    for (const Tasks::Graph::Stage &stage : graph->getStages()) {
+        QString line = QString("%1: %2 s").arg(stage.title).arg(stage.elapsed / 1000.0, 0, 'f', 1);
+        if (stage.bytesWritten > 0) {
+            line.append(", " + tr("%1 written").arg(Utils::formatSize(stage.bytesWritten)));
+            bytesWritten += stage.bytesWritten;
+        } else if (stage.bytesWritten < 0) {
+            line.append(", " + tr("bytes written not measured"));
+            isMeasured = false;
+        }
+        stages << line;
+    }
+    if (!stages.isEmpty()) {
+        const QString elapsed = tr("Finished in %1 s.").arg(graph->getElapsed() / 1000.0, 0, 'f', 1);
+        QString brief = elapsed;
+        if (bytesWritten && isMeasured) {
+            brief = QString("%1 %2").arg(elapsed, tr("%1 written to disk.").arg(Utils::formatSize(bytesWritten)));
+        } else if (bytesWritten) {
+            brief = QString("%1 %2").arg(elapsed, tr("%1 written to disk, not counting the external tools.").arg(Utils::formatSize(bytesWritten)));
+        }
+        journal(brief, stages.join('\n'));
+    }
+}
+
+void Project::journalDecode(DecodeProfile profile, qint64 elapsed, const QFuture<ContentsSnapshot> &contents)
+{
+    // Reports the decode time and the size of the decoded tree, so that the decode profiles can be compared.
+
+    auto report = [=](const ContentsSnapshot &snapshot) {
+        const QString brief = tr("Decoded in %1 s, %2 on disk.").arg(elapsed / 1000.0, 0, 'f', 1).arg(Utils::formatSize(snapshot.getSize()));
+        //: "%1" will be replaced with a decode profile title (e.g., "Resources only"), "%2" with a number of files.
+        const QString descriptive = tr("%1: %2 files").arg(getDecodeProfileTitle(profile)).arg(snapshot.getCount());
+        journal(brief, descriptive);
+        qDebug() << qPrintable(QString("Decode profile %1: %2 ms, %3 bytes in %4 files\n").arg(profile).arg(elapsed).arg(snapshot.getSize()).arg(snapshot.getCount()));
+    };
+    if (contents.isFinished()) {
+        report(contents.result());
+        return;
+    }
+    auto watcher = new QFutureWatcher<ContentsSnapshot>(this);
+    connect(watcher, &QFutureWatcher<ContentsSnapshot>::finished, this, [=]() {
+        report(watcher->result());
+        watcher->deleteLater();
+    });
+    watcher->setFuture(contents);
+}
+
+QString Project::createTemporaryPath()
+{
+    QString path;
+    do {
+        const QString uuid = QUuid::createUuid().toString();
+        path = QDir::toNativeSeparators(QString("%1/%2").arg(app->settings->getOutputDirectory(), uuid));
+    } while (path.isEmpty() || QDir(path).exists());
+    return path;
+}
+
+bool Project::isReplacedOnDecode(const QString &path, DecodeProfile previous)
+{
+    // Paths are relative to the contents directory, see mergeDecoded() for the replaced entries.
+
+    if (previous == DecodeFull) {
+        return false;
+    }
+    if (previous == DecodeResources) {
+        return !path.contains('/') && QRegularExpression("^classes\\d*\\.dex$").match(path).hasMatch();
+    }
+    const QString entry = path.section('/', 0, 0);
+    return !QStringList({"assets", "lib", "unknown", "apktool.yml"}).contains(entry);
+}
+
+bool Project::isCarriedOnDecode(const QString &path, DecodeProfile previous)
+{
+    // Raw resource files other than the binary XML files are the same after decoding:
+    return previous == DecodeManifest && path.startsWith("res/") && !path.endsWith(".xml", Qt::CaseInsensitive);
+}
+
+bool Project::mergeDecoded(const QString &decoded, const QString &contents, const QString &trash,
+                           DecodeProfile previous, const QStringList &carried, bool *restored)
+{
+    // Moves the newly decoded entries into the contents directory, while the replaced entries are moved to the trash.
+    // Raw files (assets, native libraries and unknown files) are the same in every profile and may have been edited,
+    // so they are kept. The "res" directory itself is kept in place for the change tracker to pick up its new contents.
+    // The carried files (relative to the contents directory) are moved over their decoded counterparts first.
+    // Every rename is recorded, so that the contents can be restored once any of the renames fails.
+
+    QList<QPair<QString, QString>> renames;
+    bool success = QDir().mkpath(trash);
+    int trashed = 0;
+    auto rename = [&](const QString &from, const QString &to) {
+        if (success) {
+            success = QDir().rename(from, to);
+            if (success) {
+                renames.append(qMakePair(from, to));
+            }
+        }
+    };
+    auto discard = [&](const QString &path) {
+        rename(path, QString("%1/%2").arg(trash).arg(trashed++));
+    };
+    auto move = [&](const QString &from, const QString &to) {
+        if (QFileInfo::exists(to)) {
+            discard(to);
+        }
+        rename(from, to);
+    };
+
+    const QDir::Filters filter = QDir::AllEntries | QDir::Hidden | QDir::NoDotAndDotDot;
+    const QDir source(decoded);
+    const QDir target(contents);
+
+    for (const QString &path : carried) {
+        if (success) {
+            success = QDir().mkpath(QFileInfo(source.filePath(path)).absolutePath());
+        }
+        move(target.filePath(path), source.filePath(path));
+    }
+
+    if (previous == DecodeResources) {
+        for (const QString &dex : target.entryList({"classes*.dex"}, QDir::Files)) {
+            discard(target.filePath(dex));
+        }
+        for (const QString &smali : source.entryList({"smali*"}, QDir::Dirs | QDir::NoDotAndDotDot)) {
+            move(source.filePath(smali), target.filePath(smali));
+        }
+    } else {
+        const QStringList kept = {"assets", "lib", "unknown"};
+        for (const QString &name : target.entryList(filter)) {
+            if (!kept.contains(name) && name != "res" && !source.exists(name)) {
+                discard(target.filePath(name));
+            }
+        }
+        for (const QString &name : source.entryList(filter)) {
+            if (name == "res" && QFileInfo(target.filePath(name)).isDir()) {
+                const QDir decodedResources(source.filePath(name));
+                const QDir resources(target.filePath(name));
+                for (const QString &directory : resources.entryList(filter)) {
+                    discard(resources.filePath(directory));
+                }
+                for (const QString &directory : decodedResources.entryList(filter)) {
+                    move(decodedResources.filePath(directory), resources.filePath(directory));
+                }
+            } else if (!kept.contains(name) || !target.exists(name)) {
+                move(source.filePath(name), target.filePath(name));
+            }
+        }
+    }
+
+    // Rollback:
+
+    if (!success) {
+        bool isRestored = true;
+        for (int i = renames.count() - 1; i >= 0; --i) {
+            isRestored &= QDir().rename(renames.at(i).second, renames.at(i).first);
+        }
+        *restored = isRestored;
+    }
+    return success;
+}
+
+QFuture<ContentsSnapshot::Changes> Project::getChanges() const
+{
+    // Changes made to the contents since the APK was opened. The contents are captured in background.
+    const QFuture<ContentsSnapshot> baseline = unpackedSnapshot;
+    const QString contents = contentsPath;
+    return QtConcurrent::run([=]() -> ContentsSnapshot::Changes {
+        return baseline.result().compare(ContentsSnapshot::capture(contents));
+    });
+}
+
+void Project::queue(Tasks::Task *task)
 {
+    // Tasks of this project are prioritized by the scheduler while it's in the foreground:
+    task->setOwner(this);
+    connect(task, &Tasks::Task::queued, this, [=](int position) {
+        logModel.setQueuePosition(position);
+    });
+
+    // The output of the running tool is shown live:
+    connect(task, &Tasks::Task::output, this, [=](const QString &line) {
+        const QString text = line.trimmed();
+        if (!text.isEmpty()) {
+            logModel.setLiveOutput(text);
+        }
+    });
+    connect(task, &Tasks::Task::finished, this, [=]() {
+        logModel.setLiveOutput(QString());
+    });
+}
+
+const Keystore *Project::getKeystore()
+{
+    if (!presetKeystore.keystorePath.isEmpty()) {
+        const Keystore *keystore = new Keystore(presetKeystore);
+        presetKeystore = Keystore();
+        return keystore;
+    }
+    return createKeystore();
+}
+
+const Keystore *Project::createKeystore()
+{
+    // Missing keystore details are requested from the user. Returns nullptr if cancelled.
+
     Keystore *keystore = new Keystore;
     if (app->settings->getCustomKeystore()) {
         keystore->keystorePath = app->settings->getKeystorePath();
@@ -7,21 +7,38 @@
 #include "apk/iconitemsmodel.h"
 #include "apk/logmodel.h"
 #include "apk/projectstate.h"
+#include "base/device.h"
 #include "base/tasks.h"
+#include <QFuture>
 #include <QIcon>
+#include <QPointer>
 
 class Project : public QObject
 {
     Q_OBJECT
 
 public:
+    enum DecodeProfile {
+        DecodeManifest,  // Only the manifest is decoded; resources and DEX files are kept raw
+        DecodeResources, // Resources are decoded; DEX files are kept raw
+        DecodeFull       // Resources are decoded and DEX files are disassembled to smali
+    };
+
     Project(const QString &path);
     ~Project() override;
 
-    void unpack();
+    static DecodeProfile getDefaultDecodeProfile();
+    static QString getDecodeProfileTitle(DecodeProfile profile);
+    static const Keystore *createKeystore();
+
+    void unpack(DecodeProfile profile = getDefaultDecodeProfile());
+    void decodeFully();
+    QFuture<QStringList> getDecodeConflicts() const;
     void save(QString path);
-    void install(const QString &serial);
-    void saveAndInstall(QString path, const QString &serial);
+    void install(const QList<Device> &devices);
+    void saveAndInstall(QString path, const QList<Device> &devices);
+    void cancel();
+    void setKeystore(const Keystore &keystore);
 
     Manifest *initialize();
 
@@ -29,6 +46,7 @@ public:
     QString getOriginalPath() const;
     QString getContentsPath() const;
     QIcon getThumbnail() const;
+    DecodeProfile getDecodeProfile() const;
     const Manifest *getManifest() const;
     const ProjectState &getState() const;
 
@@ -48,22 +66,42 @@ signals:
     void changed() const;
 
 private:
-    Tasks::Task *createUnpackTask(const QString &source);
-    Tasks::Task *createSaveTask(const QString &target); // Combines Pack, Zipalign and Sign tasks
+    Tasks::Task *createUnpackTask(const QString &source, DecodeProfile profile);
+    Tasks::Graph *createSaveTask(const QString &target); // Combines Pack, Zipalign and Sign tasks
     Tasks::Task *createPackTask(const QString &target);
     Tasks::Task *createZipalignTask(const QString &target);
-    Tasks::Task *createSignTask(const QString &target, const Keystore *keystore);
-    Tasks::Task *createInstallTask(const QString &serial);
+    Tasks::Task *createSignTask(const QString &target, const Keystore *keystore, bool align = false);
+    Tasks::Graph *createInstallTask(const QString &apk, const QList<Device> &devices); // Combines Install tasks for each device
+    Tasks::Task *createInstallTask(const QString &apk, const Device &device);
+    void queue(Tasks::Task *task);
+    void journalStages(const Tasks::Graph *graph);
+    void journalDecode(DecodeProfile profile, qint64 elapsed, const QFuture<ContentsSnapshot> &contents);
+
+    void mergeDecodedContents(const QString &target, DecodeProfile previous, const ContentsSnapshot::Changes &changes);
+    QFuture<ContentsSnapshot::Changes> getChanges() const;
+
+    static QString createTemporaryPath();
+    static bool isReplacedOnDecode(const QString &path, DecodeProfile previous);
+    static bool isCarriedOnDecode(const QString &path, DecodeProfile previous);
+    static bool mergeDecoded(const QString &decoded, const QString &contents, const QString &trash,
+                             DecodeProfile previous, const QStringList &carried, bool *restored);
 
-    const Keystore *getKeystore() const;
+    const Keystore *getKeystore();
 
     ProjectState state;
+    QPointer<Tasks::Task> currentTask;
 
     QString title;
     QString originalPath;
     QString contentsPath;
+    QString unpackedPath; // The APK which the contents were decoded from
+    QFuture<QByteArray> unpackedFingerprint;
+    QFuture<ContentsSnapshot> unpackedSnapshot;
+    DecodeProfile decodeProfile;
+    qint64 decodeElapsed;
     QIcon thumbnail;
     Manifest *manifest;
+    Keystore presetKeystore; // Used for the next save instead of the keystore from the settings, if set
 };
 
 #endif // PROJECT_H
@@ -6,11 +6,11 @@ ProjectItemsModel::~ProjectItemsModel()
     qDeleteAll(projects);
 }
 
-Project *ProjectItemsModel::open(const QString &filename, bool unpack)
+Project *ProjectItemsModel::open(const QString &filename, bool unpack, Project::DecodeProfile profile)
 {
     auto project = new Project(filename);
     if (unpack) {
-        project->unpack();
+        project->unpack(profile);
     }
 
     beginInsertRows(QModelIndex(), rowCount(), rowCount());
@@ -24,7 +24,7 @@ public:
 
     ~ProjectItemsModel() override;
 
-    Project *open(const QString &filename, bool unpack = true);
+    Project *open(const QString &filename, bool unpack = true, Project::DecodeProfile profile = Project::getDefaultDecodeProfile());
     bool close(Project *project);
 
     Project *existing(const QString &filename) const;
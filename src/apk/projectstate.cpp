@@ -67,6 +67,11 @@ bool ProjectState::canInstall() const
     return isUnpacked() && (currentAction == ProjectIdle);
 }
 
+bool ProjectState::canCancel() const
+{
+    return currentAction != ProjectIdle;
+}
+
 bool ProjectState::canExplore() const
 {
     return isUnpacked();
@@ -32,6 +32,7 @@ public:
     bool canEdit() const;
     bool canSave() const;
     bool canInstall() const;
+    bool canCancel() const;
     bool canExplore() const;
     bool canClose() const;
 
@@ -3,110 +3,247 @@
 #include "base/utils.h"
 #include <QFileInfo>
 #include <QLocale>
-#include <QRegularExpression>
 #include <QFileIconProvider>
+#include <algorithm>
+#include <iterator>
+#include <limits>
 
 namespace Qualifiers
 {
     // Read more: https://developer.android.com/guide/topics/resources/providing-resources.html?hl=en
-    const QStringList layoutDirection = {"ldrtl", "ldltr"};
-    const QStringList screenSize = {"small", "normal", "large", "xlarge"};
-    const QStringList screenAspect = {"long", "notlong"};
-    const QStringList roundScreen = {"round", "notround"};
-    const QStringList wideColorGamut = {"widecg", "nowidecg"};
-    const QStringList hdr = {"highdr", "lowdr"};
-    const QStringList screenOrientation = {"port", "land"};
-    const QStringList uiMode = {"car", "desk", "television", "appliance", "watch", "vrheadset"};
-    const QStringList nightMode = {"night", "notnight"};
-    const QStringList dpi = {"ldpi", "mdpi", "hdpi", "xhdpi", "xxhdpi", "xxxhdpi", "nodpi", "tvdpi", "anydpi"};
-    const QStringList touchscreenType = {"notouch", "finger"};
-    const QStringList keyboardAvailability = {"keysexposed", "keyshidden", "keyssoft"};
-    const QStringList inputMethod = {"nokeys", "qwerty", "12key"};
-    const QStringList navigationAvailability = {"navexposed", "navhidden"};
-    const QStringList navigationMethod = {"nonav", "dpad", "trackball", "wheel"};
-}
-
-ResourceFile::ResourceFile(const QString &path)
-{
-    if (Q_UNLIKELY(path.isEmpty())) {
-        qFatal("CRITICAL: Empty path passed to resource file constructor");
+
+    struct Token
+    {
+        const char *name;
+        ResourceQualifiers::Qualifier type;
+    };
+
+    // This table must be kept sorted by token name, as it is used for the binary search.
+    const Token tokens[] = {
+        {"12key", ResourceQualifiers::InputMethod},
+        {"anydpi", ResourceQualifiers::Dpi},
+        {"appliance", ResourceQualifiers::UiMode},
+        {"car", ResourceQualifiers::UiMode},
+        {"desk", ResourceQualifiers::UiMode},
+        {"dpad", ResourceQualifiers::NavigationMethod},
+        {"finger", ResourceQualifiers::TouchscreenType},
+        {"hdpi", ResourceQualifiers::Dpi},
+        {"highdr", ResourceQualifiers::Hdr},
+        {"keysexposed", ResourceQualifiers::KeyboardAvailability},
+        {"keyshidden", ResourceQualifiers::KeyboardAvailability},
+        {"keyssoft", ResourceQualifiers::KeyboardAvailability},
+        {"land", ResourceQualifiers::ScreenOrientation},
+        {"large", ResourceQualifiers::ScreenSize},
+        {"ldltr", ResourceQualifiers::LayoutDirection},
+        {"ldpi", ResourceQualifiers::Dpi},
+        {"ldrtl", ResourceQualifiers::LayoutDirection},
+        {"long", ResourceQualifiers::ScreenAspect},
+        {"lowdr", ResourceQualifiers::Hdr},
+        {"mdpi", ResourceQualifiers::Dpi},
+        {"navexposed", ResourceQualifiers::NavigationAvailability},
+        {"navhidden", ResourceQualifiers::NavigationAvailability},
+        {"night", ResourceQualifiers::NightMode},
+        {"nodpi", ResourceQualifiers::Dpi},
+        {"nokeys", ResourceQualifiers::InputMethod},
+        {"nonav", ResourceQualifiers::NavigationMethod},
+        {"normal", ResourceQualifiers::ScreenSize},
+        {"notlong", ResourceQualifiers::ScreenAspect},
+        {"notnight", ResourceQualifiers::NightMode},
+        {"notouch", ResourceQualifiers::TouchscreenType},
+        {"notround", ResourceQualifiers::RoundScreen},
+        {"nowidecg", ResourceQualifiers::WideColorGamut},
+        {"port", ResourceQualifiers::ScreenOrientation},
+        {"qwerty", ResourceQualifiers::InputMethod},
+        {"round", ResourceQualifiers::RoundScreen},
+        {"small", ResourceQualifiers::ScreenSize},
+        {"television", ResourceQualifiers::UiMode},
+        {"trackball", ResourceQualifiers::NavigationMethod},
+        {"tvdpi", ResourceQualifiers::Dpi},
+        {"vrheadset", ResourceQualifiers::UiMode},
+        {"watch", ResourceQualifiers::UiMode},
+        {"wheel", ResourceQualifiers::NavigationMethod},
+        {"widecg", ResourceQualifiers::WideColorGamut},
+        {"xhdpi", ResourceQualifiers::Dpi},
+        {"xlarge", ResourceQualifiers::ScreenSize},
+        {"xxhdpi", ResourceQualifiers::Dpi},
+        {"xxxhdpi", ResourceQualifiers::Dpi},
+    };
+
+    // Parses "<prefix><number><suffix>" qualifiers (e.g., "sw600dp" or "v21"); returns -1 if not matched.
+    int parseNumeric(const QStringRef &qualifier, QLatin1String prefix, QLatin1String suffix = QLatin1String(""))
+    {
+        const int digitsFrom = prefix.size();
+        const int digitsTo = qualifier.size() - suffix.size();
+        if (digitsTo <= digitsFrom || !qualifier.startsWith(prefix) || !qualifier.endsWith(suffix)) {
+            return -1;
+        }
+        for (int i = digitsFrom; i < digitsTo; ++i) {
+            const QChar c = qualifier.at(i);
+            if (c < QLatin1Char('0') || c > QLatin1Char('9')) {
+                return -1;
+            }
+        }
+        bool ok;
+        const int number = qualifier.mid(digitsFrom, digitsTo - digitsFrom).toInt(&ok);
+        return (ok && number <= std::numeric_limits<qint16>::max()) ? number : -1;
     }
 
-    this->path = QDir::fromNativeSeparators(path);
-    const QStringList directoryParts = path.split('/');
-    if (Q_UNLIKELY(directoryParts.size() < 2)) {
-        qFatal("CRITICAL: Invalid path passed to resource file constructor");
+    // Matches "r<region>" qualifiers, e.g. "rUS".
+    bool isRegion(const QStringRef &qualifier)
+    {
+        return qualifier.size() == 3 && qualifier.at(0) == QLatin1Char('r')
+            && qualifier.at(1).isLetter() && qualifier.at(2).isLetter()
+            && qualifier.at(1).unicode() < 128 && qualifier.at(2).unicode() < 128;
     }
-    qualifiers = directoryParts.at(directoryParts.size() - 2);
-    QStringList qualifiersParts = qualifiers.split('-');
-    this->type = qualifiersParts.takeFirst();
-    // Replace "-r" region code prefix with "_":
-    qualifiersParts = qualifiersParts.join('-').replace(QRegularExpression("(-r)(?=[A-Za-z]{2}(?=\\z|-))"), "_").split('-');
-    this->readableQualifiers = qualifiersParts.join(" - ");
-
-    for (const QString &qualifier : qualifiersParts) {
-        if (Qualifiers::layoutDirection.contains(qualifier)) {
-            layoutDirection = qualifier;
-        } else if (qualifier.contains(QRegularExpression("sw\\d+dp"))) {
-            smallestWidth = qualifier;
-        } else if (qualifier.contains(QRegularExpression("w\\d+dp"))) {
-            availableWidth = qualifier;
-        } else if (qualifier.contains(QRegularExpression("h\\d+dp"))) {
-            availableHeight = qualifier;
-        } else if (Qualifiers::screenSize.contains(qualifier)) {
-            screenSize = qualifier;
-        } else if (Qualifiers::screenAspect.contains(qualifier)) {
-            screenAspect = qualifier;
-        } else if (Qualifiers::roundScreen.contains(qualifier)) {
-            roundScreen = qualifier;
-        } else if (Qualifiers::wideColorGamut.contains(qualifier)) {
-            wideColorGamut = qualifier;
-        } else if (Qualifiers::hdr.contains(qualifier)) {
-            hdr = qualifier;
-        } else if (Qualifiers::screenOrientation.contains(qualifier)) {
-            screenOrientation = qualifier;
-        } else if (Qualifiers::uiMode.contains(qualifier)) {
-            uiMode = qualifier;
-        } else if (Qualifiers::nightMode.contains(qualifier)) {
-            nightMode = qualifier;
-        } else if (Qualifiers::dpi.contains(qualifier)) {
-            dpi = qualifier;
-        } else if (Qualifiers::touchscreenType.contains(qualifier)) {
-            touchscreenType = qualifier;
-        } else if (Qualifiers::keyboardAvailability.contains(qualifier)) {
-            keyboardAvailability = qualifier;
-        } else if (Qualifiers::inputMethod.contains(qualifier)) {
-            inputMethod = qualifier;
-        } else if (Qualifiers::navigationAvailability.contains(qualifier)) {
-            navigationAvailability = qualifier;
-        } else if (Qualifiers::navigationMethod.contains(qualifier)) {
-            navigationMethod = qualifier;
-        } else if (qualifier.contains(QRegularExpression("v\\d+"))) {
-            apiVersion = qualifier;
+
+    // Returns the qualifier type and its compact value (token table index or number).
+    ResourceQualifiers::Qualifier classify(const QStringRef &qualifier, int &value)
+    {
+        auto begin = std::begin(tokens);
+        auto end = std::end(tokens);
+        auto it = std::lower_bound(begin, end, qualifier, [](const Token &token, const QStringRef &qualifier) {
+            return qualifier.compare(QLatin1String(token.name)) > 0;
+        });
+        if (it != end && qualifier.compare(QLatin1String(it->name)) == 0) {
+            value = static_cast<int>(it - begin);
+            return it->type;
+        }
+        if ((value = parseNumeric(qualifier, QLatin1String("sw"), QLatin1String("dp"))) >= 0) {
+            return ResourceQualifiers::SmallestWidth;
+        }
+        if ((value = parseNumeric(qualifier, QLatin1String("w"), QLatin1String("dp"))) >= 0) {
+            return ResourceQualifiers::AvailableWidth;
+        }
+        if ((value = parseNumeric(qualifier, QLatin1String("h"), QLatin1String("dp"))) >= 0) {
+            return ResourceQualifiers::AvailableHeight;
+        }
+        if ((value = parseNumeric(qualifier, QLatin1String("v"))) >= 0) {
+            return ResourceQualifiers::ApiVersion;
+        }
+        return ResourceQualifiers::Locale;
+    }
+}
+
+// Resource Qualifiers
+
+ResourceQualifiers::ResourceQualifiers(const QString &directory)
+{
+    d = new ResourceQualifiersPrivate;
+    d->qualifiers = directory;
+    std::fill(std::begin(d->values), std::end(d->values), -1);
+
+    const QVector<QStringRef> qualifiersParts = d->qualifiers.splitRef('-');
+    d->type = qualifiersParts.first().toString();
+
+    for (int i = 1; i < qualifiersParts.size(); ++i) {
+        const QStringRef qualifier = qualifiersParts.at(i);
+        if (!d->readableQualifiers.isEmpty()) {
+            d->readableQualifiers.append(" - ");
+        }
+
+        // Join the "-r" region code with the preceding language code (e.g., "en-rUS" becomes "en_US"):
+        if (i + 1 < qualifiersParts.size() && Qualifiers::isRegion(qualifiersParts.at(i + 1))) {
+            const QStringRef region = qualifiersParts.at(++i).mid(1);
+            d->locale = qualifier.toString();
+            d->locale.append('_').append(region);
+            d->localeLegacy = d->locale;
+            d->readableQualifiers.append(d->locale);
+            continue;
+        }
+        d->readableQualifiers.append(qualifier);
+
+        int value;
+        const Qualifier type = Qualifiers::classify(qualifier, value);
+        if (type != Locale) {
+            d->values[type] = static_cast<qint16>(value);
         } else {
-            locale = qualifier;
+            d->locale = qualifier.toString();
             // Handle legacy locales:
-            if (locale == "iw") {
-                localeLegacy = "he";
-            } else if (locale == "ji") {
-                localeLegacy = "yi";
-            } else if (locale == "in") {
-                localeLegacy = "id";
+            if (d->locale == "iw") {
+                d->localeLegacy = "he";
+            } else if (d->locale == "ji") {
+                d->localeLegacy = "yi";
+            } else if (d->locale == "in") {
+                d->localeLegacy = "id";
             } else {
-                localeLegacy = locale;
+                d->localeLegacy = d->locale;
             }
         }
     }
 }
 
+QString ResourceQualifiers::getQualifiers() const
+{
+    return d->qualifiers;
+}
+
+QString ResourceQualifiers::getReadableQualifiers() const
+{
+    return d->readableQualifiers;
+}
+
+QString ResourceQualifiers::getType() const
+{
+    return d->type;
+}
+
+QString ResourceQualifiers::getValue(Qualifier qualifier) const
+{
+    if (qualifier == Locale) {
+        return d->locale;
+    }
+    const int value = d->values[qualifier];
+    if (value < 0) {
+        return QString();
+    }
+    switch (qualifier) {
+    case SmallestWidth:   return QString("sw%1dp").arg(value);
+    case AvailableWidth:  return QString("w%1dp").arg(value);
+    case AvailableHeight: return QString("h%1dp").arg(value);
+    case ApiVersion:      return QString("v%1").arg(value);
+    default:
+        return QString::fromLatin1(Qualifiers::tokens[value].name);
+    }
+}
+
+QString ResourceQualifiers::getLocaleLegacy() const
+{
+    return d->localeLegacy;
+}
+
+// Resource File
+
+ResourceFile::ResourceFile(const QString &path) : ResourceFile(path, ResourceQualifiers(getDirectoryName(path)))
+{
+}
+
+ResourceFile::ResourceFile(const QString &path, const ResourceQualifiers &qualifiers) : qualifiers(qualifiers)
+{
+    this->path = QDir::fromNativeSeparators(path);
+}
+
+QString ResourceFile::getDirectoryName(const QString &path)
+{
+    if (Q_UNLIKELY(path.isEmpty())) {
+        qFatal("CRITICAL: Empty path passed to resource file constructor");
+    }
+    const QString normalized = QDir::fromNativeSeparators(path);
+    const int fileSeparator = normalized.lastIndexOf('/');
+    if (Q_UNLIKELY(fileSeparator < 0)) {
+        qFatal("CRITICAL: Invalid path passed to resource file constructor");
+    }
+    const int directorySeparator = fileSeparator > 0 ? normalized.lastIndexOf('/', fileSeparator - 1) : -1;
+    return normalized.mid(directorySeparator + 1, fileSeparator - directorySeparator - 1);
+}
+
 QString ResourceFile::getQualifiers() const
 {
-    return qualifiers;
+    return qualifiers.getQualifiers();
 }
 
 QString ResourceFile::getReadableQualifiers() const
 {
-    return readableQualifiers;
+    return qualifiers.getReadableQualifiers();
 }
 
 QString ResourceFile::getName() const
@@ -116,33 +253,33 @@ QString ResourceFile::getName() const
 
 QString ResourceFile::getType() const
 {
-    return type;
+    return qualifiers.getType();
 }
 
 QString ResourceFile::getDpi() const
 {
-    return dpi.toUpper();
+    return qualifiers.getValue(ResourceQualifiers::Dpi).toUpper();
 }
 
 QString ResourceFile::getApiVersion() const
 {
-    return apiVersion;
+    return qualifiers.getValue(ResourceQualifiers::ApiVersion);
 }
 
 QString ResourceFile::getLocaleCode() const
 {
-    return locale;
+    return qualifiers.getValue(ResourceQualifiers::Locale);
 }
 
 QString ResourceFile::getLanguageName() const
 {
-    QString native = QLocale(localeLegacy).nativeLanguageName();
+    QString native = QLocale(qualifiers.getLocaleLegacy()).nativeLanguageName();
     return Utils::capitalize(native);
 }
 
 QPixmap ResourceFile::getLanguageIcon() const
 {
-    return app->getLocaleFlag(QLocale(localeLegacy));
+    return app->getLocaleFlag(QLocale(qualifiers.getLocaleLegacy()));
 }
 
 QString ResourceFile::getFileName() const
@@ -164,8 +301,9 @@ QIcon ResourceFile::getFileIcon() const
 {
     const QString filePath = getFilePath();
     if (Utils::isImageReadable(filePath)) {
-        QPixmap thumbnail(filePath);
-        return thumbnail;
+        // Thumbnails are decoded asynchronously; show a placeholder until then.
+        const QPixmap thumbnail = app->thumbnails.get(filePath);
+        return !thumbnail.isNull() ? QIcon(thumbnail) : app->icons.get("wait.png");
     }
     return QFileIconProvider().icon(QFileInfo(filePath));
 }
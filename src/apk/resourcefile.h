@@ -3,11 +3,63 @@
 
 #include <QString>
 #include <QPixmap>
+#include <QSharedData>
+
+class ResourceQualifiers
+{
+public:
+    enum Qualifier {
+        LayoutDirection,
+        SmallestWidth,
+        AvailableWidth,
+        AvailableHeight,
+        ScreenSize,
+        ScreenAspect,
+        RoundScreen,
+        WideColorGamut,
+        Hdr,
+        ScreenOrientation,
+        UiMode,
+        NightMode,
+        Dpi,
+        TouchscreenType,
+        KeyboardAvailability,
+        InputMethod,
+        NavigationAvailability,
+        NavigationMethod,
+        ApiVersion,
+        Locale,
+        QualifierCount
+    };
+
+    explicit ResourceQualifiers(const QString &directory); // E.g., "drawable-en-rUS-hdpi"
+
+    QString getQualifiers() const;
+    QString getReadableQualifiers() const;
+    QString getType() const;
+    QString getValue(Qualifier qualifier) const;
+    QString getLocaleLegacy() const;
+
+private:
+    class ResourceQualifiersPrivate : public QSharedData
+    {
+    public:
+        QString qualifiers;
+        QString readableQualifiers;
+        QString type;
+        QString locale;
+        QString localeLegacy;
+        qint16 values[QualifierCount]; // Token table indices or numeric values; -1 if not specified
+    };
+
+    QSharedDataPointer<ResourceQualifiersPrivate> d;
+};
 
 class ResourceFile
 {
 public:
-    ResourceFile(const QString &path);
+    explicit ResourceFile(const QString &path);
+    ResourceFile(const QString &path, const ResourceQualifiers &qualifiers);
 
     QString getQualifiers() const;
     QString getReadableQualifiers() const;
@@ -24,33 +76,10 @@ public:
     QIcon getFileIcon() const;
 
 private:
+    static QString getDirectoryName(const QString &path);
+
     QString path;
-    QString type;
-    QString qualifiers;
-    QString readableQualifiers;
-
-    // Qualifiers:
-    QString locale;
-    QString localeLegacy;
-    QString layoutDirection;
-    QString apiVersion;
-    QString smallestWidth;
-    QString availableWidth;
-    QString availableHeight;
-    QString screenSize;
-    QString screenAspect;
-    QString roundScreen;
-    QString wideColorGamut;
-    QString hdr;
-    QString screenOrientation;
-    QString uiMode;
-    QString nightMode;
-    QString dpi;
-    QString touchscreenType;
-    QString keyboardAvailability;
-    QString inputMethod;
-    QString navigationAvailability;
-    QString navigationMethod;
+    ResourceQualifiers qualifiers; // Shared by all files within the same directory
 };
 
 #endif // RESOURCEFILE_H
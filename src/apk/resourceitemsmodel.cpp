@@ -1,5 +1,11 @@
 #include "apk/resourceitemsmodel.h"
+#include "apk/resourcescanner.h"
+#include "base/application.h"
 #include "base/utils.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QtConcurrent/QtConcurrent>
+#include <functional>
 #include <QIcon>
 
 #ifdef QT_DEBUG
@@ -10,22 +16,217 @@ ResourceItemsModel::ResourceItemsModel(const Project *apk, QObject *parent) : QA
 {
     this->apk = apk;
     root = new ResourceNode();
+
+    connect(&app->thumbnails, &ThumbnailProvider::ready, this, [=](const QString &path) {
+        const QModelIndex index = findIndex(path);
+        if (index.isValid()) {
+            const QModelIndex captionIndex = index.sibling(index.row(), NodeCaption);
+            emit dataChanged(captionIndex, captionIndex, {Qt::DecorationRole, IconRole});
+        }
+    });
 }
 
 ResourceItemsModel::~ResourceItemsModel()
 {
+    // The results of the background reads are owned by the model:
+    for (QFutureWatcherBase *child : findChildren<QFutureWatcherBase *>(QString(), Qt::FindDirectChildrenOnly)) {
+        auto watcher = static_cast<QFutureWatcher<ResourceNode *> *>(child);
+        watcher->waitForFinished();
+        delete watcher->result();
+    }
     delete root;
 }
 
 QModelIndex ResourceItemsModel::addNode(ResourceNode *node, const QModelIndex &parent)
 {
+    addNodes({node}, parent);
+    return createIndex(rowCount(parent) - 1, 0, node);
+}
+
+void ResourceItemsModel::addNodes(const QList<ResourceNode *> &nodes, const QModelIndex &parent)
+{
+    // Nodes are appended as a single contiguous range to keep the number of notifications low.
+    if (nodes.isEmpty()) {
+        return;
+    }
     ResourceNode *parentNode = parent.isValid() ? static_cast<ResourceNode *>(parent.internalPointer()) : root;
-    beginInsertRows(parent, rowCount(parent), rowCount(parent));
-        parentNode->addChild(node);
+    const int first = rowCount(parent);
+    const int last = first + nodes.count() - 1;
+    beginInsertRows(parent, first, last);
+        for (ResourceNode *node : nodes) {
+            parentNode->addChild(node);
+            indexNode(node);
+        }
     endInsertRows();
-    auto index = createIndex(rowCount(parent) - 1, 0, node);
-    emit added(index);
-    return index;
+    emit added(parent, first, last);
+}
+
+void ResourceItemsModel::setRoot(ResourceNode *root)
+{
+    beginResetModel();
+        delete this->root;
+        this->root = root ? root : new ResourceNode();
+        pathIndex.clear();
+        unfetched.clear();
+        fetching.clear();
+        indexNode(this->root);
+    endResetModel();
+}
+
+void ResourceItemsModel::setDirectories(const QStringList &directories)
+{
+    // Only the type nodes are created here; their contents are read in fetchMore() or merge().
+
+    beginResetModel();
+    delete root;
+    root = new ResourceNode();
+    pathIndex.clear();
+    unfetched.clear();
+    fetching.clear();
+    QHash<QString, ResourceNode *> types;
+    for (const QString &directory : directories) {
+        const QString type = ::ResourceQualifiers(QFileInfo(directory).fileName()).getType();
+        ResourceNode *typeNode = types.value(type, nullptr);
+        if (!typeNode) {
+            typeNode = new ResourceNode(type, nullptr);
+            root->addChild(typeNode);
+            types.insert(type, typeNode);
+        }
+        unfetched[typeNode].append(directory);
+    }
+    endResetModel();
+}
+
+void ResourceItemsModel::merge(ResourceNode *root)
+{
+    // Takes ownership of the scanned tree and moves the contents of the types which are still not populated.
+    // The types which are being read in background are populated from the scanned tree as well.
+
+    QHash<QString, ResourceNode *> types;
+    for (auto it = unfetched.constBegin(); it != unfetched.constEnd(); ++it) {
+        types.insert(it.key()->getCaption(), it.key());
+    }
+    for (auto it = fetching.constBegin(); it != fetching.constEnd(); ++it) {
+        types.insert(it.key()->getCaption(), it.key());
+    }
+    for (int row = 0; row < root->childCount(); ++row) {
+        ResourceNode *scannedType = root->getChild(row);
+        ResourceNode *typeNode = types.value(scannedType->getCaption(), nullptr);
+        if (typeNode) {
+            if (fetching.contains(typeNode)) {
+                completeFetch(typeNode, {scannedType});
+            } else {
+                unfetched.remove(typeNode);
+                populate(createIndex(typeNode->row(), 0, typeNode), scannedType);
+            }
+        }
+    }
+    delete root;
+}
+
+void ResourceItemsModel::addFiles(const QStringList &paths)
+{
+    // Adds the files which appeared on disk; files of the types which are not populated yet are skipped.
+
+    QHash<ResourceNode *, QList<ResourceNode *>> added;
+    QHash<ResourceNode *, QHash<QString, ResourceNode *>> groups;
+    for (const QString &path : paths) {
+        if (pathIndex.contains(path)) {
+            continue;
+        }
+        const QFileInfo fileInfo(path);
+        const ::ResourceQualifiers qualifiers(fileInfo.dir().dirName());
+        const QString type = qualifiers.getType();
+        ResourceNode *typeNode = nullptr;
+        for (int row = 0; row < root->childCount(); ++row) {
+            if (root->getChild(row)->getCaption() == type) {
+                typeNode = root->getChild(row);
+                break;
+            }
+        }
+        if (!typeNode) {
+            addNode(new ResourceNode(type, nullptr));
+            typeNode = root->getChild(root->childCount() - 1);
+        }
+        if (unfetched.contains(typeNode)) {
+            continue;
+        }
+        if (fetching.contains(typeNode)) {
+            fetching[typeNode].changed.append(path);
+            continue;
+        }
+        if (!groups.contains(typeNode)) {
+            QHash<QString, ResourceNode *> &captions = groups[typeNode];
+            for (int row = 0; row < typeNode->childCount(); ++row) {
+                captions.insert(typeNode->getChild(row)->getCaption(), typeNode->getChild(row));
+            }
+        }
+        const QString filename = fileInfo.fileName();
+        ResourceNode *groupNode = groups[typeNode].value(filename, nullptr);
+        if (!groupNode) {
+            groupNode = new ResourceNode(filename, nullptr);
+            addNode(groupNode, nodeIndex(typeNode));
+            groups[typeNode].insert(filename, groupNode);
+        }
+        added[groupNode].append(new ResourceNode(filename, new ResourceFile(path, qualifiers)));
+    }
+    for (auto it = added.constBegin(); it != added.constEnd(); ++it) {
+        addNodes(it.value(), nodeIndex(it.key()));
+    }
+}
+
+void ResourceItemsModel::dropFiles(const QStringList &paths)
+{
+    // Removes the nodes of the files which disappeared from disk (the files themselves are not touched).
+
+    QHash<ResourceNode *, QList<int>> rows;
+    for (const QString &path : paths) {
+        ResourceNode *node = pathIndex.value(path, nullptr);
+        if (node) {
+            rows[node->getParent()].append(node->row());
+        } else if (!fetching.isEmpty()) {
+            ResourceNode *typeNode = findFetchingType(path);
+            if (typeNode) {
+                fetching[typeNode].changed.append(path);
+            }
+        }
+    }
+    QHash<ResourceNode *, QList<int>> emptyGroups;
+    for (auto it = rows.constBegin(); it != rows.constEnd(); ++it) {
+        ResourceNode *group = it.key();
+        detachNodes(group, it.value());
+        if (group != root && !group->getFile() && !group->childCount() && group->getParent() != root) {
+            emptyGroups[group->getParent()].append(group->row());
+        }
+    }
+    for (auto it = emptyGroups.constBegin(); it != emptyGroups.constEnd(); ++it) {
+        detachNodes(it.key(), it.value());
+    }
+}
+
+void ResourceItemsModel::refreshFiles(const QStringList &paths)
+{
+    // Notifications are coalesced into a single row range per parent node.
+
+    QHash<ResourceNode *, QPair<int, int>> ranges;
+    for (const QString &path : paths) {
+        ResourceNode *node = pathIndex.value(path, nullptr);
+        if (node) {
+            const int row = node->row();
+            auto it = ranges.find(node->getParent());
+            if (it == ranges.end()) {
+                ranges.insert(node->getParent(), qMakePair(row, row));
+            } else {
+                it->first = qMin(it->first, row);
+                it->second = qMax(it->second, row);
+            }
+        }
+    }
+    for (auto it = ranges.constBegin(); it != ranges.constEnd(); ++it) {
+        ResourceNode *parent = it.key();
+        emit dataChanged(createIndex(it->first, 0, parent->getChild(it->first)),
+                         createIndex(it->second, ColumnCount - 1, parent->getChild(it->second)));
+    }
 }
 
 bool ResourceItemsModel::replaceResource(const QModelIndex &index, const QString &with)
@@ -176,7 +377,13 @@ bool ResourceItemsModel::removeRows(int row, int count, const QModelIndex &paren
     auto node = parent.isValid() ? static_cast<ResourceNode *>(parent.internalPointer()) : root;
     beginRemoveRows(parent, row, row + count - 1);
     for (int i = row; i < row + count; ++i) {
-        if (!node->removeChild(row)) {
+        auto child = node->getChild(row);
+        unindexNode(child);
+        if (node->removeChild(row)) {
+            unfetched.remove(child);
+            fetching.remove(child);
+        } else {
+            indexNode(child);
             success = false;
         }
     }
@@ -184,24 +391,52 @@ bool ResourceItemsModel::removeRows(int row, int count, const QModelIndex &paren
     return success;
 }
 
-QModelIndex ResourceItemsModel::findIndex(const QString &path) const
+bool ResourceItemsModel::hasChildren(const QModelIndex &parent) const
 {
-    return findIndex(path, {});
+    ResourceNode *parentItem = parent.isValid() ? static_cast<ResourceNode *>(parent.internalPointer()) : root;
+    return unfetched.contains(parentItem) || QAbstractItemModel::hasChildren(parent);
 }
 
-QModelIndex ResourceItemsModel::findIndex(const QString &path, const QModelIndex &parent) const
+bool ResourceItemsModel::canFetchMore(const QModelIndex &parent) const
 {
-    for (int row = 0; row < rowCount(parent); ++row) {
-        auto resource = index(row, ResourcePath, parent);
-        if (resource.data().toString() == path) {
-            return resource;
-        }
-        resource = findIndex(path, resource);
-        if (resource.isValid()) {
-            return resource;
-        }
+    return parent.isValid() && unfetched.contains(static_cast<ResourceNode *>(parent.internalPointer()));
+}
+
+void ResourceItemsModel::fetchMore(const QModelIndex &parent)
+{
+    // The directories are read in background, a placeholder is shown in the meantime. The read result is discarded
+    // if the type is populated from the background scanner first (see merge()) or removed.
+
+    if (!canFetchMore(parent)) {
+        return;
     }
-    return {};
+    ResourceNode *typeNode = static_cast<ResourceNode *>(parent.internalPointer());
+    const QStringList directories = unfetched.take(typeNode);
+    addNode(new ResourceNode(tr("Loading..."), nullptr), parent.sibling(parent.row(), 0));
+
+    auto watcher = new QFutureWatcher<ResourceNode *>(this);
+    fetching.insert(typeNode, {watcher, QStringList()});
+    connect(watcher, &QFutureWatcher<ResourceNode *>::finished, this, [=]() {
+        ResourceNode *scanned = watcher->result();
+        auto it = fetching.constFind(typeNode);
+        if (it != fetching.constEnd() && it->watcher == watcher) {
+            QVector<ResourceNode *> scannedTypes;
+            for (int row = 0; row < scanned->childCount(); ++row) {
+                scannedTypes.append(scanned->getChild(row));
+            }
+            completeFetch(typeNode, scannedTypes);
+        }
+        delete scanned;
+        watcher->setParent(nullptr);
+        watcher->deleteLater();
+    });
+    watcher->setFuture(QtConcurrent::run(&ResourceScanner::read, directories));
+}
+
+QModelIndex ResourceItemsModel::findIndex(const QString &path) const
+{
+    ResourceNode *node = pathIndex.value(path, nullptr);
+    return node ? createIndex(node->row(), ResourcePath, node) : QModelIndex();
 }
 
 const ResourceFile *ResourceItemsModel::getResource(const QModelIndex &index) const
@@ -218,3 +453,98 @@ const Project *ResourceItemsModel::getApk() const
 {
     return apk;
 }
+
+void ResourceItemsModel::indexNode(ResourceNode *node)
+{
+    const ResourceFile *file = node->getFile();
+    if (file) {
+        pathIndex.insert(file->getFilePath(), node);
+    }
+    for (int row = 0; row < node->childCount(); ++row) {
+        indexNode(node->getChild(row));
+    }
+}
+
+void ResourceItemsModel::populate(const QModelIndex &parent, ResourceNode *scannedType)
+{
+    QList<ResourceNode *> groups;
+    for (TreeNode *group : scannedType->takeChildren()) {
+        groups.append(static_cast<ResourceNode *>(group));
+    }
+    addNodes(groups, parent);
+}
+
+void ResourceItemsModel::completeFetch(ResourceNode *typeNode, const QVector<ResourceNode *> &scannedTypes)
+{
+    // Replaces the placeholder with the scanned contents and applies the changes reported in the meantime:
+
+    const Fetch fetch = fetching.take(typeNode);
+    detachNodes(typeNode, {0});
+    const QModelIndex parent = nodeIndex(typeNode);
+    for (ResourceNode *scannedType : scannedTypes) {
+        populate(parent, scannedType);
+    }
+    QStringList added;
+    QStringList removed;
+    for (const QString &path : fetch.changed) {
+        if (QFileInfo::exists(path)) {
+            added.append(path);
+        } else {
+            removed.append(path);
+        }
+    }
+    dropFiles(removed);
+    addFiles(added);
+}
+
+ResourceNode *ResourceItemsModel::findFetchingType(const QString &path) const
+{
+    const QString type = ::ResourceQualifiers(QFileInfo(path).dir().dirName()).getType();
+    for (auto it = fetching.constBegin(); it != fetching.constEnd(); ++it) {
+        if (it.key()->getCaption() == type) {
+            return it.key();
+        }
+    }
+    return nullptr;
+}
+
+void ResourceItemsModel::detachNodes(ResourceNode *parent, QList<int> rows)
+{
+    // Removes contiguous row ranges, starting from the bottom to keep the remaining rows valid:
+
+    std::sort(rows.begin(), rows.end(), std::greater<int>());
+    const QModelIndex parentIndex = nodeIndex(parent);
+    int i = 0;
+    while (i < rows.count()) {
+        const int last = rows.at(i);
+        int first = last;
+        while (++i < rows.count() && rows.at(i) == first - 1) {
+            first = rows.at(i);
+        }
+        beginRemoveRows(parentIndex, first, last);
+            for (int row = last; row >= first; --row) {
+                ResourceNode *child = parent->getChild(row);
+                unindexNode(child);
+                unfetched.remove(child);
+                fetching.remove(child);
+                parent->TreeNode::removeChild(row);
+            }
+        endRemoveRows();
+    }
+}
+
+QModelIndex ResourceItemsModel::nodeIndex(ResourceNode *node) const
+{
+    return node != root ? createIndex(node->row(), 0, node) : QModelIndex();
+}
+
+void ResourceItemsModel::unindexNode(ResourceNode *node)
+{
+    const ResourceFile *file = node->getFile();
+    if (file) {
+        pathIndex.remove(file->getFilePath());
+    }
+    for (int row = 0; row < node->childCount(); ++row) {
+        unindexNode(node->getChild(row));
+    }
+}
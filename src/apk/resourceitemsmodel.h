@@ -4,6 +4,7 @@
 #include "apk/iresourceitemsmodel.h"
 #include "apk/resourcenode.h"
 #include <QAbstractItemModel>
+#include <QFutureWatcher>
 
 class Project;
 
@@ -34,6 +35,13 @@ public:
     ~ResourceItemsModel() override;
 
     QModelIndex addNode(ResourceNode *node, const QModelIndex &parent = QModelIndex());
+    void addNodes(const QList<ResourceNode *> &nodes, const QModelIndex &parent = QModelIndex());
+    void setRoot(ResourceNode *root);
+    void setDirectories(const QStringList &directories);
+    void merge(ResourceNode *root);
+    void addFiles(const QStringList &paths);
+    void dropFiles(const QStringList &paths);
+    void refreshFiles(const QStringList &paths);
     bool replaceResource(const QModelIndex &index, const QString &file = QString()) override;
     bool removeResource(const QModelIndex &index) override;
 
@@ -44,18 +52,37 @@ public:
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     int columnCount(const QModelIndex &parent = QModelIndex()) const override;
     bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
 
     QModelIndex findIndex(const QString &path) const;
-    QModelIndex findIndex(const QString &path, const QModelIndex &parent) const;
     const ResourceFile *getResource(const QModelIndex &index) const;
     const Project *getApk() const;
 
 signals:
-    void added(const QModelIndex &index);
+    void added(const QModelIndex &parent, int first, int last);
 
 private:
+    struct Fetch
+    {
+        QFutureWatcher<ResourceNode *> *watcher;
+        QStringList changed; // Files added or removed while the type is being read
+    };
+
+    void indexNode(ResourceNode *node);
+    void unindexNode(ResourceNode *node);
+    void populate(const QModelIndex &parent, ResourceNode *scannedType);
+    void completeFetch(ResourceNode *typeNode, const QVector<ResourceNode *> &scannedTypes);
+    ResourceNode *findFetchingType(const QString &path) const;
+    void detachNodes(ResourceNode *parent, QList<int> rows);
+    QModelIndex nodeIndex(ResourceNode *node) const;
+
     const Project *apk;
     ResourceNode *root;
+    QHash<QString, ResourceNode *> pathIndex;
+    QHash<ResourceNode *, QStringList> unfetched; // Type nodes which are not populated yet
+    QHash<ResourceNode *, Fetch> fetching; // Type nodes which are being populated in background
 };
 
 #endif // RESOURCEITEMSMODEL_H
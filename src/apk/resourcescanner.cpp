@@ -0,0 +1,96 @@
+#include "apk/resourcescanner.h"
+#include <QDirIterator>
+#include <QtConcurrent/QtConcurrent>
+
+ResourceScanner::ResourceScanner(QObject *parent) : QObject(parent)
+{
+    delivered = false;
+
+    connect(&watcher, &QFutureWatcher<Tree>::progressValueChanged, [=](int value) {
+        emit progress(value, watcher.progressMaximum());
+    });
+
+    connect(&watcher, &QFutureWatcher<Tree>::finished, [=]() {
+        // The tree ownership is transferred to the receiver:
+        delivered = true;
+        emit finished(watcher.result().root);
+    });
+}
+
+ResourceScanner::~ResourceScanner()
+{
+    watcher.cancel();
+    watcher.waitForFinished();
+    if (!delivered && watcher.future().resultCount()) {
+        delete watcher.result().root;
+    }
+}
+
+void ResourceScanner::scan(const QStringList &directories)
+{
+    // Files inside of the resource directories are parsed across the global thread pool.
+    delivered = false;
+    watcher.setFuture(QtConcurrent::mappedReduced(directories, &ResourceScanner::scanDirectory, &ResourceScanner::mergeDirectory));
+}
+
+QStringList ResourceScanner::listDirectories(const QString &path)
+{
+    QStringList directories;
+    QDirIterator it(path, QDir::Dirs | QDir::NoDotAndDotDot);
+    while (it.hasNext()) {
+        directories.append(it.next());
+    }
+    return directories;
+}
+
+ResourceNode *ResourceScanner::read(const QStringList &directories)
+{
+    // Synchronous counterpart of scan(), used to populate a small subset of directories on demand.
+    Tree tree;
+    for (const QString &directory : directories) {
+        mergeDirectory(tree, scanDirectory(directory));
+    }
+    return tree.root ? tree.root : new ResourceNode();
+}
+
+ResourceScanner::Directory ResourceScanner::scanDirectory(const QString &path)
+{
+    // Qualifiers are parsed once per directory and shared by all of its files:
+    const ResourceQualifiers qualifiers(QFileInfo(path).fileName());
+
+    Directory directory;
+    directory.type = qualifiers.getType(); // E.g., "drawable", "values"...
+    QDirIterator it(path, QDir::Files);
+    while (it.hasNext()) {
+        directory.files.append(new ResourceFile(it.next(), qualifiers));
+    }
+    return directory;
+}
+
+void ResourceScanner::mergeDirectory(Tree &tree, const Directory &directory)
+{
+    // Reduce calls are serialized by QtConcurrent, so the tree is never accessed concurrently.
+
+    if (!tree.root) {
+        tree.root = new ResourceNode();
+    }
+
+    ResourceNode *typeNode = tree.types.value(directory.type, nullptr);
+    if (!typeNode) {
+        typeNode = new ResourceNode(directory.type, nullptr);
+        tree.root->addChild(typeNode);
+        tree.types.insert(directory.type, typeNode);
+    }
+
+    for (ResourceFile *file : directory.files) {
+        const QString filename = file->getFileName();
+        const QString groupKey = QString("%1/%2").arg(directory.type, filename);
+        ResourceNode *groupNode = tree.groups.value(groupKey, nullptr);
+        if (!groupNode) {
+            groupNode = new ResourceNode(filename, nullptr);
+            typeNode->addChild(groupNode);
+            tree.groups.insert(groupKey, groupNode);
+        }
+        groupNode->addChild(new ResourceNode(filename, file));
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef RESOURCESCANNER_H
+#define RESOURCESCANNER_H
+
+#include "apk/resourcenode.h"
+#include <QFutureWatcher>
+#include <QHash>
+
+class ResourceScanner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ResourceScanner(QObject *parent = nullptr);
+    ~ResourceScanner() override;
+
+    void scan(const QStringList &directories);
+
+    static QStringList listDirectories(const QString &path);
+    static ResourceNode *read(const QStringList &directories);
+
+signals:
+    void progress(int value, int total) const;
+    void finished(ResourceNode *root) const;
+
+private:
+    struct Directory
+    {
+        QString type;
+        QVector<ResourceFile *> files;
+    };
+
+    struct Tree
+    {
+        Tree() : root(nullptr) {}
+        ResourceNode *root;
+        QHash<QString, ResourceNode *> types;
+        QHash<QString, ResourceNode *> groups;
+    };
+
+    static Directory scanDirectory(const QString &path);
+    static void mergeDirectory(Tree &tree, const Directory &directory);
+
+    QFutureWatcher<Tree> watcher;
+    bool delivered;
+};
+
+#endif // RESOURCESCANNER_H
@@ -7,6 +7,8 @@ XmlNode::XmlNode(const QDomElement &node, bool keepDocument)
         document = node.ownerDocument();
     }
     modified = false;
+    parent = nullptr;
+    position = 0;
 }
 
 XmlNode::~XmlNode()
@@ -89,6 +91,7 @@ void XmlNode::setValue(const QString &value)
 void XmlNode::addChild(XmlNode *child)
 {
     child->parent = this;
+    child->position = children.count();
     children.append(child);
 }
 
@@ -109,5 +112,5 @@ int XmlNode::childCount() const
 
 int XmlNode::row() const
 {
-    return parent ? 0 : children.indexOf(const_cast<XmlNode *>(this));
+    return parent ? position : 0;
 }
@@ -38,6 +38,7 @@ private:
 
     QList<XmlNode *> children;
     XmlNode *parent;
+    int position;
 };
 
 #endif // XMLNODE_H
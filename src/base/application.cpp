@@ -1,4 +1,5 @@
 #include "base/application.h"
+#include "base/batchrunner.h"
 #include "tools/apktool.h"
 #include "windows/devicemanager.h"
 #include "windows/dialogs.h"
@@ -8,6 +9,7 @@
 #include <QPixmapCache>
 #include <QPainter>
 #include <QScreen>
+#include <QTimer>
 #include <QDebug>
 
 Application::Application(int &argc, char **argv) : QtSingleApplication(argc, argv)
@@ -69,6 +71,19 @@ int Application::exec()
 
     setLanguage(settings->getLanguage());
 
+    // Scripted jobs are processed without the main window:
+
+    if (arguments().contains("--batch")) {
+        window = nullptr;
+        BatchRunner batch;
+        if (!batch.parse(arguments())) {
+            return 2;
+        }
+        connect(&batch, &BatchRunner::finished, this, &QApplication::exit);
+        QTimer::singleShot(0, &batch, &BatchRunner::start);
+        return QApplication::exec();
+    }
+
     MainWindow mainwindow;
     mainwindow.show();
     window = &mainwindow;
@@ -275,7 +290,7 @@ QString Application::getUpdateUrl()
     return getWebPage() + "/versions.json";
 }
 
-Project *Application::openApk(const QString &filename, bool unpack)
+Project *Application::openApk(const QString &filename, bool unpack, Project::DecodeProfile profile)
 {
     Project *existing = projects.existing(filename);
     if (existing) {
@@ -288,7 +303,7 @@ Project *Application::openApk(const QString &filename, bool unpack)
         projects.close(existing);
     }
 
-    Project *project = projects.open(filename, unpack);
+    Project *project = projects.open(filename, unpack, profile);
     connect(project, &Project::unpacked, [=]() {
         addToRecent(project);
     });
@@ -309,13 +324,13 @@ bool Application::installExternalApk()
         return false;
     }
     DeviceManager devices(window);
-    const Device *device = devices.getTargetDevice();
-    if (!device) {
+    const QList<Device> targets = devices.getTargetDevices();
+    if (targets.isEmpty()) {
         return false;
     }
     for (const QString &path : paths) {
         Project *project = openApk(path, false);
-        project->install(device->getSerial());
+        project->install(targets);
     }
     return true;
 }
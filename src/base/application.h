@@ -5,8 +5,11 @@
 #include "base/iconprovider.h"
 #include "base/language.h"
 #include "base/recent.h"
+#include "base/scheduler.h"
 #include "base/settings.h"
+#include "base/thumbnailprovider.h"
 #include "base/updater.h"
+#include "tools/apktooldaemon.h"
 #include "windows/mainwindow.h"
 #include <QtSingleApplication>
 #include <QTranslator>
@@ -61,7 +64,7 @@ public:
     static QString getJdkPage();
     static QString getUpdateUrl();
 
-    Project *openApk(const QString &filename, bool unpack = true);
+    Project *openApk(const QString &filename, bool unpack = true, Project::DecodeProfile profile = Project::getDefaultDecodeProfile());
     bool closeApk(Project *project);
     bool installExternalApk();
 
@@ -83,6 +86,9 @@ public:
     Settings *settings;
     Recent *recent;
     IconProvider icons;
+    ThumbnailProvider thumbnails;
+    Scheduler scheduler;
+    ApktoolDaemon apktoolDaemon;
     QTranslator translator;
     QTranslator translatorQt;
 
@@ -0,0 +1,304 @@
+#include "base/batchrunner.h"
+#include "apk/titleitemsmodel.h"
+#include "base/application.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTimer>
+#include <QDebug>
+#include <cstdio>
+
+BatchRunner::BatchRunner(QObject *parent) : QObject(parent)
+{
+    workers = 1;
+    running = 0;
+    succeeded = 0;
+    failed = 0;
+}
+
+bool BatchRunner::isRequested(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        if (!qstrcmp(argv[i], "--batch")) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BatchRunner::parse(const QStringList &arguments)
+{
+    // Usage: --batch <jobs.json> [--workers <count>] [--report <file>]
+    // The job list is a JSON array of objects. Relative paths are resolved against the directory of the job list:
+    //   [{"input": "app.apk", "output": "out/app.apk", "label": "Title", "versionCode": "+1",
+    //     "versionName": "2.0", "minSdk": 21, "targetSdk": 29, "icon": "icon.png", "profile": "resources",
+    //     "keystore": {"path": "release.jks", "password": "...", "alias": "...", "keyPassword": "..."}}]
+
+    QString jobsPath;
+    workers = app->scheduler.getSlotCount();
+    for (int i = 1; i < arguments.size(); ++i) {
+        const QString argument = arguments.at(i);
+        if (argument == "--batch" && i + 1 < arguments.size()) {
+            jobsPath = arguments.at(++i);
+        } else if (argument == "--workers" && i + 1 < arguments.size()) {
+            workers = arguments.at(++i).toInt();
+        } else if (argument == "--report" && i + 1 < arguments.size()) {
+            reportPath = arguments.at(++i);
+        } else {
+            qWarning() << qPrintable(QString("Unexpected argument: %1").arg(argument));
+            return false;
+        }
+    }
+    if (jobsPath.isEmpty() || workers < 1) {
+        qWarning() << "Usage: --batch <jobs.json> [--workers <count>] [--report <file>]";
+        return false;
+    }
+
+    QFile file(jobsPath);
+    if (!file.open(QFile::ReadOnly)) {
+        qWarning() << qPrintable(QString("Could not open the job list: %1").arg(jobsPath));
+        return false;
+    }
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (!document.isArray()) {
+        qWarning() << qPrintable(QString("Invalid job list: %1").arg(parseError.error != QJsonParseError::NoError
+            ? parseError.errorString()
+            : QString("expected an array of jobs")));
+        return false;
+    }
+
+    const QDir directory = QFileInfo(jobsPath).absoluteDir();
+    const QJsonArray jobs = document.array();
+    for (int i = 0; i < jobs.size(); ++i) {
+        QJsonObject options = jobs.at(i).toObject();
+        if (options.value("input").toString().isEmpty() || options.value("output").toString().isEmpty()) {
+            qWarning() << qPrintable(QString("Job %1: \"input\" and \"output\" are required.").arg(i));
+            qDeleteAll(pending);
+            pending.clear();
+            return false;
+        }
+        for (const QString &key : {"input", "output", "icon"}) {
+            if (!options.value(key).toString().isEmpty()) {
+                options.insert(key, directory.absoluteFilePath(options.value(key).toString()));
+            }
+        }
+        if (options.contains("keystore")) {
+            QJsonObject keystore = options.value("keystore").toObject();
+            if (!keystore.value("path").toString().isEmpty()) {
+                keystore.insert("path", directory.absoluteFilePath(keystore.value("path").toString()));
+                options.insert("keystore", keystore);
+            }
+        }
+        auto job = new Job;
+        job->id = i;
+        job->options = options;
+        job->input = options.value("input").toString();
+        job->output = options.value("output").toString();
+        job->unpackTime = 0;
+        job->editTime = 0;
+        job->saveTime = 0;
+        job->project = nullptr;
+        pending.enqueue(job);
+    }
+    return true;
+}
+
+void BatchRunner::start()
+{
+    // Reports are written as JSON Lines: one line per job, as soon as it's finished, followed by the summary line.
+
+    if (!reportPath.isEmpty()) {
+        output.setFileName(reportPath);
+        if (!output.open(QFile::WriteOnly | QFile::Truncate | QFile::Text)) {
+            qWarning() << qPrintable(QString("Could not open the report file: %1").arg(reportPath));
+            emit finished(2);
+            return;
+        }
+    } else {
+        output.open(stdout, QFile::WriteOnly);
+    }
+    timer.start();
+    dispatch();
+}
+
+void BatchRunner::dispatch()
+{
+    // Jobs beyond the worker limit wait here, while the tools of the running jobs are additionally limited by the scheduler.
+
+    while (running < workers && !pending.isEmpty()) {
+        run(pending.dequeue());
+    }
+    if (!running && pending.isEmpty()) {
+        QJsonObject summary;
+        summary.insert("summary", true);
+        summary.insert("succeeded", succeeded);
+        summary.insert("failed", failed);
+        summary.insert("total_ms", static_cast<double>(timer.elapsed()));
+        report(summary);
+        emit finished(failed ? 1 : 0);
+    }
+}
+
+void BatchRunner::run(Job *job)
+{
+    ++running;
+    job->timer.start();
+
+    const QJsonObject &options = job->options;
+    const QString profile = options.value("profile").toString();
+    const Project::DecodeProfile decodeProfile = profile == "manifest" ? Project::DecodeManifest
+                                               : profile == "full" ? Project::DecodeFull
+                                               : profile == "resources" ? Project::DecodeResources
+                                               : Project::getDefaultDecodeProfile();
+
+    // The keystore is never asked for interactively:
+
+    const bool sign = app->settings->getSignApk();
+    const bool isCustomKeystore = options.contains("keystore") || app->settings->getCustomKeystore();
+    Keystore keystore;
+    if (options.contains("keystore")) {
+        const QJsonObject object = options.value("keystore").toObject();
+        keystore.keystorePath = object.value("path").toString();
+        keystore.keystorePassword = object.value("password").toString();
+        keystore.keyAlias = object.value("alias").toString();
+        keystore.keyPassword = object.value("keyPassword").toString();
+    } else if (isCustomKeystore) {
+        keystore.keystorePath = app->settings->getKeystorePath();
+        keystore.keystorePassword = app->settings->getKeystorePassword();
+        keystore.keyAlias = app->settings->getKeyAlias();
+        keystore.keyPassword = app->settings->getKeyPassword();
+    }
+    const bool isKeystoreIncomplete = keystore.keystorePath.isEmpty() || keystore.keystorePassword.isEmpty()
+        || keystore.keyAlias.isEmpty() || keystore.keyPassword.isEmpty();
+    if (sign && isCustomKeystore && isKeystoreIncomplete) {
+        job->error = "The keystore is not fully configured.";
+        QTimer::singleShot(0, this, [=]() {
+            finish(job, false);
+        });
+        return;
+    }
+
+    QDir().mkpath(QFileInfo(job->output).absolutePath());
+
+    Project *project = new Project(job->input);
+    job->project = project;
+    if (sign && isCustomKeystore) {
+        project->setKeystore(keystore);
+    }
+
+    // The last error written to the project log is included in the report:
+    connect(&project->logModel, &LogModel::added, this, [=](LogEntry *entry) {
+        if (entry->getType() == LogEntry::Error) {
+            const QString details = entry->getDescriptive().trimmed();
+            job->error = details.isEmpty() ? entry->getBrief() : QString("%1 %2").arg(entry->getBrief(), details);
+        }
+    });
+
+    // Queued, so that the project finishes its own handling of the stage first:
+
+    connect(project, &Project::unpacked, this, [=](bool success) {
+        job->unpackTime = job->timer.elapsed();
+        if (!success || !edit(job)) {
+            finish(job, false);
+            return;
+        }
+        job->editTime = job->timer.elapsed() - job->unpackTime;
+        project->save(job->output);
+    }, Qt::QueuedConnection);
+
+    connect(project, &Project::packed, this, [=](bool success) {
+        job->saveTime = job->timer.elapsed() - job->unpackTime - job->editTime;
+        finish(job, success);
+    }, Qt::QueuedConnection);
+
+    project->unpack(decodeProfile);
+}
+
+bool BatchRunner::edit(Job *job)
+{
+    // Edits are made through the same models as in the user interface.
+
+    Project *project = job->project;
+    ManifestModel &manifest = project->manifestModel;
+    const QJsonObject &options = job->options;
+
+    if (options.contains("label")) {
+        const QString label = options.value("label").toString();
+        TitleItemsModel titles(project);
+        if (titles.rowCount() > 0) {
+            for (int row = 0; row < titles.rowCount(); ++row) {
+                titles.setData(titles.index(row, TitleItemsModel::Value), label);
+            }
+            titles.save();
+        } else {
+            manifest.setApplicationLabel(label);
+        }
+    }
+    if (options.contains("versionCode")) {
+        // A string starting with "+" increments the current version code:
+        const QJsonValue value = options.value("versionCode");
+        const QString string = value.toString();
+        if (value.isString() && string.startsWith('+')) {
+            manifest.setVersionCode(manifest.getVersionCode() + string.mid(1).toInt());
+        } else {
+            manifest.setVersionCode(value.isString() ? string.toInt() : value.toInt());
+        }
+    }
+    if (options.contains("versionName")) {
+        manifest.setVersionName(options.value("versionName").toString());
+    }
+    if (options.contains("minSdk")) {
+        manifest.setMinimumSdk(options.value("minSdk").toInt());
+    }
+    if (options.contains("targetSdk")) {
+        manifest.setTargetSdk(options.value("targetSdk").toInt());
+    }
+    if (options.contains("icon")) {
+        const QString icon = options.value("icon").toString();
+        if (!QFile::exists(icon) || !project->iconsProxy.replaceApplicationIcons(icon)) {
+            job->error = QString("Could not replace the application icons with \"%1\".").arg(icon);
+            return false;
+        }
+    }
+    return true;
+}
+
+void BatchRunner::finish(Job *job, bool success)
+{
+    // Timings are in milliseconds. The unpacking includes the reading of the resources.
+
+    QJsonObject timings;
+    timings.insert("unpack", static_cast<double>(job->unpackTime));
+    timings.insert("edit", static_cast<double>(job->editTime));
+    timings.insert("save", static_cast<double>(job->saveTime));
+    timings.insert("total", static_cast<double>(job->timer.elapsed()));
+
+    QJsonObject line;
+    line.insert("job", job->id);
+    line.insert("input", job->input);
+    line.insert("output", job->output);
+    line.insert("status", success ? "ok" : "error");
+    if (!success) {
+        line.insert("error", job->error);
+    }
+    line.insert("timings_ms", timings);
+    report(line);
+
+    if (success) {
+        ++succeeded;
+    } else {
+        ++failed;
+    }
+    if (job->project) {
+        job->project->deleteLater();
+    }
+    delete job;
+    --running;
+    dispatch();
+}
+
+void BatchRunner::report(const QJsonObject &line)
+{
+    output.write(QJsonDocument(line).toJson(QJsonDocument::Compact) + '\n');
+    output.flush();
+}
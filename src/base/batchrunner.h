@@ -0,0 +1,56 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include "apk/project.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonObject>
+#include <QQueue>
+
+class BatchRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BatchRunner(QObject *parent = nullptr);
+
+    static bool isRequested(int argc, char *argv[]);
+
+    bool parse(const QStringList &arguments);
+    void start();
+
+signals:
+    void finished(int exitCode) const;
+
+private:
+    struct Job
+    {
+        int id;
+        QJsonObject options;
+        QString input;
+        QString output;
+        QString error;
+        QElapsedTimer timer;
+        qint64 unpackTime;
+        qint64 editTime;
+        qint64 saveTime;
+        Project *project;
+    };
+
+    void dispatch();
+    void run(Job *job);
+    bool edit(Job *job);
+    void finish(Job *job, bool success);
+    void report(const QJsonObject &line);
+
+    QQueue<Job *> pending;
+    QElapsedTimer timer;
+    QString reportPath;
+    QFile output;
+    int workers;
+    int running;
+    int succeeded;
+    int failed;
+};
+
+#endif // BATCHRUNNER_H
@@ -13,6 +13,7 @@ const Device *DeviceItemsModel::get(const QModelIndex &index) const
 void DeviceItemsModel::refresh()
 {
     Adb adb(app->settings->getAdbPath());
+    adb.setTimeout(app->settings->getTaskTimeout("Devices"));
     if (!devices.isEmpty()) {
         beginRemoveRows(QModelIndex(), 0, rowCount() - 1);
             devices.clear();
@@ -1,9 +1,16 @@
 #include "base/application.h"
+#include "base/batchrunner.h"
 
 int main(int argc, char *argv[])
 {
+    // The batch mode doesn't create any windows, so it's able to run without a display:
+    const bool batch = BatchRunner::isRequested(argc, argv);
+    if (batch && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
     Application application(argc, argv);
-    if (application.isRunning()) {
+    if (!batch && application.isRunning()) {
         QStringList args = application.arguments();
         args.removeFirst();
         if (application.sendMessage(args.join('\n'))) {
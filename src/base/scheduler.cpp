@@ -0,0 +1,141 @@
+#include "base/scheduler.h"
+#include "base/application.h"
+#include <QThread>
+#include <algorithm>
+
+#if defined(Q_OS_WIN)
+    #include <windows.h>
+#elif defined(Q_OS_LINUX)
+    #include <unistd.h>
+#endif
+
+namespace
+{
+    const quint64 memoryPerSlot = 768ull * 1024 * 1024; // Rough footprint of a single apktool JVM
+}
+
+Scheduler::Scheduler(QObject *parent) : QObject(parent)
+{
+    foreground = nullptr;
+    running = 0;
+    defaultSlotCount = getDefaultSlotCount(); // Calculated once, before any of the tools are running
+}
+
+void Scheduler::enqueue(Tasks::Task *task, const std::function<void()> &start, const QString &device)
+{
+    queue.append({task, start, device});
+    sortQueue();
+    dispatch();
+}
+
+bool Scheduler::cancel(Tasks::Task *task)
+{
+    // Removes the waiting task from the queue. Returns false if the task is not queued (e.g., already running).
+
+    for (int i = 0; i < queue.count(); ++i) {
+        if (queue.at(i).task == task) {
+            queue.removeAt(i);
+            dispatch();
+            return true;
+        }
+    }
+    return false;
+}
+
+void Scheduler::setForeground(const QObject *owner)
+{
+    foreground = owner;
+    sortQueue();
+    dispatch();
+}
+
+int Scheduler::getSlotCount() const
+{
+    const int slotCount = app->settings->getTaskSlots();
+    return slotCount > 0 ? slotCount : defaultSlotCount;
+}
+
+int Scheduler::getDefaultSlotCount()
+{
+    // Limited by the number of CPU cores and by the amount of available physical memory:
+
+    int slotCount = qMax(1, QThread::idealThreadCount());
+    quint64 available = 0;
+#if defined(Q_OS_WIN)
+    MEMORYSTATUSEX status;
+    status.dwLength = sizeof(status);
+    if (GlobalMemoryStatusEx(&status)) {
+        available = status.ullAvailPhys;
+    }
+#elif defined(Q_OS_LINUX)
+    const long pages = sysconf(_SC_AVPHYS_PAGES);
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    if (pages > 0 && pageSize > 0) {
+        available = static_cast<quint64>(pages) * static_cast<quint64>(pageSize);
+    }
+#endif
+    if (available) {
+        slotCount = qMin(slotCount, static_cast<int>(qMax<quint64>(1, available / memoryPerSlot)));
+    }
+    return slotCount;
+}
+
+void Scheduler::dispatch()
+{
+    // Device tasks mostly wait for the device, so they don't take the tool slots.
+    // Instead, they are limited per device, and tasks for different devices run in parallel.
+
+    const int slotCount = getSlotCount();
+    const int deviceSlotCount = qMax(1, app->settings->getDeviceSlots());
+    int index = 0;
+    while (index < queue.count()) {
+        const Entry entry = queue.at(index);
+        if (!entry.task) {
+            queue.removeAt(index);
+            continue;
+        }
+        const bool isDeviceTask = !entry.device.isEmpty();
+        const bool isSlotFree = isDeviceTask ? runningDevices.value(entry.device) < deviceSlotCount : running < slotCount;
+        if (!isSlotFree) {
+            ++index;
+            continue;
+        }
+        queue.removeAt(index);
+        if (isDeviceTask) {
+            ++runningDevices[entry.device];
+        } else {
+            ++running;
+        }
+        connect(entry.task, &Tasks::Task::finished, this, [=]() {
+            if (isDeviceTask) {
+                if (--runningDevices[entry.device] <= 0) {
+                    runningDevices.remove(entry.device);
+                }
+            } else {
+                --running;
+            }
+            dispatch();
+        });
+        emit entry.task->queued(0);
+        entry.start();
+        index = 0; // The task may have finished synchronously and changed the queue
+    }
+
+    // Report the queue positions (starting from one) to the waiting tasks:
+
+    for (int i = 0; i < queue.count(); ++i) {
+        if (queue.at(i).task) {
+            emit queue.at(i).task->queued(i + 1);
+        }
+    }
+}
+
+void Scheduler::sortQueue()
+{
+    // Tasks of the foreground project go first; the order is kept otherwise:
+    std::stable_sort(queue.begin(), queue.end(), [this](const Entry &a, const Entry &b) {
+        const bool isForegroundA = a.task && a.task->getOwner() == foreground;
+        const bool isForegroundB = b.task && b.task->getOwner() == foreground;
+        return isForegroundA && !isForegroundB;
+    });
+}
@@ -0,0 +1,41 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "base/tasks.h"
+#include <QHash>
+#include <QPointer>
+#include <functional>
+
+class Scheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Scheduler(QObject *parent = nullptr);
+
+    void enqueue(Tasks::Task *task, const std::function<void()> &start, const QString &device = QString());
+    bool cancel(Tasks::Task *task);
+    void setForeground(const QObject *owner);
+
+    int getSlotCount() const;
+    static int getDefaultSlotCount();
+
+private:
+    struct Entry
+    {
+        QPointer<Tasks::Task> task;
+        std::function<void()> start;
+        QString device; // Serial number of the device the task runs on, if any
+    };
+
+    void dispatch();
+    void sortQueue();
+
+    QList<Entry> queue;
+    const QObject *foreground;
+    QHash<QString, int> runningDevices;
+    int running;
+    int defaultSlotCount;
+};
+
+#endif // SCHEDULER_H
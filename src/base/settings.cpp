@@ -74,6 +74,13 @@ bool Settings::getOptimizeApk()
     return settings->value("Zipalign/Enabled", true).toBool();
 }
 
+bool Settings::getSinglePassOutput()
+{
+    // If both optimizing and signing are enabled, the APK is aligned and signed in a single write.
+    QMutexLocker locker(&mutex);
+    return settings->value("Zipalign/SinglePass", true).toBool();
+}
+
 QString Settings::getApksignerPath()
 {
     QMutexLocker locker(&mutex);
@@ -128,10 +135,32 @@ QString Settings::getApktoolVersion()
     return settings->value("Apktool/Version").toString();
 }
 
-bool Settings::getDecompileSources()
+QString Settings::getDecodeProfile()
 {
+    // One of "manifest", "resources" or "full". Defaults to the former "Decompile source code" option.
     QMutexLocker locker(&mutex);
-    return settings->value("Apktool/Sources", false).toBool();
+    const QString fallback = settings->value("Apktool/Sources", false).toBool() ? "full" : "resources";
+    return settings->value("Apktool/Profile", fallback).toString();
+}
+
+bool Settings::getIncrementalRepack()
+{
+    // If only the raw files have changed, they are patched into the original APK instead of the full rebuild.
+    QMutexLocker locker(&mutex);
+    return settings->value("Apktool/Incremental", true).toBool();
+}
+
+int Settings::getUnpackCacheSize()
+{
+    // In megabytes, zero disables the unpack cache.
+    QMutexLocker locker(&mutex);
+    return settings->value("Apktool/CacheSize", 2048).toInt();
+}
+
+QString Settings::getUnpackCacheDirectory()
+{
+    // Kept next to the unpacked projects, so that they can be cloned within the same filesystem.
+    return QString("%1/.cache").arg(getOutputDirectory());
 }
 
 QString Settings::getDeviceAlias(const QString &serial)
@@ -158,6 +187,29 @@ int Settings::getRecentLimit()
     return settings->value("Preferences/MaxRecent", 10).toInt();
 }
 
+int Settings::getTaskSlots()
+{
+    // Zero stands for the automatic number of slots.
+    QMutexLocker locker(&mutex);
+    return settings->value("Preferences/TaskSlots", 0).toInt();
+}
+
+int Settings::getDeviceSlots()
+{
+    // Number of tasks (e.g., installs) which may run on a single device at the same time.
+    QMutexLocker locker(&mutex);
+    return settings->value("Preferences/DeviceSlots", 1).toInt();
+}
+
+int Settings::getTaskTimeout(const QString &task)
+{
+    // In seconds, zero stands for no timeout. Only the device calls are limited by default,
+    // as the duration of the other tasks depends on the size of the APK.
+    QMutexLocker locker(&mutex);
+    const int defaultTimeout = (task == "Install") ? 300 : (task == "Devices") ? 30 : 0;
+    return settings->value(QString("Timeouts/%1").arg(task), defaultTimeout).toInt();
+}
+
 QString Settings::getLanguage()
 {
     QMutexLocker locker(&mutex);
@@ -220,6 +272,12 @@ void Settings::setOptimizeApk(bool sign)
     settings->setValue("Zipalign/Enabled", sign);
 }
 
+void Settings::setSinglePassOutput(bool enabled)
+{
+    QMutexLocker locker(&mutex);
+    settings->setValue("Zipalign/SinglePass", enabled);
+}
+
 void Settings::setApksignerPath(const QString &path)
 {
     QMutexLocker locker(&mutex);
@@ -274,10 +332,22 @@ void Settings::setApktoolVersion(const QString &version)
     settings->setValue("Apktool/Version", version);
 }
 
-void Settings::setDecompileSources(bool smali)
+void Settings::setDecodeProfile(const QString &profile)
+{
+    QMutexLocker locker(&mutex);
+    settings->setValue("Apktool/Profile", profile);
+}
+
+void Settings::setIncrementalRepack(bool enabled)
+{
+    QMutexLocker locker(&mutex);
+    settings->setValue("Apktool/Incremental", enabled);
+}
+
+void Settings::setUnpackCacheSize(int megabytes)
 {
     QMutexLocker locker(&mutex);
-    settings->setValue("Apktool/Sources", smali);
+    settings->setValue("Apktool/CacheSize", megabytes);
 }
 
 void Settings::setDeviceAlias(const QString &serial, const QString &alias)
@@ -304,6 +374,24 @@ void Settings::setRecentLimit(int limit)
     settings->setValue("Preferences/MaxRecent", limit);
 }
 
+void Settings::setTaskSlots(int count)
+{
+    QMutexLocker locker(&mutex);
+    settings->setValue("Preferences/TaskSlots", count);
+}
+
+void Settings::setDeviceSlots(int count)
+{
+    QMutexLocker locker(&mutex);
+    settings->setValue("Preferences/DeviceSlots", count);
+}
+
+void Settings::setTaskTimeout(const QString &task, int seconds)
+{
+    QMutexLocker locker(&mutex);
+    settings->setValue(QString("Timeouts/%1").arg(task), seconds);
+}
+
 void Settings::setLanguage(const QString &locale)
 {
     QMutexLocker locker(&mutex);
@@ -19,6 +19,7 @@ public:
     QString getFrameworksDirectory();
     bool getSignApk();
     bool getOptimizeApk();
+    bool getSinglePassOutput();
     QString getApksignerPath();
     QString getZipalignPath();
     QString getAdbPath();
@@ -28,11 +29,17 @@ public:
     QString getKeyAlias();
     QString getKeyPassword();
     QString getApktoolVersion();
-    bool getDecompileSources();
+    QString getDecodeProfile();
+    bool getIncrementalRepack();
+    int getUnpackCacheSize();
+    QString getUnpackCacheDirectory();
     QString getDeviceAlias(const QString &serial);
     QString getLastDirectory();
     bool getAutoUpdates();
     int getRecentLimit();
+    int getTaskSlots();
+    int getDeviceSlots();
+    int getTaskTimeout(const QString &task);
     QString getLanguage();
     QStringList getToolbar();
     QByteArray getMainWindowGeometry();
@@ -43,6 +50,7 @@ public:
     void setFrameworksDirectory(const QString &directory);
     void setSignApk(bool sign);
     void setOptimizeApk(bool sign);
+    void setSinglePassOutput(bool enabled);
     void setApksignerPath(const QString &path);
     void setZipalignPath(const QString &path);
     void setAdbPath(const QString &path);
@@ -52,11 +60,16 @@ public:
     void setKeyAlias(const QString &alias);
     void setKeyPassword(const QString &password);
     void setApktoolVersion(const QString &version);
-    void setDecompileSources(bool smali);
+    void setDecodeProfile(const QString &profile);
+    void setIncrementalRepack(bool enabled);
+    void setUnpackCacheSize(int megabytes);
     void setDeviceAlias(const QString &serial, const QString &alias);
     void setLastDirectory(const QString &directory);
     void setAutoUpdates(bool value);
     void setRecentLimit(int limit);
+    void setTaskSlots(int count);
+    void setDeviceSlots(int count);
+    void setTaskTimeout(const QString &task, int seconds);
     void setLanguage(const QString &locale);
     void setToolbar(const QStringList &actions);
     void setMainWindowGeometry(const QByteArray &geometry);
@@ -1,10 +1,16 @@
 #include "base/tasks.h"
 #include "base/application.h"
+#include "base/unpackcache.h"
 #include "tools/apktool.h"
 #include "tools/apksigner.h"
 #include "tools/zipalign.h"
 #include "tools/adb.h"
+#include "tools/apkpatcher.h"
+#include <QFutureWatcher>
+#include <QSharedPointer>
 #include <QThreadPool>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrent>
 
 using namespace Tasks;
 
@@ -12,9 +18,94 @@ using namespace Tasks;
 
 Task::Task()
 {
+    owner = nullptr;
+    elapsed = 0;
+    bytesWritten = 0;
+    timeout = 0;
+    isFinished = false;
+    connect(this, &Task::started, [=]() {
+        if (!timer.isValid()) {
+            timer.start();
+            if (timeout > 0) {
+                QTimer::singleShot(timeout * 1000, this, [=]() {
+                    cancel(QString("Timed out after %1 s.").arg(timeout));
+                });
+            }
+        }
+    });
+    connect(this, &Task::finished, [=]() {
+        isFinished = true;
+        elapsed = timer.isValid() ? timer.elapsed() : 0;
+    });
     connect(this, &Task::finished, this, &Task::deleteLater);
 }
 
+void Task::cancel(const QString &reason)
+{
+    // Cooperative cancellation: a queued task is removed from the scheduler, a running task stops its tool
+    // (connected to the "cancelling" signal). In both cases, the "error" and "finished" signals follow.
+
+    if (isFinished || !cancelReason.isNull()) {
+        return;
+    }
+    cancelReason = reason.isEmpty() ? QString("Cancelled.") : reason;
+    if (app->scheduler.cancel(this)) {
+        emit error(cancelReason);
+        emit finished();
+    } else {
+        emit cancelling(cancelReason);
+    }
+}
+
+void Task::setTimeout(int seconds)
+{
+    // The task is cancelled if it is not finished in the given time after its start. Zero stands for no timeout.
+    timeout = seconds;
+}
+
+void Task::setOwner(const QObject *owner)
+{
+    this->owner = owner;
+}
+
+const QObject *Task::getOwner() const
+{
+    return owner;
+}
+
+void Task::setTitle(const QString &title)
+{
+    this->title = title;
+}
+
+const QString &Task::getTitle() const
+{
+    return title;
+}
+
+qint64 Task::getElapsed() const
+{
+    // Time between the "started" and "finished" signals, in milliseconds.
+    return elapsed;
+}
+
+qint64 Task::getBytesWritten() const
+{
+    // Bytes written to disk by the task; -1 if they were not measured (e.g., written by an external tool).
+    return bytesWritten;
+}
+
+void Task::setBytesWritten(qint64 bytes)
+{
+    bytesWritten = bytes;
+}
+
+const QString &Task::getCancelReason() const
+{
+    // Null unless the task is cancelled.
+    return cancelReason;
+}
+
 // Unpack
 
 Unpack::Unpack(const QString &source, const QString &target, const QString &frameworks, bool resources, bool sources)
@@ -28,11 +119,80 @@ Unpack::Unpack(const QString &source, const QString &target, const QString &fram
 
 void Unpack::run()
 {
-    emit started();
+    // Tool processes are started once the scheduler provides a free slot:
+    app->scheduler.enqueue(this, [=]() {
+        emit started();
+        if (app->settings->getUnpackCacheSize() > 0 && !app->settings->getApktoolVersion().isEmpty()) {
+            restore();
+        } else {
+            decode(QString());
+        }
+    });
+}
+
+void Unpack::restore()
+{
+    // APKs which were already decoded with the same apktool version and options are cloned from the cache.
+
+    const UnpackCache cache(app->settings->getUnpackCacheDirectory(), static_cast<qint64>(app->settings->getUnpackCacheSize()) * 1024 * 1024);
+    const QString version = app->settings->getApktoolVersion();
+
+    auto watcher = new QFutureWatcher<Lookup>(this);
+    connect(watcher, &QFutureWatcher<Lookup>::finished, this, [=]() {
+        const Lookup lookup = watcher->result();
+        watcher->deleteLater();
+        if (!getCancelReason().isNull()) {
+            emit error(getCancelReason());
+            emit finished();
+        } else if (lookup.isRestored) {
+            emit output(QString("Restored from the unpack cache (%1).").arg(lookup.key));
+            emit success();
+            emit finished();
+        } else {
+            decode(lookup.key);
+        }
+    });
+    watcher->setFuture(QtConcurrent::run([=]() -> Lookup {
+        const QString key = UnpackCache::key(source, version, frameworks, resources, sources);
+        return {key, !key.isNull() && cache.restore(key, target)};
+    }));
+}
+
+void Unpack::decode(const QString &key)
+{
+    // The decoded contents are stored in the cache (if the key is given) in background, after the task has succeeded.
+    // Only their listing is taken beforehand: the stored copy is discarded if the user modifies the contents meanwhile.
+
     Apktool *apktool = new Apktool(app->settings->getApktoolPath(), this);
-    connect(apktool, &Executable::success, this, &Task::success);
-    connect(apktool, &Executable::error, this, &Task::error);
-    connect(apktool, &Executable::finished, this, &Task::finished);
+    connect(apktool, &Executable::success, this, [=]() {
+        if (key.isEmpty()) {
+            emit success();
+            emit finished();
+            return;
+        }
+        const UnpackCache cache(app->settings->getUnpackCacheDirectory(), static_cast<qint64>(app->settings->getUnpackCacheSize()) * 1024 * 1024);
+        const QString contents = target;
+        auto watcher = new QFutureWatcher<ContentsSnapshot>(this);
+        connect(watcher, &QFutureWatcher<ContentsSnapshot>::finished, this, [=]() {
+            const ContentsSnapshot decoded = watcher->result();
+            watcher->deleteLater();
+            emit success();
+            emit finished();
+            QtConcurrent::run([=]() {
+                cache.store(key, contents, [=]() {
+                    const ContentsSnapshot::Changes changes = decoded.compare(ContentsSnapshot::capture(contents));
+                    return changes.modified.isEmpty() && changes.added.isEmpty() && changes.removed.isEmpty();
+                });
+            });
+        });
+        watcher->setFuture(QtConcurrent::run(&ContentsSnapshot::capture, target));
+    });
+    connect(apktool, &Executable::error, this, [=](const QString &message) {
+        emit error(message);
+        emit finished();
+    });
+    connect(apktool, &Executable::output, this, &Task::output);
+    connect(this, &Task::cancelling, apktool, &Executable::cancel);
     connect(apktool, &Executable::finished, apktool, &QObject::deleteLater);
     apktool->decode(source, target, frameworks, resources, sources);
 }
@@ -48,12 +208,85 @@ Pack::Pack(const QString &source, const QString &target, const QString &framewor
     this->sources = sources;
 }
 
+void Pack::setPatchSource(const QString &apk, const QFuture<QByteArray> &fingerprint, const QFuture<ContentsSnapshot> &baseline)
+{
+    // If only the raw files (assets, images, etc.) have changed since the baseline was captured,
+    // they are patched straight into the given APK instead of running the full apktool build.
+    // The APK must still match the fingerprint taken when the contents were decoded from it.
+    patchSource = apk;
+    this->fingerprint = fingerprint;
+    this->baseline = baseline;
+}
+
 void Pack::run()
 {
-    emit started();
+    app->scheduler.enqueue(this, [=]() {
+        emit started();
+        if (!patchSource.isEmpty()) {
+            patch();
+        } else {
+            build();
+        }
+    });
+}
+
+void Pack::patch()
+{
+    // The contents are compared and patched in a worker thread; the full build is used as a fallback.
+
+    QSharedPointer<qint64> written(new qint64(0));
+    auto watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcher<bool>::finished, this, [=]() {
+        const bool isPatched = watcher->result();
+        watcher->deleteLater();
+        if (!getCancelReason().isNull()) {
+            emit error(getCancelReason());
+            emit finished();
+        } else if (isPatched) {
+            setBytesWritten(*written);
+            emit output(QString("Patched \"%1\".").arg(patchSource));
+            emit success();
+            emit finished();
+        } else {
+            build();
+        }
+    });
+    const QString apk = patchSource;
+    watcher->setFuture(QtConcurrent::run([=]() -> bool {
+        if (baseline.isCanceled() || fingerprint.isCanceled() || !QFile::exists(apk)) {
+            return false;
+        }
+        if (fingerprint.result().isEmpty() || ApkPatcher::getFingerprint(apk) != fingerprint.result()) {
+            qWarning("The APK has changed since it was opened, falling back to the full build.");
+            return false;
+        }
+        const ContentsSnapshot::Changes changes = baseline.result().compare(ContentsSnapshot::capture(source));
+        if (!ApkPatcher::isPatchable(apk, changes.modified, changes.added, changes.removed)) {
+            return false;
+        }
+        const QString tempApk = target + ".patched";
+        QString errorString;
+        if (!ApkPatcher::patch(apk, tempApk, source, changes.modified, changes.added, changes.removed, &errorString, written.data())) {
+            qWarning("Could not patch the APK (%s), falling back to the full build.", qUtf8Printable(errorString));
+            QFile::remove(tempApk);
+            return false;
+        }
+        QFile::remove(target);
+        return QFile::rename(tempApk, target);
+    }));
+}
+
+void Pack::build()
+{
     Apktool *apktool = new Apktool(app->settings->getApktoolPath(), this);
+    connect(apktool, &Executable::success, this, [=]() {
+        // Apktool also writes the intermediate build files, which are not measured:
+        setBytesWritten(-1);
+    });
     connect(apktool, &Executable::success, this, &Task::success);
     connect(apktool, &Executable::error, this, &Task::error);
+    connect(apktool, &Executable::output, this, &Task::output);
+    connect(this, &Task::cancelling, apktool, &Executable::cancel);
     connect(apktool, &Executable::finished, this, &Task::finished);
     connect(apktool, &Executable::finished, apktool, &QObject::deleteLater);
     apktool->build(source, target, frameworks, resources, sources);
@@ -68,32 +301,51 @@ Align::Align(const QString &target)
 
 void Align::run()
 {
-    emit started();
-    Zipalign *zipalign = new Zipalign(app->settings->getZipalignPath(), this);
-    connect(zipalign, &Executable::success, this, &Task::success);
-    connect(zipalign, &Executable::error, this, &Task::error);
-    connect(zipalign, &Executable::finished, this, &Task::finished);
-    connect(zipalign, &Executable::finished, zipalign, &QObject::deleteLater);
-    zipalign->align(target);
+    app->scheduler.enqueue(this, [=]() {
+        emit started();
+        Zipalign *zipalign = new Zipalign(app->settings->getZipalignPath(), this);
+        connect(zipalign, &Executable::success, this, [=]() {
+            setBytesWritten(zipalign->getBytesWritten());
+        });
+        connect(zipalign, &Executable::success, this, &Task::success);
+        connect(zipalign, &Executable::error, this, &Task::error);
+        connect(zipalign, &Executable::output, this, &Task::output);
+        connect(this, &Task::cancelling, zipalign, &Executable::cancel);
+        connect(zipalign, &Executable::finished, this, &Task::finished);
+        connect(zipalign, &Executable::finished, zipalign, &QObject::deleteLater);
+        zipalign->align(target);
+    });
 }
 
 // Sign
 
-Sign::Sign(const QString &target, const Keystore *keystore)
+Sign::Sign(const QString &target, const Keystore *keystore, bool align)
 {
     this->target = target;
     this->keystore = keystore;
+    this->align = align;
 }
 
 void Sign::run()
 {
-    emit started();
-    Apksigner *apksigner = new Apksigner(app->settings->getApksignerPath(), this);
-    connect(apksigner, &Executable::success, this, &Task::success);
-    connect(apksigner, &Executable::error, this, &Task::error);
-    connect(apksigner, &Executable::finished, this, &Task::finished);
-    connect(apksigner, &Executable::finished, apksigner, &QObject::deleteLater);
-    apksigner->sign(target, keystore);
+    app->scheduler.enqueue(this, [=]() {
+        emit started();
+        Apksigner *apksigner = new Apksigner(app->settings->getApksignerPath(), this);
+        connect(apksigner, &Executable::success, this, [=]() {
+            setBytesWritten(apksigner->getBytesWritten());
+        });
+        connect(apksigner, &Executable::success, this, &Task::success);
+        connect(apksigner, &Executable::error, this, &Task::error);
+        connect(apksigner, &Executable::output, this, &Task::output);
+        connect(this, &Task::cancelling, apksigner, &Executable::cancel);
+        connect(apksigner, &Executable::finished, this, &Task::finished);
+        connect(apksigner, &Executable::finished, apksigner, &QObject::deleteLater);
+        if (align) {
+            apksigner->alignAndSign(target, keystore, app->settings->getZipalignPath());
+        } else {
+            apksigner->sign(target, keystore);
+        }
+    });
 }
 
 // Install
@@ -102,53 +354,184 @@ Install::Install(const QString &apk, const QString &serial)
 {
     this->apk = apk;
     this->serial = serial;
+    isRetrying = false;
+    connect(this, &Task::cancelling, [=]() {
+        // No tool is running while waiting for the next attempt:
+        if (isRetrying) {
+            isRetrying = false;
+            emit error(getCancelReason());
+            emit finished();
+        }
+    });
 }
 
 void Install::run()
 {
-    emit started();
+    // Installs to the same device are serialized by the scheduler, while different devices are installed to in parallel:
+    app->scheduler.enqueue(this, [=]() {
+        emit started();
+        attempt(1);
+    }, serial);
+}
+
+void Install::attempt(int number)
+{
+    // Lost device connections are retried with an increasing delay; other errors are reported right away.
+
+    const int maxAttempts = 3;
+
     Adb *adb = new Adb(app->settings->getAdbPath(), this);
     connect(adb, &Executable::success, this, &Task::success);
-    connect(adb, &Executable::error, this, &Task::error);
-    connect(adb, &Executable::finished, this, &Task::finished);
+    connect(adb, &Executable::error, this, [=](const QString &message) {
+        if (adb->isTransientError() && number < maxAttempts && getCancelReason().isNull()) {
+            isRetrying = true;
+            emit retrying(number + 1, maxAttempts, message);
+            QTimer::singleShot(number * 2000, this, [=]() {
+                if (isRetrying) {
+                    isRetrying = false;
+                    attempt(number + 1);
+                }
+            });
+        } else {
+            emit error(message);
+        }
+    });
+    connect(adb, &Executable::output, this, &Task::output);
+    connect(this, &Task::cancelling, adb, &Executable::cancel);
+    connect(adb, &Executable::finished, this, [=]() {
+        if (!isRetrying) {
+            emit finished();
+        }
+    });
     connect(adb, &Executable::finished, adb, &QObject::deleteLater);
     adb->install(apk, serial);
 }
 
-// Batch
+// Graph
+
+Graph::Graph()
+{
+    running = 0;
+    isStarted = false;
+    isAborted = false;
+    isCompleted = false;
+}
 
-Batch::~Batch()
+Graph::~Graph()
 {
-    auto it = tasks.begin();
-    auto end = tasks.end();
-    while (it != end) {
-        delete *it;
-        ++it;
+    qDeleteAll(pending);
+}
+
+void Graph::add(Task *task, const QList<Task *> &dependencies, bool critical)
+{
+    // The task is started once all of its dependencies are finished.
+    // Failure of a critical task aborts the graph; other failures do not affect the dependent tasks.
+
+    pending.append(task);
+    this->dependencies.insert(task, dependencies);
+
+    connect(task, &Task::error, this, [=](const QString &message) {
+        if (critical && !isAborted) {
+            isAborted = true;
+            errorMessage = message;
+        }
+    });
+
+    connect(task, &Task::finished, this, [=]() {
+        --running;
+        active.remove(task);
+        done.insert(task);
+        Graph *graph = qobject_cast<Graph *>(task);
+        if (graph) {
+            stages.append(graph->getStages());
+        } else if (!task->getTitle().isEmpty()) {
+            stages.append({task->getTitle(), task->getElapsed(), task->getBytesWritten()});
+        }
+        startReady();
+    });
+}
+
+void Graph::run()
+{
+    if (!isStarted) {
+        isStarted = true;
+        emit started();
     }
+    startReady();
 }
 
-void Batch::add(Task *task, bool critical)
+void Graph::cancel(const QString &reason)
 {
-    tasks.enqueue(task);
-    if (critical) {
-        QObject::connect(task, &Task::error, [=](const QString &message) {
-            emit error(message);
-            emit finished();
-            delete this;
-        });
+    // The pending tasks are not started; the graph is finished once the running tasks are cancelled.
+
+    if (isCompleted) {
+        return;
+    }
+    if (!isAborted) {
+        isAborted = true;
+        errorMessage = reason.isEmpty() ? QString("Cancelled.") : reason;
+    }
+    for (Task *task : QSet<Task *>(active)) {
+        if (active.contains(task)) {
+            task->cancel(reason);
+        }
     }
-    QObject::connect(task, &Task::finished, this, &Batch::run);
+    if (!running) {
+        complete();
+    }
+}
+
+const QList<Graph::Stage> &Graph::getStages() const
+{
+    return stages;
 }
 
-void Batch::run()
+void Graph::startReady()
 {
-    emit started();
-    if (!tasks.isEmpty()) {
-        Task *task = tasks.dequeue();
-        task->run();
+    // Tasks may finish synchronously, so the pending list is rescanned after each start:
+
+    bool isProgressing = true;
+    while (isProgressing && !isAborted) {
+        isProgressing = false;
+        for (int i = 0; i < pending.count(); ++i) {
+            Task *task = pending.at(i);
+            bool isReady = true;
+            for (Task *dependency : dependencies.value(task)) {
+                if (!done.contains(dependency)) {
+                    isReady = false;
+                    break;
+                }
+            }
+            if (isReady) {
+                pending.removeAt(i);
+                ++running;
+                active.insert(task);
+                task->run();
+                isProgressing = true;
+                break;
+            }
+        }
+    }
+
+    if (!running) {
+        if (!pending.isEmpty() && !isAborted) {
+            isAborted = true;
+            errorMessage = "Unresolved task dependencies.";
+        }
+        complete();
+    }
+}
+
+void Graph::complete()
+{
+    if (isCompleted) {
+        return;
+    }
+    isCompleted = true;
+    if (isAborted) {
+        emit error(errorMessage);
     } else {
         emit success();
-        emit finished();
-        delete this;
     }
+    emit finished();
 }
@@ -1,8 +1,12 @@
 #ifndef TASKS_H
 #define TASKS_H
 
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QHash>
 #include <QObject>
-#include <QQueue>
+#include <QSet>
+#include "apk/contentssnapshot.h"
 #include "tools/keystore.h"
 
 namespace Tasks
@@ -15,14 +19,36 @@ namespace Tasks
     public:
         Task();
         virtual void run() = 0;
+        virtual void cancel(const QString &reason = QString());
+        void setTimeout(int seconds);
+        void setOwner(const QObject *owner);
+        const QObject *getOwner() const;
+        void setTitle(const QString &title);
+        const QString &getTitle() const;
+        qint64 getElapsed() const;
+        qint64 getBytesWritten() const;
     signals:
+        void queued(int position) const;
         void started() const;
         void finished() const;
         void success() const;
         void error(const QString &message) const;
+        void output(const QString &line) const;
+        void cancelling(const QString &reason) const;
     protected:
-        friend class Batch;
+        friend class Graph;
         virtual ~Task() {}
+        void setBytesWritten(qint64 bytes);
+        const QString &getCancelReason() const;
+    private:
+        const QObject *owner;
+        QString title;
+        QElapsedTimer timer;
+        qint64 elapsed;
+        qint64 bytesWritten;
+        QString cancelReason;
+        int timeout;
+        bool isFinished;
     };
 
     // Unpack
@@ -33,6 +59,15 @@ namespace Tasks
         Unpack(const QString &source, const QString &target, const QString &frameworks, bool resources, bool sources);
         void run() override;
     private:
+        struct Lookup
+        {
+            QString key;
+            bool isRestored;
+        };
+
+        void restore();
+        void decode(const QString &key);
+
         QString source;
         QString target;
         QString frameworks;
@@ -46,13 +81,20 @@ namespace Tasks
     {
     public:
         Pack(const QString &source, const QString &target, const QString &frameworks, bool resources, bool sources);
+        void setPatchSource(const QString &apk, const QFuture<QByteArray> &fingerprint, const QFuture<ContentsSnapshot> &baseline);
         void run() override;
     private:
+        void patch();
+        void build();
+
         QString source;
         QString target;
         QString frameworks;
         bool resources;
         bool sources;
+        QString patchSource;
+        QFuture<QByteArray> fingerprint;
+        QFuture<ContentsSnapshot> baseline;
     };
 
     // Zipalign
@@ -71,36 +113,65 @@ namespace Tasks
     class Sign : public Task
     {
     public:
-        Sign(const QString &target, const Keystore *keystore);
+        Sign(const QString &target, const Keystore *keystore, bool align = false);
         void run() override;
     private:
         QString target;
         const Keystore *keystore;
+        bool align;
     };
 
     // Install
 
     class Install : public Task
     {
+        Q_OBJECT
     public:
         Install(const QString &apk, const QString &serial);
         void run() override;
+    signals:
+        void retrying(int attempt, int maxAttempts, const QString &message) const;
     private:
+        void attempt(int number);
+
         QString apk;
         QString serial;
+        bool isRetrying;
     };
 
-    // Batch
+    // Graph
 
-    class Batch : public Task
+    class Graph : public Task
     {
         Q_OBJECT
     public:
-        void add(Task *task, bool critical = false);
+        struct Stage
+        {
+            QString title;
+            qint64 elapsed;
+            qint64 bytesWritten;
+        };
+
+        Graph();
+        void add(Task *task, const QList<Task *> &dependencies = {}, bool critical = false);
         void run() override;
+        void cancel(const QString &reason = QString()) override;
+        const QList<Stage> &getStages() const;
     private:
-        ~Batch() override;
-        QQueue<Task *> tasks;
+        ~Graph() override;
+        void startReady();
+        void complete();
+
+        QList<Task *> pending; // In the order of addition
+        QHash<Task *, QList<Task *>> dependencies;
+        QSet<Task *> active;
+        QSet<Task *> done;
+        QList<Stage> stages;
+        QString errorMessage;
+        int running;
+        bool isStarted;
+        bool isAborted;
+        bool isCompleted;
     };
 }
 
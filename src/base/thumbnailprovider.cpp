@@ -0,0 +1,88 @@
+#include "base/thumbnailprovider.h"
+#include "base/application.h"
+#include <QFileIconProvider>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QtConcurrent/QtConcurrent>
+
+namespace
+{
+    const QSize thumbnailSize(64, 64);
+    const int cacheLimit = 32 * 1024; // 32 MiB
+    const qint64 storeLimit = 64 * 1024 * 1024; // 64 MiB
+}
+
+ThumbnailProvider::ThumbnailProvider(QObject *parent) : QObject(parent)
+{
+    cache.setMaxCost(cacheLimit);
+}
+
+ThumbnailProvider::~ThumbnailProvider()
+{
+    pool.clear();
+    pool.waitForDone();
+}
+
+QPixmap ThumbnailProvider::get(const QString &path)
+{
+    // Returns a null pixmap if the thumbnail is not ready yet; the "ready" signal is emitted once it is.
+
+    const QDateTime modified = QFileInfo(path).lastModified();
+    const Thumbnail *thumbnail = cache.object(path);
+    if (thumbnail && thumbnail->modified == modified) {
+        return thumbnail->pixmap;
+    }
+
+    if (!pending.contains(path)) {
+        if (!store) {
+            // Thumbnails decoded in previous sessions are persisted next to the recent file thumbnails:
+            store.reset(new ThumbnailStore(app->getLocalConfigPath("recent/thumbnails/resources"), storeLimit));
+        }
+        pending.insert(path);
+        auto watcher = new QFutureWatcher<QImage>(this);
+        connect(watcher, &QFutureWatcher<QImage>::finished, [=]() {
+            const QImage image = watcher->result();
+            watcher->deleteLater();
+            pending.remove(path);
+            auto thumbnail = new Thumbnail;
+            thumbnail->pixmap = !image.isNull()
+                ? QPixmap::fromImage(image)
+                : QFileIconProvider().icon(QFileInfo(path)).pixmap(thumbnailSize);
+            thumbnail->modified = modified;
+            const int cost = qMax(1, thumbnail->pixmap.width() * thumbnail->pixmap.height() * thumbnail->pixmap.depth() / 8 / 1024);
+            cache.insert(path, thumbnail, cost);
+            emit ready(path);
+        });
+        watcher->setFuture(QtConcurrent::run(&pool, &ThumbnailProvider::load, path, thumbnailSize, store.data()));
+    }
+
+    return QPixmap();
+}
+
+QImage ThumbnailProvider::load(const QString &path, const QSize &size, ThumbnailStore *store)
+{
+    // Try the disk store first:
+
+    const QByteArray key = ThumbnailStore::key(path, size);
+    if (!key.isEmpty()) {
+        const QImage stored = store->read(key);
+        if (!stored.isNull()) {
+            return stored;
+        }
+    }
+
+    // Decode the image:
+
+    QImageReader reader(path);
+    const QSize originalSize = reader.size();
+    if (originalSize.isValid() && (originalSize.width() > size.width() || originalSize.height() > size.height())) {
+        // Let the image plugin downscale while decoding where supported:
+        reader.setScaledSize(originalSize.scaled(size, Qt::KeepAspectRatio));
+    }
+    QImage image = reader.read();
+    if (!image.isNull() && (image.width() > size.width() || image.height() > size.height())) {
+        image = image.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    store->write(key, image);
+    return image;
+}
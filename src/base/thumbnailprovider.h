@@ -0,0 +1,40 @@
+#ifndef THUMBNAILPROVIDER_H
+#define THUMBNAILPROVIDER_H
+
+#include "base/thumbnailstore.h"
+#include <QCache>
+#include <QDateTime>
+#include <QPixmap>
+#include <QScopedPointer>
+#include <QSet>
+#include <QThreadPool>
+
+class ThumbnailProvider : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ThumbnailProvider(QObject *parent = nullptr);
+    ~ThumbnailProvider() override;
+
+    QPixmap get(const QString &path);
+
+signals:
+    void ready(const QString &path) const;
+
+private:
+    struct Thumbnail
+    {
+        QPixmap pixmap;
+        QDateTime modified;
+    };
+
+    static QImage load(const QString &path, const QSize &size, ThumbnailStore *store);
+
+    QCache<QString, Thumbnail> cache; // Cost is measured in kilobytes
+    QSet<QString> pending;
+    QThreadPool pool;
+    QScopedPointer<ThumbnailStore> store;
+};
+
+#endif // THUMBNAILPROVIDER_H
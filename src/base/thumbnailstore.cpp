@@ -0,0 +1,253 @@
+#include "base/thumbnailstore.h"
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <algorithm>
+
+namespace
+{
+    // Pack file: header and generation followed by the concatenated PNG records.
+    // Index file: header and generation followed by the <key, offset, size, access> entries.
+
+    const QByteArray packMagic("AESPACK2");
+    const quint32 indexMagic = 0x41455349; // "AESI"
+    const quint32 indexVersion = 2;
+    const qint64 sampleSize = 64 * 1024; // Size of the beginning and the end of the file which are hashed for the key
+
+    QByteArray packHeader(quint64 generation)
+    {
+        QByteArray header = packMagic;
+        QDataStream stream(&header, QIODevice::WriteOnly | QIODevice::Append);
+        stream << generation;
+        return header;
+    }
+
+    const int packHeaderSize = packMagic.size() + static_cast<int>(sizeof(quint64));
+}
+
+ThumbnailStore::ThumbnailStore(const QString &path, qint64 limit)
+{
+    this->limit = limit;
+    clock = 0;
+    generation = 0;
+    modified = false;
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    pack.setFileName(path + ".pack");
+    indexPath = path + ".idx";
+    open();
+}
+
+ThumbnailStore::~ThumbnailStore()
+{
+    save();
+}
+
+QByteArray ThumbnailStore::key(const QString &filename, const QSize &size)
+{
+    // Key consists of the file size, modification time, a hash of the beginning and the end of the file
+    // and the thumbnail size. Only a bounded part of the file is read, however large it is.
+
+    QFile file(filename);
+    if (!file.open(QFile::ReadOnly)) {
+        return QByteArray();
+    }
+    const qint64 fileSize = file.size();
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(file.read(sampleSize));
+    if (fileSize > sampleSize) {
+        file.seek(qMax(sampleSize, fileSize - sampleSize));
+        hash.addData(file.read(sampleSize));
+    }
+    const QFileInfo info(file);
+
+    QByteArray key;
+    QDataStream stream(&key, QIODevice::WriteOnly);
+    stream << fileSize
+           << info.lastModified().toMSecsSinceEpoch()
+           << hash.result()
+           << size;
+    return key;
+}
+
+QImage ThumbnailStore::read(const QByteArray &key)
+{
+    QMutexLocker locker(&mutex);
+    auto it = index.find(key);
+    if (it == index.end() || !pack.isOpen() || !pack.seek(it->offset)) {
+        return QImage();
+    }
+    const QByteArray data = pack.read(it->size);
+    QImage image;
+    if (data.size() != it->size || !image.loadFromData(data, "PNG")) {
+        index.erase(it);
+        modified = true;
+        return QImage();
+    }
+    it->access = ++clock;
+    modified = true;
+    return image;
+}
+
+void ThumbnailStore::write(const QByteArray &key, const QImage &image)
+{
+    if (key.isEmpty() || image.isNull()) {
+        return;
+    }
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    if (!image.save(&buffer, "PNG")) {
+        return;
+    }
+
+    QMutexLocker locker(&mutex);
+    if (!pack.isOpen()) {
+        return;
+    }
+    const qint64 offset = pack.size();
+    if (!pack.seek(offset) || pack.write(data) != data.size()) {
+        return;
+    }
+    index.insert(key, {offset, data.size(), ++clock});
+    modified = true;
+
+    if (pack.size() > limit) {
+        compact();
+    }
+}
+
+void ThumbnailStore::save()
+{
+    QMutexLocker locker(&mutex);
+    if (modified) {
+        pack.flush();
+        saveIndex();
+        modified = false;
+    }
+}
+
+void ThumbnailStore::open()
+{
+    if (!pack.open(QFile::ReadWrite)) {
+        qWarning("Could not open thumbnail cache: %s", qUtf8Printable(pack.fileName()));
+        return;
+    }
+
+    // Load index:
+
+    QFile indexFile(indexPath);
+    const QByteArray header = pack.read(packHeaderSize);
+    if (header.size() != packHeaderSize || !header.startsWith(packMagic) || !indexFile.open(QFile::ReadOnly)) {
+        reset();
+        return;
+    }
+    QDataStream headerStream(header.mid(packMagic.size()));
+    headerStream >> generation;
+    QDataStream stream(&indexFile);
+    quint32 magic, version;
+    quint64 indexGeneration;
+    stream >> magic >> version >> indexGeneration;
+    if (magic != indexMagic || version != indexVersion || indexGeneration != generation) {
+        reset();
+        return;
+    }
+    qint32 count;
+    stream >> count;
+    const qint64 packSize = pack.size();
+    for (qint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QByteArray key;
+        Entry entry;
+        stream >> key >> entry.offset >> entry.size >> entry.access;
+        if (stream.status() == QDataStream::Ok && entry.offset + entry.size <= packSize) {
+            index.insert(key, entry);
+            clock = qMax(clock, entry.access);
+        }
+    }
+}
+
+void ThumbnailStore::reset()
+{
+    index.clear();
+    generation = nextGeneration();
+    pack.resize(0);
+    pack.seek(0);
+    pack.write(packHeader(generation));
+    QFile::remove(indexPath);
+    modified = true;
+}
+
+void ThumbnailStore::compact()
+{
+    // Keep the most recently used entries until the pack shrinks to half of the limit:
+
+    QList<QByteArray> keys = index.keys();
+    std::sort(keys.begin(), keys.end(), [this](const QByteArray &a, const QByteArray &b) {
+        return index.value(a).access > index.value(b).access;
+    });
+
+    QFile compacted(pack.fileName() + ".tmp");
+    if (!compacted.open(QFile::WriteOnly)) {
+        return;
+    }
+    const quint64 compactedGeneration = nextGeneration();
+    compacted.write(packHeader(compactedGeneration));
+    QHash<QByteArray, Entry> kept;
+    for (const QByteArray &key : keys) {
+        const Entry &entry = index[key];
+        if (compacted.pos() + entry.size > limit / 2) {
+            break;
+        }
+        if (pack.seek(entry.offset)) {
+            const QByteArray data = pack.read(entry.size);
+            if (data.size() == entry.size) {
+                kept.insert(key, {compacted.pos(), entry.size, entry.access});
+                compacted.write(data);
+            }
+        }
+    }
+    compacted.close();
+
+    // The index of the compacted pack is saved before the pack is replaced. If the pack is not replaced
+    // (e.g., the application is terminated in between), its generation doesn't match the index on the next start:
+
+    const QString filename = pack.fileName();
+    index = kept;
+    generation = compactedGeneration;
+    saveIndex();
+    modified = false;
+    pack.close();
+    QFile::remove(filename);
+    if (!compacted.rename(filename)) {
+        compacted.remove();
+    }
+    if (!pack.open(QFile::ReadWrite)) {
+        index.clear();
+        return;
+    }
+    if (pack.read(packHeaderSize) != packHeader(generation)) {
+        reset();
+    }
+}
+
+void ThumbnailStore::saveIndex() const
+{
+    QFile indexFile(indexPath);
+    if (!indexFile.open(QFile::WriteOnly)) {
+        return;
+    }
+    QDataStream stream(&indexFile);
+    stream << indexMagic << indexVersion << generation << static_cast<qint32>(index.size());
+    for (auto it = index.constBegin(); it != index.constEnd(); ++it) {
+        stream << it.key() << it->offset << it->size << it->access;
+    }
+}
+
+quint64 ThumbnailStore::nextGeneration() const
+{
+    return qMax(static_cast<quint64>(QDateTime::currentMSecsSinceEpoch()), generation + 1);
+}
@@ -0,0 +1,45 @@
+#ifndef THUMBNAILSTORE_H
+#define THUMBNAILSTORE_H
+
+#include <QFile>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+
+class ThumbnailStore
+{
+public:
+    ThumbnailStore(const QString &path, qint64 limit);
+    ~ThumbnailStore();
+
+    static QByteArray key(const QString &filename, const QSize &size);
+
+    QImage read(const QByteArray &key);
+    void write(const QByteArray &key, const QImage &image);
+    void save();
+
+private:
+    struct Entry
+    {
+        qint64 offset;
+        qint32 size;
+        quint64 access;
+    };
+
+    void open();
+    void reset();
+    void compact();
+    void saveIndex() const;
+    quint64 nextGeneration() const;
+
+    QFile pack;
+    QString indexPath;
+    QHash<QByteArray, Entry> index;
+    quint64 clock;
+    quint64 generation; // Stored in both the pack and the index, so that they are only used together
+    qint64 limit;
+    bool modified;
+    QMutex mutex;
+};
+
+#endif // THUMBNAILSTORE_H
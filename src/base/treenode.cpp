@@ -8,6 +8,7 @@ TreeNode::~TreeNode()
 void TreeNode::addChild(TreeNode *node)
 {
     node->parent = this;
+    node->position = children.count();
     children.append(node);
 }
 
@@ -20,6 +21,7 @@ bool TreeNode::removeChild(int row)
 {
     delete children[row];
     children.remove(row);
+    updateRows(row);
     return true;
 }
 
@@ -28,12 +30,28 @@ bool TreeNode::removeSelf()
     return parent->removeChild(row());
 }
 
+void TreeNode::deleteChildren()
+{
+    qDeleteAll(children);
+    children.clear();
+}
+
+QVector<TreeNode *> TreeNode::takeChildren()
+{
+    QVector<TreeNode *> result;
+    result.swap(children);
+    for (TreeNode *child : result) {
+        child->parent = nullptr;
+    }
+    return result;
+}
+
 int TreeNode::childCount() const
 {
     return children.count();
 }
 
-QVector<TreeNode *> &TreeNode::getChildren()
+const QVector<TreeNode *> &TreeNode::getChildren() const
 {
     return children;
 }
@@ -67,5 +85,16 @@ TreeNode *TreeNode::getParent() const
 
 int TreeNode::row() const
 {
-    return parent ? parent->children.indexOf(const_cast<TreeNode *>(this)) : 0;
+    if (!parent) {
+        return 0;
+    }
+    Q_ASSERT(parent->children.at(position) == this);
+    return position;
+}
+
+void TreeNode::updateRows(int from)
+{
+    for (int row = from; row < children.count(); ++row) {
+        children.at(row)->position = row;
+    }
 }
@@ -2,28 +2,45 @@
 #define TREENODE_H
 
 #include <QVector>
+#include <algorithm>
 
 class TreeNode
 {
 public:
-    TreeNode() : parent(nullptr) {}
+    TreeNode() : parent(nullptr), position(0) {}
     virtual ~TreeNode();
 
     void addChild(TreeNode *node);
     bool hasChild(TreeNode *node) const;
     virtual bool removeChild(int row);
     bool removeSelf();
+    void deleteChildren();
+    QVector<TreeNode *> takeChildren();
     int childCount() const;
-    QVector<TreeNode *> &getChildren();
+    const QVector<TreeNode *> &getChildren() const;
     TreeNode *getChild(int row) const;
     TreeNode *findChild(TreeNode *node) const;
     TreeNode *getParent() const;
     int row() const;
 
+    template<typename Compare>
+    void sortChildren(Compare compare);
+
 protected:
+    void updateRows(int from = 0);
+
     TreeNode *parent;
     QVector<TreeNode *> children;
+
+private:
+    int position; // Cached row within the parent node
 };
 
+template<typename Compare>
+void TreeNode::sortChildren(Compare compare)
+{
+    std::sort(children.begin(), children.end(), compare);
+    updateRows();
+}
 
 #endif // TREENODE_H
@@ -0,0 +1,196 @@
+#include "base/unpackcache.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QUuid>
+#include <algorithm>
+
+#if defined(Q_OS_LINUX)
+    #include <fcntl.h>
+    #include <sys/ioctl.h>
+    #include <unistd.h>
+    #include <linux/fs.h>
+#elif defined(Q_OS_OSX) && defined(__has_include)
+    #if __has_include(<sys/clonefile.h>)
+        #include <sys/clonefile.h>
+        #define HAS_CLONEFILE
+    #endif
+#endif
+
+// Each entry consists of the decoded contents in the "<key>" directory and the "<key>.size" file.
+// The size file holds the total size of the entry in bytes; its modification time is the time of the last use.
+
+UnpackCache::UnpackCache(const QString &path, qint64 limit)
+{
+    this->path = path;
+    this->limit = limit;
+}
+
+QString UnpackCache::key(const QString &apk, const QString &apktoolVersion, const QString &frameworks, bool resources, bool sources)
+{
+    // SHA-256 of the APK combined with everything which affects the decoded output, including the contents
+    // of the installed frameworks. Returns a null string on error.
+
+    QFile file(apk);
+    if (!file.open(QFile::ReadOnly)) {
+        return QString();
+    }
+    QCryptographicHash apkHash(QCryptographicHash::Sha256);
+    if (!apkHash.addData(&file)) {
+        return QString();
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(apkHash.result());
+    hash.addData(apktoolVersion.toUtf8() + '\n');
+    hash.addData(QDir::cleanPath(frameworks).toUtf8() + '\n');
+    if (!frameworks.isEmpty()) {
+        for (const QFileInfo &framework : QDir(frameworks).entryInfoList(QDir::Files, QDir::Name)) {
+            QFile frameworkFile(framework.filePath());
+            QCryptographicHash frameworkHash(QCryptographicHash::Sha256);
+            if (!frameworkFile.open(QFile::ReadOnly) || !frameworkHash.addData(&frameworkFile)) {
+                return QString();
+            }
+            hash.addData(framework.fileName().toUtf8() + '\n');
+            hash.addData(frameworkHash.result());
+        }
+    }
+    hash.addData(QByteArray(resources ? "res" : "no-res") + (sources ? "src" : "no-src"));
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+bool UnpackCache::restore(const QString &key, const QString &target) const
+{
+    // Clones the cached contents into the (empty) target directory.
+
+    const QString entry = QString("%1/%2").arg(path, key);
+    if (!QFileInfo(entry).isDir()) {
+        return false;
+    }
+    const qint64 size = cloneTree(entry, target);
+    if (size < 0) {
+        QDir(target).removeRecursively();
+        QDir().mkpath(target);
+        return false;
+    }
+    QFile sizeFile(entry + ".size");
+    if (sizeFile.open(QFile::WriteOnly)) {
+        sizeFile.write(QByteArray::number(size));
+    }
+    return true;
+}
+
+bool UnpackCache::store(const QString &key, const QString &source, const std::function<bool()> &isIntact) const
+{
+    // The contents are cloned into a temporary directory which is then renamed, so that the concurrently
+    // restored entries are always complete. If the source may change during the cloning, the clone is only
+    // kept if isIntact() confirms that the source is still unmodified.
+
+    const QString entry = QString("%1/%2").arg(path, key);
+    if (QFileInfo(entry).isDir()) {
+        return true;
+    }
+    const QString temp = QString("%1/%2.%3").arg(path, key, QUuid::createUuid().toString().mid(1, 8));
+    const qint64 size = cloneTree(source, temp);
+    if (size < 0 || size > limit || (isIntact && !isIntact()) || !QDir().rename(temp, entry)) {
+        QDir(temp).removeRecursively();
+        return false;
+    }
+    QFile sizeFile(entry + ".size");
+    if (sizeFile.open(QFile::WriteOnly)) {
+        sizeFile.write(QByteArray::number(size));
+    }
+    evict();
+    return true;
+}
+
+void UnpackCache::evict() const
+{
+    // Least recently used entries are removed until the total size fits in the limit.
+
+    QFileInfoList sizeFiles = QDir(path).entryInfoList(QStringList("*.size"), QDir::Files);
+    std::sort(sizeFiles.begin(), sizeFiles.end(), [](const QFileInfo &a, const QFileInfo &b) {
+        return a.lastModified() > b.lastModified();
+    });
+    qint64 total = 0;
+    for (const QFileInfo &sizeFile : sizeFiles) {
+        QFile file(sizeFile.filePath());
+        const qint64 size = file.open(QFile::ReadOnly) ? file.readAll().toLongLong() : 0;
+        file.close();
+        total += size;
+        if (total > limit) {
+            const QString entry = QString("%1/%2").arg(path, sizeFile.completeBaseName());
+            QFile::remove(sizeFile.filePath());
+            QDir(entry).removeRecursively();
+        }
+    }
+
+    // Leftovers of the interrupted stores (e.g., after a crash) are removed once they are stale: temporary
+    // "<key>.xxxxxxxx" directories and entries without the size file. Recent ones may belong to a concurrent store.
+
+    const QDateTime staleTime = QDateTime::currentDateTime().addSecs(-60 * 60);
+    for (const QFileInfo &directory : QDir(path).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        const bool isTemporary = directory.fileName().contains('.');
+        const bool isOrphaned = !isTemporary && !QFileInfo::exists(directory.filePath() + ".size");
+        if ((isTemporary || isOrphaned) && directory.lastModified() < staleTime) {
+            QDir(directory.filePath()).removeRecursively();
+        }
+    }
+}
+
+qint64 UnpackCache::cloneTree(const QString &source, const QString &target)
+{
+    // Returns the total size of the cloned files or -1 on error.
+
+    const QDir sourceDir(source);
+    if (!QDir().mkpath(target)) {
+        return -1;
+    }
+    qint64 size = 0;
+    QDirIterator it(source, QDir::Dirs | QDir::Files | QDir::Hidden | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const QString sourcePath = it.next();
+        const QString targetPath = QString("%1/%2").arg(target, sourceDir.relativeFilePath(sourcePath));
+        const QFileInfo fileInfo = it.fileInfo();
+        if (fileInfo.isDir()) {
+            if (!QDir().mkpath(targetPath)) {
+                return -1;
+            }
+        } else {
+            if (!cloneFile(sourcePath, targetPath)) {
+                return -1;
+            }
+            size += fileInfo.size();
+        }
+    }
+    return size;
+}
+
+bool UnpackCache::cloneFile(const QString &source, const QString &target)
+{
+    // Copy-on-write clones (reflinks) are used where the filesystem supports them (e.g., Btrfs, XFS, APFS).
+    // Hard links are not used: the editors modify the project files in place, which would alter the cache.
+
+#if defined(Q_OS_LINUX) && defined(FICLONE)
+    const int sourceFd = ::open(QFile::encodeName(source).constData(), O_RDONLY | O_CLOEXEC);
+    if (sourceFd >= 0) {
+        const int targetFd = ::open(QFile::encodeName(target).constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (targetFd >= 0) {
+            const bool isCloned = ioctl(targetFd, FICLONE, sourceFd) == 0;
+            ::close(targetFd);
+            ::close(sourceFd);
+            if (isCloned) {
+                return true;
+            }
+            QFile::remove(target);
+        } else {
+            ::close(sourceFd);
+        }
+    }
+#elif defined(HAS_CLONEFILE)
+    if (clonefile(QFile::encodeName(source).constData(), QFile::encodeName(target).constData(), 0) == 0) {
+        return true;
+    }
+#endif
+    return QFile::copy(source, target);
+}
@@ -0,0 +1,26 @@
+#ifndef UNPACKCACHE_H
+#define UNPACKCACHE_H
+
+#include <QString>
+#include <functional>
+
+class UnpackCache
+{
+public:
+    UnpackCache(const QString &path, qint64 limit);
+
+    static QString key(const QString &apk, const QString &apktoolVersion, const QString &frameworks, bool resources, bool sources);
+
+    bool restore(const QString &key, const QString &target) const;
+    bool store(const QString &key, const QString &source, const std::function<bool()> &isIntact = nullptr) const;
+
+private:
+    void evict() const;
+    static qint64 cloneTree(const QString &source, const QString &target);
+    static bool cloneFile(const QString &source, const QString &target);
+
+    QString path;
+    qint64 limit;
+};
+
+#endif // UNPACKCACHE_H
@@ -17,6 +17,21 @@ QString Utils::capitalize(QString string)
     return string;
 }
 
+QString Utils::formatSize(qint64 bytes)
+{
+    if (bytes < 1024) {
+        return QString("%1 B").arg(bytes);
+    }
+    const QStringList units = {"KiB", "MiB", "GiB"};
+    double size = bytes / 1024.0;
+    int unit = 0;
+    while (size >= 1024 && unit < units.size() - 1) {
+        size /= 1024;
+        ++unit;
+    }
+    return QString("%1 %2").arg(size, 0, 'f', 1).arg(units.at(unit));
+}
+
 int Utils::roundToNearest(int number, QList<int> numbers)
 {
     if (numbers.isEmpty()) {
@@ -149,7 +164,9 @@ bool Utils::replaceFile(const QString &what, QString with)
         return false;
     }
     if (!copy(with, what)) {
-        QMessageBox::warning(app->window, QString(), app->translate("Utils", "Could not replace the file."));
+        if (app->window) {
+            QMessageBox::warning(app->window, QString(), app->translate("Utils", "Could not replace the file."));
+        }
         return false;
     }
     return true;
@@ -10,6 +10,7 @@ namespace Utils
     // String utils:
 
     QString capitalize(QString string);
+    QString formatSize(qint64 bytes);
 
     // Math utils:
 
@@ -4,11 +4,16 @@
 
 Adb::Adb(const QString &executable, QObject *parent) : Executable(executable, parent)
 {
-    connect(&process, &QProcess::readyRead, [=]() {
-        const QString output = process.readAllStandardOutput();
-        if (output.contains("failed to get feature set")) {
+    transientError = false;
+
+    // The device connection was lost (e.g., the device is still booting or the connection is unstable).
+    // The process may hang in this case, so it is stopped; the line is reported with the "error" signal.
+
+    connect(this, &Executable::output, [=](const QString &line) {
+        if (!transientError && line.contains("failed to get feature set")) {
+            transientError = true;
+            cancel(line);
             process.kill();
-            emit error(output);
         }
     });
 }
@@ -60,3 +65,9 @@ QString Adb::version() const
     const QString version = regex.match(result.value).captured(1).trimmed();
     return version;
 }
+
+bool Adb::isTransientError() const
+{
+    // True if the last call failed because of the device connection rather than of the APK.
+    return transientError;
+}
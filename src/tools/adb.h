@@ -13,6 +13,10 @@ public:
     QList<QSharedPointer<Device>> devices() const;
 
     QString version() const;
+    bool isTransientError() const;
+
+private:
+    bool transientError;
 };
 
 #endif // ADB_H
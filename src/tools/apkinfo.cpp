@@ -0,0 +1,525 @@
+#include "tools/apkinfo.h"
+#include "tools/ziparchive.h"
+#include <QHash>
+#include <QVector>
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+    // Compiled resource formats, as described in "ResourceTypes.h" of the Android framework.
+
+    enum ChunkType {
+        StringPoolChunk = 0x0001,
+        TableChunk = 0x0002,
+        XmlChunk = 0x0003,
+        XmlStartElementChunk = 0x0102,
+        XmlResourceMapChunk = 0x0180,
+        TablePackageChunk = 0x0200,
+        TableTypeChunk = 0x0201
+    };
+
+    enum ValueType {
+        ReferenceType = 0x01,
+        StringType = 0x03,
+        DecimalType = 0x10,
+        HexadecimalType = 0x11
+    };
+
+    enum AttributeId : quint32 {
+        LabelAttribute = 0x01010001,
+        IconAttribute = 0x01010002,
+        DrawableAttribute = 0x01010199,
+        MinSdkVersionAttribute = 0x0101020c,
+        VersionCodeAttribute = 0x0101021b,
+        VersionNameAttribute = 0x0101021c,
+        TargetSdkVersionAttribute = 0x01010270
+    };
+
+    const int maxReferenceDepth = 8;
+    const quint32 maxEntrySize = 64 * 1024 * 1024;
+
+    // Bounds-checked little-endian reader; out of range values are read as zeros.
+
+    class Data
+    {
+    public:
+        explicit Data(const QByteArray &bytes = QByteArray()) : bytes(bytes) {}
+
+        qint64 size() const { return bytes.size(); }
+        const char *at(qint64 offset) const { return bytes.constData() + offset; }
+        bool contains(qint64 offset, qint64 length) const { return offset >= 0 && length >= 0 && offset + length <= bytes.size(); }
+        quint8 u8(qint64 offset) const { return contains(offset, 1) ? static_cast<quint8>(*at(offset)) : 0; }
+        quint16 u16(qint64 offset) const { return contains(offset, 2) ? ZipArchive::readUInt16(reinterpret_cast<const uchar *>(at(offset))) : 0; }
+        quint32 u32(qint64 offset) const { return contains(offset, 4) ? ZipArchive::readUInt32(reinterpret_cast<const uchar *>(at(offset))) : 0; }
+
+    private:
+        QByteArray bytes;
+    };
+
+    class StringPool
+    {
+    public:
+        StringPool() : count(0), indexStart(0), stringsStart(0), isUtf8(false) {}
+
+        void parse(const Data &data, qint64 offset)
+        {
+            this->data = data;
+            count = data.u32(offset + 8);
+            isUtf8 = data.u32(offset + 16) & 0x100;
+            indexStart = offset + data.u16(offset + 2);
+            stringsStart = offset + data.u32(offset + 20);
+        }
+
+        QString at(quint32 index) const
+        {
+            if (index >= count) {
+                return QString();
+            }
+            qint64 position = stringsStart + data.u32(indexStart + index * 4ll);
+            if (isUtf8) {
+                // Length in characters followed by the length in bytes, each of them takes one or two bytes:
+                position += (data.u8(position) & 0x80) ? 2 : 1;
+                int length = data.u8(position);
+                if (length & 0x80) {
+                    length = ((length & 0x7F) << 8) | data.u8(position + 1);
+                    position += 2;
+                } else {
+                    position += 1;
+                }
+                return data.contains(position, length) ? QString::fromUtf8(data.at(position), length) : QString();
+            }
+            int length = data.u16(position);
+            if (length & 0x8000) {
+                length = ((length & 0x7FFF) << 16) | data.u16(position + 2);
+                position += 4;
+            } else {
+                position += 2;
+            }
+            if (!data.contains(position, length * 2ll)) {
+                return QString();
+            }
+            QString string;
+            string.reserve(length);
+            for (int i = 0; i < length; ++i) {
+                string.append(QChar(data.u16(position + i * 2ll)));
+            }
+            return string;
+        }
+
+    private:
+        Data data;
+        quint32 count;
+        qint64 indexStart;
+        qint64 stringsStart;
+        bool isUtf8;
+    };
+
+    // Binary XML
+
+    struct XmlAttribute
+    {
+        QString name;
+        quint32 id;
+        quint8 type;
+        quint32 data;
+        QString string;
+    };
+
+    typedef std::function<void(const QString &element, const QVector<XmlAttribute> &attributes)> XmlVisitor;
+
+    bool parseXml(const QByteArray &bytes, const XmlVisitor &visitor)
+    {
+        // Only the start elements are reported.
+
+        const Data data(bytes);
+        if (data.u16(0) != XmlChunk) {
+            return false;
+        }
+        StringPool pool;
+        QVector<quint32> resourceIds;
+        const qint64 end = qMin<qint64>(data.u32(4), data.size());
+        qint64 position = data.u16(2);
+        while (position + 8 <= end) {
+            const quint16 headerSize = data.u16(position + 2);
+            const quint32 size = data.u32(position + 4);
+            if (size < 8 || headerSize < 8) {
+                return false;
+            }
+            switch (data.u16(position)) {
+            case StringPoolChunk:
+                pool.parse(data, position);
+                break;
+            case XmlResourceMapChunk:
+                for (qint64 i = position + headerSize; i + 4 <= position + size; i += 4) {
+                    resourceIds.append(data.u32(i));
+                }
+                break;
+            case XmlStartElementChunk: {
+                const qint64 body = position + headerSize;
+                const QString element = pool.at(data.u32(body + 4));
+                const quint16 attributeStart = data.u16(body + 8);
+                const quint16 attributeSize = data.u16(body + 10);
+                const quint16 attributeCount = data.u16(body + 12);
+                QVector<XmlAttribute> attributes;
+                for (int i = 0; i < attributeCount; ++i) {
+                    const qint64 offset = body + attributeStart + static_cast<qint64>(i) * attributeSize;
+                    const quint32 name = data.u32(offset + 4);
+                    const quint32 raw = data.u32(offset + 8);
+                    XmlAttribute attribute;
+                    attribute.name = pool.at(name);
+                    attribute.id = (name < static_cast<quint32>(resourceIds.size())) ? resourceIds.at(static_cast<int>(name)) : 0;
+                    attribute.type = data.u8(offset + 15);
+                    attribute.data = data.u32(offset + 16);
+                    if (raw != 0xFFFFFFFF) {
+                        attribute.string = pool.at(raw);
+                    } else if (attribute.type == StringType) {
+                        attribute.string = pool.at(attribute.data);
+                    }
+                    attributes.append(attribute);
+                }
+                visitor(element, attributes);
+                break;
+            }
+            }
+            position += size;
+        }
+        return true;
+    }
+
+    // Resource table
+
+    class ResourceTable
+    {
+    public:
+        struct Value
+        {
+            quint8 type;
+            quint32 data;
+            quint16 language;
+            quint16 density;
+        };
+
+        bool parse(const QByteArray &bytes)
+        {
+            // Only the locations of the type chunks are indexed, the entries are read on demand.
+
+            data = Data(bytes);
+            if (data.u16(0) != TableChunk) {
+                return false;
+            }
+            const qint64 end = qMin<qint64>(data.u32(4), data.size());
+            qint64 position = data.u16(2);
+            while (position + 8 <= end) {
+                const quint32 size = data.u32(position + 4);
+                if (size < 8) {
+                    return false;
+                }
+                const quint16 type = data.u16(position);
+                if (type == StringPoolChunk) {
+                    strings.parse(data, position);
+                } else if (type == TablePackageChunk) {
+                    const quint32 package = data.u32(position + 8);
+                    const qint64 packageEnd = qMin(end, position + size);
+                    qint64 child = position + data.u16(position + 2);
+                    while (child + 8 <= packageEnd) {
+                        const quint32 childSize = data.u32(child + 4);
+                        if (childSize < 8) {
+                            break;
+                        }
+                        if (data.u16(child) == TableTypeChunk) {
+                            types[(package << 8) | data.u8(child + 8)].append(child);
+                        }
+                        child += childSize;
+                    }
+                }
+                position += size;
+            }
+            return true;
+        }
+
+        QVector<Value> getValues(quint32 id) const
+        {
+            // Returns the simple values of the resource in all of its configurations.
+
+            QVector<Value> values;
+            const quint32 entry = id & 0xFFFF;
+            for (const qint64 chunk : types.value(id >> 16)) {
+                const quint8 flags = data.u8(chunk + 9);
+                const quint32 entryCount = data.u32(chunk + 12);
+                const qint64 entriesStart = chunk + data.u32(chunk + 16);
+                const qint64 config = chunk + 20;
+                const qint64 offsets = chunk + data.u16(chunk + 2);
+
+                quint32 offset = 0xFFFFFFFF;
+                if (flags & 0x01) {
+                    // Sparse type: <entry index, offset / 4> pairs
+                    for (quint32 i = 0; i < entryCount; ++i) {
+                        if (data.u16(offsets + i * 4ll) == entry) {
+                            offset = data.u16(offsets + i * 4ll + 2) * 4u;
+                            break;
+                        }
+                    }
+                } else if (entry < entryCount) {
+                    if (flags & 0x02) {
+                        // 16-bit offsets (divided by 4)
+                        const quint16 value = data.u16(offsets + entry * 2ll);
+                        offset = (value != 0xFFFF) ? value * 4u : 0xFFFFFFFF;
+                    } else {
+                        offset = data.u32(offsets + entry * 4ll);
+                    }
+                }
+                if (offset == 0xFFFFFFFF) {
+                    continue;
+                }
+
+                const qint64 position = entriesStart + offset;
+                const quint16 entryFlags = data.u16(position + 2);
+                Value value;
+                if (entryFlags & 0x08) {
+                    // Compact entry: the type is kept in the flags, followed by the data
+                    value.type = static_cast<quint8>(entryFlags >> 8);
+                    value.data = data.u32(position + 4);
+                } else if (entryFlags & 0x01) {
+                    continue; // Complex (bag) entry
+                } else {
+                    const qint64 valuePosition = position + data.u16(position);
+                    value.type = data.u8(valuePosition + 3);
+                    value.data = data.u32(valuePosition + 4);
+                }
+                value.language = data.u16(config + 8);
+                value.density = data.u16(config + 14);
+                values.append(value);
+            }
+            return values;
+        }
+
+        QString getString(quint32 index) const
+        {
+            return strings.at(index);
+        }
+
+    private:
+        Data data;
+        StringPool strings;
+        QHash<quint32, QVector<qint64>> types; // <package id, type id> -> type chunk offsets
+    };
+
+    QString resolveString(const ResourceTable &table, quint32 id, int depth = 0)
+    {
+        // The default locale is preferred.
+
+        QVector<ResourceTable::Value> values = table.getValues(id);
+        std::stable_sort(values.begin(), values.end(), [](const ResourceTable::Value &a, const ResourceTable::Value &b) {
+            return a.language == 0 && b.language != 0;
+        });
+        for (const ResourceTable::Value &value : values) {
+            if (value.type == StringType) {
+                return table.getString(value.data);
+            } else if (value.type == ReferenceType && depth < maxReferenceDepth) {
+                const QString string = resolveString(table, value.data, depth + 1);
+                if (!string.isNull()) {
+                    return string;
+                }
+            }
+        }
+        return QString();
+    }
+
+    QString getString(const ResourceTable &table, const XmlAttribute &attribute)
+    {
+        return (attribute.type == ReferenceType) ? resolveString(table, attribute.data) : attribute.string;
+    }
+
+    int getInteger(const XmlAttribute &attribute)
+    {
+        if (attribute.type == DecimalType || attribute.type == HexadecimalType) {
+            return static_cast<int>(attribute.data);
+        }
+        return attribute.string.toInt();
+    }
+
+    bool isAttribute(const XmlAttribute &attribute, quint32 id, const char *name)
+    {
+        // Attribute names are optional in the compiled XML, so they are matched by the resource ID first.
+        return attribute.id ? attribute.id == id : attribute.name == QLatin1String(name);
+    }
+
+    typedef std::function<QByteArray(const QByteArray &name)> EntryReader;
+
+    QImage loadIcon(const ResourceTable &table, const EntryReader &readEntry, quint32 id, int depth = 0)
+    {
+        // Bitmaps of the highest density are preferred. Adaptive icons are represented by their foreground.
+
+        QVector<QPair<int, QString>> candidates; // <density, path>
+        std::function<void(quint32, int)> collect = [&](quint32 resource, int level) {
+            for (const ResourceTable::Value &value : table.getValues(resource)) {
+                if (value.type == StringType) {
+                    int density = value.density;
+                    if (density == 0) {
+                        density = 160; // Default (medium) density
+                    } else if (density >= 0xFFFE) {
+                        density = 0; // Any or no density, usually an XML drawable
+                    }
+                    candidates.append(qMakePair(density, table.getString(value.data)));
+                } else if (value.type == ReferenceType && level < maxReferenceDepth) {
+                    collect(value.data, level + 1);
+                }
+            }
+        };
+        collect(id, depth);
+        std::stable_sort(candidates.begin(), candidates.end(), [](const QPair<int, QString> &a, const QPair<int, QString> &b) {
+            return a.first > b.first;
+        });
+
+        for (const auto &candidate : candidates) {
+            if (!candidate.second.endsWith(".xml")) {
+                const QImage image = QImage::fromData(readEntry(candidate.second.toUtf8()));
+                if (!image.isNull()) {
+                    return image;
+                }
+            }
+        }
+        if (depth < maxReferenceDepth) {
+            for (const auto &candidate : candidates) {
+                if (candidate.second.endsWith(".xml")) {
+                    quint32 foreground = 0;
+                    parseXml(readEntry(candidate.second.toUtf8()), [&](const QString &element, const QVector<XmlAttribute> &attributes) {
+                        if (element == "foreground") {
+                            for (const XmlAttribute &attribute : attributes) {
+                                if (isAttribute(attribute, DrawableAttribute, "drawable") && attribute.type == ReferenceType) {
+                                    foreground = attribute.data;
+                                }
+                            }
+                        }
+                    });
+                    if (foreground) {
+                        const QImage image = loadIcon(table, readEntry, foreground, depth + 1);
+                        if (!image.isNull()) {
+                            return image;
+                        }
+                    }
+                }
+            }
+        }
+        return QImage();
+    }
+}
+
+ApkInfo::ApkInfo()
+{
+    versionCode = 0;
+    minSdk = 0;
+    targetSdk = 0;
+}
+
+ApkInfo ApkInfo::read(const QString &path)
+{
+    // Reads the compiled manifest and the resource table straight from the APK, without decoding it.
+
+    ApkInfo info;
+    ZipArchive archive(path);
+    if (!archive.open()) {
+        info.error = archive.getError();
+        return info;
+    }
+    QHash<QByteArray, const ZipArchive::Entry *> entries;
+    for (const ZipArchive::Entry &entry : archive.getEntries()) {
+        entries.insert(entry.name, &entry);
+    }
+    const EntryReader readEntry = [&](const QByteArray &name) -> QByteArray {
+        const ZipArchive::Entry *entry = entries.value(name);
+        if (!entry || entry->uncompressedSize > maxEntrySize) {
+            return QByteArray();
+        }
+        QByteArray bytes;
+        bytes.reserve(static_cast<int>(entry->uncompressedSize));
+        const bool isRead = archive.read(*entry, [&](const char *data, qint64 size) {
+            bytes.append(data, static_cast<int>(size));
+        });
+        return isRead ? bytes : QByteArray();
+    };
+
+    ResourceTable table;
+    table.parse(readEntry("resources.arsc"));
+
+    quint32 iconId = 0;
+    const bool isParsed = parseXml(readEntry("AndroidManifest.xml"), [&](const QString &element, const QVector<XmlAttribute> &attributes) {
+        for (const XmlAttribute &attribute : attributes) {
+            if (element == "manifest") {
+                if (attribute.name == "package") {
+                    info.packageName = attribute.string;
+                } else if (isAttribute(attribute, VersionCodeAttribute, "versionCode")) {
+                    info.versionCode = getInteger(attribute);
+                } else if (isAttribute(attribute, VersionNameAttribute, "versionName")) {
+                    info.versionName = getString(table, attribute);
+                }
+            } else if (element == "uses-sdk") {
+                if (isAttribute(attribute, MinSdkVersionAttribute, "minSdkVersion")) {
+                    info.minSdk = getInteger(attribute);
+                } else if (isAttribute(attribute, TargetSdkVersionAttribute, "targetSdkVersion")) {
+                    info.targetSdk = getInteger(attribute);
+                }
+            } else if (element == "application") {
+                if (isAttribute(attribute, LabelAttribute, "label")) {
+                    info.applicationLabel = getString(table, attribute);
+                } else if (isAttribute(attribute, IconAttribute, "icon") && attribute.type == ReferenceType) {
+                    iconId = attribute.data;
+                }
+            }
+        }
+    });
+    if (!isParsed || info.packageName.isEmpty()) {
+        info.error = QString("Could not read the manifest of \"%1\".").arg(path);
+        return info;
+    }
+    if (iconId) {
+        info.icon = loadIcon(table, readEntry, iconId);
+    }
+    return info;
+}
+
+bool ApkInfo::isValid() const
+{
+    return error.isNull() && !packageName.isEmpty();
+}
+
+const QString &ApkInfo::getError() const
+{
+    return error;
+}
+
+const QString &ApkInfo::getPackageName() const
+{
+    return packageName;
+}
+
+const QString &ApkInfo::getApplicationLabel() const
+{
+    return applicationLabel;
+}
+
+int ApkInfo::getVersionCode() const
+{
+    return versionCode;
+}
+
+const QString &ApkInfo::getVersionName() const
+{
+    return versionName;
+}
+
+int ApkInfo::getMinSdk() const
+{
+    return minSdk;
+}
+
+int ApkInfo::getTargetSdk() const
+{
+    return targetSdk;
+}
+
+const QImage &ApkInfo::getIcon() const
+{
+    return icon;
+}
@@ -0,0 +1,35 @@
+#ifndef APKINFO_H
+#define APKINFO_H
+
+#include <QImage>
+#include <QString>
+
+class ApkInfo
+{
+public:
+    ApkInfo();
+
+    static ApkInfo read(const QString &path);
+
+    bool isValid() const;
+    const QString &getError() const;
+    const QString &getPackageName() const;
+    const QString &getApplicationLabel() const;
+    int getVersionCode() const;
+    const QString &getVersionName() const;
+    int getMinSdk() const;
+    int getTargetSdk() const;
+    const QImage &getIcon() const;
+
+private:
+    QString error;
+    QString packageName;
+    QString applicationLabel;
+    int versionCode;
+    QString versionName;
+    int minSdk;
+    int targetSdk;
+    QImage icon;
+};
+
+#endif // APKINFO_H
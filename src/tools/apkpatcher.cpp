@@ -0,0 +1,172 @@
+#include "tools/apkpatcher.h"
+#include "tools/ziparchive.h"
+#include "tools/zipwriter.h"
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QHash>
+#include <QSet>
+
+namespace
+{
+    bool isSignatureFile(const QByteArray &name)
+    {
+        // The signature of the source APK becomes invalid once it's patched (the same as "apktool build" output,
+        // the patched APK is unsigned until the signing stage).
+        if (!name.startsWith("META-INF/") || name.indexOf('/', 9) != -1) {
+            return false;
+        }
+        const QByteArray upper = name.toUpper();
+        return upper == "META-INF/MANIFEST.MF" || upper.endsWith(".SF") || upper.endsWith(".RSA") || upper.endsWith(".DSA") || upper.endsWith(".EC");
+    }
+}
+
+QString ApkPatcher::getEntryName(const QString &path)
+{
+    // Maps the path relative to the decoded contents to the name of the APK entry.
+    // Returns a null string for the files which are compiled by apktool (manifest, XML resources, smali, etc.),
+    // and for the files which can't be patched in place (nine-patch images are decoded by apktool).
+
+    if (path.startsWith("assets/") || path.startsWith("lib/")) {
+        return path;
+    }
+    if (path.startsWith("unknown/")) {
+        return path.mid(8);
+    }
+    if (path.startsWith("res/") && !path.endsWith(".xml", Qt::CaseInsensitive) && !path.endsWith(".9.png", Qt::CaseInsensitive)
+            && !path.startsWith("res/values")) {
+        return path;
+    }
+    if (!path.contains('/') && path.startsWith("classes") && path.endsWith(".dex")) {
+        return path; // Sources were not decompiled
+    }
+    return QString();
+}
+
+QByteArray ApkPatcher::getFingerprint(const QString &apk)
+{
+    // Identifies the APK which is used as a base for patching by its size, modification time and contents.
+    // Returns an empty array if the APK can't be read.
+
+    QFile file(apk);
+    if (!file.open(QFile::ReadOnly)) {
+        return QByteArray();
+    }
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    if (!hash.addData(&file)) {
+        return QByteArray();
+    }
+    const QFileInfo fileInfo(apk);
+    return QString("%1:%2:").arg(fileInfo.size()).arg(fileInfo.lastModified().toMSecsSinceEpoch()).toLatin1() + hash.result().toHex();
+}
+
+bool ApkPatcher::isPatchable(const QString &source, const QStringList &modified, const QStringList &added, const QStringList &removed)
+{
+    // Resources are referenced from "resources.arsc", so their entries can only be replaced.
+    // Assets, native libraries and unknown files can also be added or removed, as long as
+    // the added entries don't already exist in the archive (they would be duplicated).
+
+    ZipArchive archive(source);
+    if (!archive.open()) {
+        return false;
+    }
+    QSet<QByteArray> entries;
+    for (const ZipArchive::Entry &entry : archive.getEntries()) {
+        entries.insert(entry.name);
+    }
+
+    for (const QString &path : modified) {
+        const QString name = getEntryName(path);
+        if (name.isNull() || !entries.contains(name.toUtf8())) {
+            return false;
+        }
+    }
+    for (const QString &path : added + removed) {
+        const QString name = getEntryName(path);
+        if (name.isNull() || name.startsWith("res/") || name.startsWith("classes")) {
+            return false;
+        }
+    }
+    for (const QString &path : added) {
+        if (entries.contains(getEntryName(path).toUtf8())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ApkPatcher::patch(const QString &source, const QString &target, const QString &contents, const QStringList &modified, const QStringList &added, const QStringList &removed, QString *error, qint64 *written)
+{
+    // Copies the entries of the source APK as they are, except for the replaced and removed ones.
+    // Replaced entries keep their compression method; added entries are compressed.
+
+    auto fail = [=](const QString &message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+
+    QHash<QByteArray, QString> replacements;
+    for (const QString &path : modified) {
+        replacements.insert(getEntryName(path).toUtf8(), QString("%1/%2").arg(contents, path));
+    }
+    QSet<QByteArray> removals;
+    for (const QString &path : removed) {
+        removals.insert(getEntryName(path).toUtf8());
+    }
+
+    auto readFile = [](const QString &path, QByteArray *data) {
+        QFile file(path);
+        if (!file.open(QFile::ReadOnly)) {
+            return false;
+        }
+        *data = file.readAll();
+        return true;
+    };
+
+    ZipArchive archive(source);
+    if (!archive.open()) {
+        return fail(archive.getError());
+    }
+    QFile output(target);
+    if (!output.open(QFile::WriteOnly)) {
+        return fail(output.errorString());
+    }
+
+    ZipWriter writer(&output, 4);
+    for (const ZipArchive::Entry &entry : archive.getEntries()) {
+        if (removals.contains(entry.name) || isSignatureFile(entry.name)) {
+            continue;
+        }
+        if (replacements.contains(entry.name)) {
+            QByteArray data;
+            if (!readFile(replacements.value(entry.name), &data)) {
+                return fail(QString("Could not read \"%1\".").arg(replacements.value(entry.name)));
+            }
+            if (!writer.addEntry(entry.name, data, entry.method != 0)) {
+                return fail(writer.getError());
+            }
+        } else if (!writer.copyEntry(archive, entry)) {
+            return fail(writer.getError());
+        }
+    }
+    for (const QString &path : added) {
+        QByteArray data;
+        if (!readFile(QString("%1/%2").arg(contents, path), &data)) {
+            return fail(QString("Could not read \"%1/%2\".").arg(contents, path));
+        }
+        // Native libraries are stored, so that they can be loaded directly from the APK:
+        const bool compress = !path.startsWith("lib/");
+        if (!writer.addEntry(getEntryName(path).toUtf8(), data, compress)) {
+            return fail(writer.getError());
+        }
+    }
+    if (!writer.finish(archive.getComment())) {
+        return fail(writer.getError());
+    }
+    if (written) {
+        *written = writer.getPosition();
+    }
+    return true;
+}
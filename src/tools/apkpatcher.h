@@ -0,0 +1,15 @@
+#ifndef APKPATCHER_H
+#define APKPATCHER_H
+
+#include <QStringList>
+
+class ApkPatcher
+{
+public:
+    static QString getEntryName(const QString &path);
+    static QByteArray getFingerprint(const QString &apk);
+    static bool isPatchable(const QString &source, const QStringList &modified, const QStringList &added, const QStringList &removed);
+    static bool patch(const QString &source, const QString &target, const QString &contents, const QStringList &modified, const QStringList &added, const QStringList &removed, QString *error = nullptr, qint64 *written = nullptr);
+};
+
+#endif // APKPATCHER_H
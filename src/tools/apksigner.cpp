@@ -1,5 +1,143 @@
 #include "tools/apksigner.h"
+#include "tools/der.h"
+#include "tools/signingkey.h"
+#include "tools/zipalign.h"
+#include "tools/ziparchive.h"
+#include "tools/zipwriter.h"
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QSharedPointer>
 #include <QStringList>
+#include <QThread>
+#include <QtConcurrent/QtConcurrent>
+
+namespace
+{
+    const int chunkSize = 1024 * 1024; // APK Signature Scheme v2 content chunk size
+
+    QByteArray uint32(quint32 value)
+    {
+        QByteArray bytes(4, '\0');
+        ZipArchive::writeUInt32(reinterpret_cast<uchar *>(bytes.data()), value);
+        return bytes;
+    }
+
+    QByteArray uint64(quint64 value)
+    {
+        return uint32(static_cast<quint32>(value)) + uint32(static_cast<quint32>(value >> 32));
+    }
+
+    QByteArray prefixed(const QByteArray &data)
+    {
+        return uint32(static_cast<quint32>(data.size())) + data;
+    }
+
+    QByteArray digestChunk(const QByteArray &chunk)
+    {
+        QCryptographicHash hash(QCryptographicHash::Sha256);
+        hash.addData("\xA5", 1);
+        hash.addData(uint32(static_cast<quint32>(chunk.size())));
+        hash.addData(chunk);
+        return hash.result();
+    }
+
+    QByteArray digestEntry(const ZipArchive *archive, const ZipArchive::Entry &entry)
+    {
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        const bool isRead = archive->read(entry, [&](const char *data, qint64 size) {
+            hash.addData(data, static_cast<int>(size));
+        });
+        return isRead ? hash.result() : QByteArray();
+    }
+
+    bool isSignatureFile(const QByteArray &name)
+    {
+        const QByteArray upper = name.toUpper();
+        if (!upper.startsWith("META-INF/") || upper.indexOf('/', 9) != -1) {
+            return false;
+        }
+        const QByteArray file = upper.mid(9);
+        return file == "MANIFEST.MF" || file.startsWith("SIG-")
+            || file.endsWith(".SF") || file.endsWith(".RSA") || file.endsWith(".DSA") || file.endsWith(".EC");
+    }
+
+    QByteArray manifestLine(const QByteArray &line)
+    {
+        // Manifest lines are limited to 72 bytes; continuation lines start with a space.
+        // Multi-byte UTF-8 sequences are not split.
+        QByteArray result;
+        int start = 0;
+        int limit = 72;
+        while (line.size() - start > limit) {
+            int end = start + limit;
+            while (end > start + 1 && (static_cast<quint8>(line.at(end)) & 0xC0) == 0x80) {
+                --end;
+            }
+            result.append(line.mid(start, end - start) + "\r\n ");
+            start = end;
+            limit = 71;
+        }
+        return result + line.mid(start) + "\r\n";
+    }
+
+    class ChunkDigests
+    {
+    public:
+        // Splits the appended data into 1 MiB chunks which are hashed in the thread pool.
+
+        ChunkDigests()
+        {
+            limit = qMax(2, QThread::idealThreadCount() * 2);
+        }
+
+        void append(const char *data, qint64 size)
+        {
+            while (size > 0) {
+                const int count = static_cast<int>(qMin<qint64>(size, chunkSize - chunk.size()));
+                chunk.append(data, count);
+                data += count;
+                size -= count;
+                if (chunk.size() == chunkSize) {
+                    submit();
+                }
+            }
+        }
+
+        void append(const QByteArray &data)
+        {
+            append(data.constData(), data.size());
+        }
+
+        QList<QByteArray> finish()
+        {
+            if (!chunk.isEmpty()) {
+                submit();
+            }
+            while (!pending.isEmpty()) {
+                digests.append(pending.takeFirst().result());
+            }
+            return digests;
+        }
+
+    private:
+        void submit()
+        {
+            // The number of pending chunks is limited, so that the memory use does not depend on the archive size.
+            while (pending.size() >= limit) {
+                digests.append(pending.takeFirst().result());
+            }
+            pending.append(QtConcurrent::run(&digestChunk, chunk));
+            chunk = QByteArray();
+            chunk.reserve(chunkSize);
+        }
+
+        QByteArray chunk;
+        QList<QFuture<QByteArray>> pending;
+        QList<QByteArray> digests;
+        int limit;
+    };
+}
 
 void Apksigner::sign(const QString &target, const Keystore *keystore)
 {
@@ -13,6 +151,230 @@ void Apksigner::sign(const QString &target, const QString &keystorePath, const Q
         return;
     }
 
+    signNatively(target, keystorePath, keystorePassword, keyAlias, keyPassword, [=]() {
+        signExternally(target, keystorePath, keystorePassword, keyAlias, keyPassword);
+    });
+}
+
+void Apksigner::alignAndSign(const QString &target, const Keystore *keystore, const QString &zipalign)
+{
+    // The native signer aligns the archive as it writes it, so the APK is written once.
+    // The fallback aligns the APK with Zipalign before signing it with the apksigner jar.
+
+    if (target.isEmpty()) {
+        emit error("Apksigner: Target path not specified.");
+        return;
+    }
+
+    const QString keystorePath = keystore->keystorePath;
+    const QString keystorePassword = keystore->keystorePassword;
+    const QString keyAlias = keystore->keyAlias;
+    const QString keyPassword = keystore->keyPassword;
+    signNatively(target, keystorePath, keystorePassword, keyAlias, keyPassword, [=]() {
+        Zipalign *aligner = new Zipalign(zipalign, this);
+        connect(aligner, &Executable::success, this, [=]() {
+            signExternally(target, keystorePath, keystorePassword, keyAlias, keyPassword);
+        });
+        connect(aligner, &Executable::error, this, [=](const QString &message) {
+            emit error(message);
+            emit finished();
+        });
+        connect(aligner, &Executable::finished, aligner, &QObject::deleteLater);
+        aligner->align(target);
+    });
+}
+
+void Apksigner::signNatively(const QString &target, const QString &keystorePath, const QString &keystorePassword, const QString &keyAlias, const QString &keyPassword, const std::function<void()> &fallback)
+{
+    // The archive is signed (and aligned) in a worker thread; the fallback is called if the native signing fails.
+
+    QSharedPointer<qint64> written(new qint64(0));
+    auto watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, [=]() {
+        const QString errorString = watcher->result();
+        watcher->deleteLater();
+        if (isCancelled()) {
+            emitCancelled();
+        } else if (errorString.isNull()) {
+            setBytesWritten(*written);
+            emit success(QString());
+            emit finished();
+        } else {
+            qWarning("Native signing failed (%s), falling back to apksigner.", qUtf8Printable(errorString));
+            fallback();
+        }
+    });
+    watcher->setFuture(QtConcurrent::run([=]() -> QString {
+        SigningKey key;
+        if (!key.load(keystorePath, keystorePassword, keyAlias, keyPassword)) {
+            return key.getError();
+        }
+        const QString tempApk = target + ".signed";
+        QString errorString;
+        if (!signArchive(target, tempApk, key, 4, &errorString, written.data())) {
+            QFile::remove(tempApk);
+            return errorString.isNull() ? QString("") : errorString;
+        }
+        QFile::remove(target);
+        if (!QFile::rename(tempApk, target)) {
+            return QString("Could not replace \"%1\".").arg(target);
+        }
+        return QString();
+    }));
+}
+
+bool Apksigner::signArchive(const QString &source, const QString &target, const SigningKey &key, int alignment, QString *error, qint64 *written)
+{
+    // Writes the signed archive in a single pass: the entries are copied (and aligned) while their v1 (JAR) digests
+    // are computed in the thread pool, followed by the v1 signature files, the APK Signature Scheme v2 block,
+    // the central directory and the end of central directory record. The v2 digests of the written data
+    // are computed in 1 MiB chunks on the fly. Existing v1 signature files are dropped.
+
+    auto fail = [=](const QString &message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    };
+
+    ZipArchive archive(source);
+    if (!archive.open()) {
+        return fail(archive.getError());
+    }
+    QFile output(target);
+    if (!output.open(QFile::WriteOnly)) {
+        return fail(output.errorString());
+    }
+
+    QVector<ZipArchive::Entry> entries;
+    QList<QFuture<QByteArray>> entryDigests;
+    for (const ZipArchive::Entry &entry : archive.getEntries()) {
+        if (!isSignatureFile(entry.name)) {
+            entries.append(entry);
+            if (!entry.name.endsWith('/')) {
+                entryDigests.append(QtConcurrent::run(&digestEntry, &archive, entry));
+            }
+        }
+    }
+
+    ChunkDigests contentsDigests;
+    ZipWriter writer(&output, alignment);
+    writer.setObserver([&](const char *data, qint64 size) {
+        contentsDigests.append(data, size);
+    });
+    bool isWritten = true;
+    for (const ZipArchive::Entry &entry : entries) {
+        if (!writer.copyEntry(archive, entry)) {
+            isWritten = false;
+            break;
+        }
+    }
+    for (QFuture<QByteArray> &future : entryDigests) {
+        future.waitForFinished(); // The digest jobs refer to the archive
+    }
+    if (!isWritten) {
+        return fail(writer.getError());
+    }
+
+    // JAR signature (v1):
+
+    const QByteArray createdBy = QByteArray("Created-By: 1.0 (") + APPLICATION + ")\r\n";
+    QByteArray manifest = "Manifest-Version: 1.0\r\n" + createdBy + "\r\n";
+    QByteArray signatureFileSections;
+    int digestIndex = 0;
+    for (const ZipArchive::Entry &entry : entries) {
+        if (entry.name.endsWith('/')) {
+            continue;
+        }
+        const QByteArray digest = entryDigests.at(digestIndex++).result();
+        if (digest.isNull()) {
+            return fail(QString("Could not read \"%1\".").arg(QString::fromUtf8(entry.name)));
+        }
+        const QByteArray name = manifestLine("Name: " + entry.name);
+        const QByteArray section = name + "SHA1-Digest: " + digest.toBase64() + "\r\n\r\n";
+        manifest.append(section);
+        signatureFileSections.append(name + "SHA1-Digest: " + QCryptographicHash::hash(section, QCryptographicHash::Sha1).toBase64() + "\r\n\r\n");
+    }
+    const QByteArray signatureFile = "Signature-Version: 1.0\r\n" + createdBy
+        + "SHA1-Digest-Manifest: " + QCryptographicHash::hash(manifest, QCryptographicHash::Sha1).toBase64() + "\r\n"
+        + "X-Android-APK-Signed: 2\r\n\r\n"
+        + signatureFileSections;
+
+    const QByteArray jarSignature = key.sign(signatureFile, SigningKey::Sha1);
+    if (jarSignature.isEmpty()) {
+        return fail("Could not sign the JAR signature file.");
+    }
+    QByteArray certificates;
+    for (const QByteArray &certificate : key.getCertificates()) {
+        certificates.append(certificate);
+    }
+    const QByteArray sha1Algorithm = Der::encode(Der::Sequence, Der::oid("1.3.14.3.2.26") + Der::null());
+    const QByteArray rsaAlgorithm = Der::encode(Der::Sequence, Der::oid("1.2.840.113549.1.1.1") + Der::null());
+    const QByteArray signerInfo = Der::encode(Der::Sequence, Der::integer(1) + key.getIssuerAndSerialNumber()
+        + sha1Algorithm + rsaAlgorithm + Der::encode(Der::OctetString, jarSignature));
+    const QByteArray signedData = Der::encode(Der::Sequence, Der::integer(1)
+        + Der::encode(Der::Set, sha1Algorithm)
+        + Der::encode(Der::Sequence, Der::oid("1.2.840.113549.1.7.1"))
+        + Der::encode(Der::ContextSpecific, certificates)
+        + Der::encode(Der::Set, signerInfo));
+    const QByteArray signatureBlock = Der::encode(Der::Sequence, Der::oid("1.2.840.113549.1.7.2") + Der::encode(Der::ContextSpecific, signedData));
+
+    if (!writer.addEntry("META-INF/MANIFEST.MF", manifest)
+            || !writer.addEntry("META-INF/CERT.SF", signatureFile)
+            || !writer.addEntry("META-INF/CERT.RSA", signatureBlock)) {
+        return fail(writer.getError());
+    }
+    writer.setObserver(nullptr);
+
+    // APK Signature Scheme v2. The central directory offset in the digested end of central directory record
+    // points at the APK Signing Block, i.e., the end of the entries written so far.
+
+    const QByteArray end = writer.getEndOfCentralDirectory(writer.getPosition(), archive.getComment());
+    if (end.isNull()) {
+        return fail("ZIP64 archives are not supported.");
+    }
+    ChunkDigests centralDirectoryDigests;
+    ChunkDigests endDigests;
+    centralDirectoryDigests.append(writer.getCentralDirectory());
+    endDigests.append(end);
+    const QList<QByteArray> chunkDigests = contentsDigests.finish() + centralDirectoryDigests.finish() + endDigests.finish();
+
+    QCryptographicHash contentsHash(QCryptographicHash::Sha256);
+    contentsHash.addData("\x5A", 1);
+    contentsHash.addData(uint32(static_cast<quint32>(chunkDigests.size())));
+    for (const QByteArray &digest : chunkDigests) {
+        contentsHash.addData(digest);
+    }
+
+    const quint32 algorithm = 0x0103; // RSASSA-PKCS1-v1_5 with SHA2-256
+    QByteArray encodedCertificates;
+    for (const QByteArray &certificate : key.getCertificates()) {
+        encodedCertificates.append(prefixed(certificate));
+    }
+    const QByteArray signerData = prefixed(prefixed(uint32(algorithm) + prefixed(contentsHash.result())))
+        + prefixed(encodedCertificates)
+        + prefixed(QByteArray()); // Additional attributes
+    const QByteArray signature = key.sign(signerData, SigningKey::Sha256);
+    if (signature.isEmpty()) {
+        return fail("Could not sign the APK signer data.");
+    }
+    const QByteArray signer = prefixed(signerData) + prefixed(prefixed(uint32(algorithm) + prefixed(signature))) + prefixed(key.getPublicKey());
+    const QByteArray value = prefixed(prefixed(signer));
+    const QByteArray pair = uint64(4 + static_cast<quint64>(value.size())) + uint32(0x7109871A) + value;
+    const quint64 blockSize = static_cast<quint64>(pair.size()) + 8 + 16;
+    const QByteArray block = uint64(blockSize) + pair + uint64(blockSize) + "APK Sig Block 42";
+
+    if (!writer.write(block) || !writer.finish(archive.getComment())) {
+        return fail(writer.getError());
+    }
+    if (written) {
+        *written = writer.getPosition();
+    }
+    return true;
+}
+
+void Apksigner::signExternally(const QString &target, const QString &keystorePath, const QString &keystorePassword, const QString &keyAlias, const QString &keyPassword)
+{
     QStringList arguments;
     arguments << "sign";
     arguments << "--ks" << keystorePath;
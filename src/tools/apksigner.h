@@ -3,6 +3,9 @@
 
 #include "tools/jar.h"
 #include "tools/keystore.h"
+#include <functional>
+
+class SigningKey;
 
 class Apksigner : public Jar
 {
@@ -11,7 +14,14 @@ public:
 
     void sign(const QString &target, const Keystore *keystore);
     void sign(const QString &target, const QString &keystorePath, const QString &keystorePassword, const QString &keyAlias, const QString &keyPassword);
+    void alignAndSign(const QString &target, const Keystore *keystore, const QString &zipalign);
     QString version() const;
+
+    static bool signArchive(const QString &source, const QString &target, const SigningKey &key, int alignment, QString *error = nullptr, qint64 *written = nullptr);
+
+private:
+    void signNatively(const QString &target, const QString &keystorePath, const QString &keystorePassword, const QString &keyAlias, const QString &keyPassword, const std::function<void()> &fallback);
+    void signExternally(const QString &target, const QString &keystorePath, const QString &keystorePassword, const QString &keyAlias, const QString &keyPassword);
 };
 
 #endif // APKSIGNER_H
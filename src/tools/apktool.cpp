@@ -1,4 +1,5 @@
 #include "tools/apktool.h"
+#include <QPointer>
 #include <QStringList>
 #include <QtConcurrent/QtConcurrent>
 #include "base/application.h"
@@ -38,9 +39,53 @@ void Apktool::run(const QString &action, const QString &source, const QString &d
     arguments << "--force";
     if (!frameworks.isEmpty()) { arguments << "--frame-path" << frameworks; }
     if (!resources) { arguments << "--no-res"; }
+    // Without the decoded resources, the manifest is still decoded to be editable (requires apktool 2.5.0+):
+    if (!resources && action == "decode") { arguments << "--force-manifest"; }
     if (!sources) { arguments << "--no-src"; }
 
-    Jar::startAsync(arguments);
+    // Reuse the warm apktool JVM if it's available, otherwise start a one-shot process:
+
+    QPointer<Apktool> self(this);
+    isDaemonRequest = true;
+    const bool submitted = app->apktoolDaemon.submit(jar, arguments, [=](ApktoolDaemon::Outcome outcome, const QString &output) {
+        if (!self) {
+            return;
+        }
+        isDaemonRequest = false;
+        switch (outcome) {
+        case ApktoolDaemon::Succeeded:
+            emit success(output);
+            emit finished();
+            break;
+        case ApktoolDaemon::Failed:
+            emit error(output);
+            emit finished();
+            break;
+        case ApktoolDaemon::Crashed:
+            Jar::startAsync(arguments);
+            break;
+        }
+    }, [=](const QString &line) {
+        if (self) {
+            emit output(line);
+        }
+    });
+    if (!submitted) {
+        isDaemonRequest = false;
+        Jar::startAsync(arguments);
+    }
+}
+
+void Apktool::cancel(const QString &reason)
+{
+    // The daemon serves a single request at a time, so the running request is the one of this instance.
+    // The daemon reports it as crashed and the cancellation is then emitted instead of the one-shot retry.
+
+    Jar::cancel(reason);
+    if (isDaemonRequest) {
+        isDaemonRequest = false;
+        app->apktoolDaemon.cancel();
+    }
 }
 
 void Apktool::reset() const
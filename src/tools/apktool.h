@@ -6,15 +6,18 @@
 class Apktool : public Jar
 {
 public:
-    explicit Apktool(const QString &jar, QObject *parent = nullptr) : Jar(jar, parent) {}
+    explicit Apktool(const QString &jar, QObject *parent = nullptr) : Jar(jar, parent), isDaemonRequest(false) {}
 
     void build(const QString &source, const QString &destination, const QString &frameworks, bool resources, bool sources);
     void decode(const QString &source, const QString &destination, const QString &frameworks, bool resources, bool sources);
     QString version() const;
     void reset() const;
+    void cancel(const QString &reason) override;
 
 private:
     void run(const QString &action, const QString &source, const QString &destination, const QString &frameworks, bool resources, bool sources);
+
+    bool isDaemonRequest;
 };
 
 #endif // APKTOOL_H
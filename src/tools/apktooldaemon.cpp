@@ -0,0 +1,223 @@
+#include "tools/apktooldaemon.h"
+#include "base/application.h"
+#include <QFile>
+
+namespace
+{
+    const int crashLimit = 3; // The daemon is not restarted after this number of unexpected exits
+}
+
+ApktoolDaemon::ApktoolDaemon(QObject *parent) : QObject(parent)
+{
+    state = Stopped;
+    crashes = 0;
+    isSecurityManagerAllowed = false;
+
+    process.setStandardErrorFile(QProcess::nullDevice());
+
+    connect(&process, &QProcess::readyReadStandardOutput, this, &ApktoolDaemon::read);
+
+    connect(&process, static_cast<void (QProcess::*)(QProcess::ProcessError)>(&QProcess::error), [=](QProcess::ProcessError processError) {
+        if (processError == QProcess::FailedToStart) {
+            crashes = crashLimit;
+            fail();
+        }
+    });
+
+    connect(&process, static_cast<void (QProcess::*)(int)>(&QProcess::finished), [=]() {
+        // Unexpected exit: the JVM is unable to launch the daemon (e.g., Java < 11) or apktool has forced the exit.
+        // A daemon which can't trap the exit calls reports it on startup instead, see read().
+        if (state == Starting || state == Idle || state == Busy) {
+            if (state == Starting) {
+                crashes = crashLimit;
+            }
+            fail();
+        }
+    });
+}
+
+ApktoolDaemon::~ApktoolDaemon()
+{
+    stop();
+}
+
+bool ApktoolDaemon::submit(const QString &jar, const QStringList &arguments, const Callback &callback, const Progress &progress)
+{
+    // A single request is served at a time; concurrent requests should fall back to one-shot processes.
+    // Returns true if the request is accepted, in which case the callback is called exactly once.
+
+    if (state == Unavailable || state == Starting || state == Busy) {
+        return false;
+    }
+    for (const QString &argument : arguments) {
+        if (argument.contains('\t') || argument.contains('\n')) {
+            return false;
+        }
+    }
+    if (state == Idle && jar != this->jar) {
+        stop();
+    }
+
+    this->arguments = arguments;
+    this->callback = callback;
+    this->progress = progress;
+    if (state == Stopped) {
+        start(jar);
+    } else {
+        send();
+    }
+    return true;
+}
+
+void ApktoolDaemon::cancel()
+{
+    // Aborts the running request by killing the daemon, which is started again for the next request.
+    // The request is reported as crashed, but it does not count towards the crash limit.
+
+    if (state != Starting && state != Busy) {
+        return;
+    }
+    const Callback pending = callback;
+    callback = nullptr;
+    progress = nullptr;
+    state = Stopped;
+    buffer.clear();
+    process.kill();
+    process.waitForFinished();
+    if (pending) {
+        pending(Crashed, QString());
+    }
+}
+
+void ApktoolDaemon::start(const QString &jar)
+{
+    // The daemon is launched from the class compiled on deploy, if it's available, and from the source otherwise
+    // (Java 11+). The security manager is allowed explicitly only after the JVM has refused the exit trap,
+    // as older JVMs (Java 11) would take "allow" for the name of the security manager class.
+
+    this->jar = jar;
+    state = Starting;
+    buffer.clear();
+    QStringList arguments;
+    if (isSecurityManagerAllowed) {
+        arguments << "-Djava.security.manager=allow";
+    }
+    const QString directory = app->getSharedPath("tools");
+    if (QFile::exists(directory + "/ApktoolDaemon.class")) {
+#ifdef Q_OS_WIN
+        const QString separator = ";";
+#else
+        const QString separator = ":";
+#endif
+        arguments << "-cp" << jar + separator + directory << "ApktoolDaemon";
+    } else {
+        arguments << "-cp" << jar << directory + "/ApktoolDaemon.java";
+    }
+    process.start("java", arguments);
+}
+
+void ApktoolDaemon::stop()
+{
+    callback = nullptr;
+    progress = nullptr;
+    state = Stopped;
+    if (process.state() != QProcess::NotRunning) {
+        process.closeWriteChannel();
+        if (!process.waitForFinished(2000)) {
+            process.kill();
+            process.waitForFinished();
+        }
+    }
+}
+
+void ApktoolDaemon::send()
+{
+    state = Busy;
+    process.write(arguments.join('\t').toUtf8() + '\n');
+}
+
+void ApktoolDaemon::read()
+{
+    buffer.append(process.readAllStandardOutput());
+
+    if (state == Starting) {
+        const int newline = buffer.indexOf('\n');
+        if (newline < 0) {
+            return;
+        }
+        const QByteArray banner = buffer.left(newline).trimmed();
+        buffer.remove(0, newline + 1);
+        if (banner.startsWith("NO-EXIT-TRAP") && !isSecurityManagerAllowed) {
+            // Java 18+: the daemon is started again with the security manager allowed.
+            isSecurityManagerAllowed = true;
+            state = Stopped;
+            process.kill();
+            process.waitForFinished();
+            start(jar);
+            return;
+        }
+        if (banner != "READY") {
+            qWarning("Apktool daemon could not be started: %s", banner.constData());
+            crashes = crashLimit;
+            fail();
+            process.kill();
+            return;
+        }
+        send();
+    }
+
+    if (state == Busy) {
+        // Output lines are forwarded as ">line\n" while the request is running.
+        // Response: "<exit code>\t<output length>\n<output>"
+        while (buffer.startsWith('>')) {
+            const int newline = buffer.indexOf('\n');
+            if (newline < 0) {
+                return;
+            }
+            const QString line = QString::fromUtf8(buffer.mid(1, newline - 1)).remove('\r');
+            buffer.remove(0, newline + 1);
+            if (progress) {
+                progress(line);
+            }
+        }
+        const int newline = buffer.indexOf('\n');
+        if (newline < 0) {
+            return;
+        }
+        const QList<QByteArray> header = buffer.left(newline).trimmed().split('\t');
+        bool isValid = header.size() == 2;
+        const int status = isValid ? header.at(0).toInt(&isValid) : -1;
+        const int length = isValid ? header.at(1).toInt(&isValid) : -1;
+        if (!isValid || length < 0) {
+            fail();
+            process.kill();
+            return;
+        }
+        if (buffer.size() < newline + 1 + length) {
+            return;
+        }
+        const QString output = QString::fromUtf8(buffer.mid(newline + 1, length)).replace("\r\n", "\n").trimmed();
+        buffer.remove(0, newline + 1 + length);
+
+        state = Idle;
+        const Callback finished = callback;
+        callback = nullptr;
+        progress = nullptr;
+        finished(status == 0 ? Succeeded : Failed, output);
+    }
+}
+
+void ApktoolDaemon::fail()
+{
+    const Callback pending = callback;
+    callback = nullptr;
+    progress = nullptr;
+    buffer.clear();
+    state = (++crashes < crashLimit) ? Stopped : Unavailable;
+    if (state == Unavailable) {
+        qWarning("Apktool daemon is unavailable, falling back to one-shot processes.");
+    }
+    if (pending) {
+        pending(Crashed, QString());
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef APKTOOLDAEMON_H
+#define APKTOOLDAEMON_H
+
+#include <QProcess>
+#include <functional>
+
+class ApktoolDaemon : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Outcome {
+        Succeeded,
+        Failed,
+        Crashed // The request should be repeated with a one-shot process
+    };
+
+    typedef std::function<void(Outcome outcome, const QString &output)> Callback;
+    typedef std::function<void(const QString &line)> Progress;
+
+    explicit ApktoolDaemon(QObject *parent = nullptr);
+    ~ApktoolDaemon() override;
+
+    bool submit(const QString &jar, const QStringList &arguments, const Callback &callback, const Progress &progress = nullptr);
+    void cancel();
+
+private:
+    enum State {
+        Stopped,
+        Starting,
+        Idle,
+        Busy,
+        Unavailable
+    };
+
+    void start(const QString &jar);
+    void stop();
+    void send();
+    void read();
+    void fail();
+
+    QProcess process;
+    State state;
+    QString jar;
+    QByteArray buffer;
+    QStringList arguments;
+    Callback callback;
+    Progress progress;
+    int crashes;
+    bool isSecurityManagerAllowed; // Set once the JVM refused the exit trap (Java 18+)
+};
+
+#endif // APKTOOLDAEMON_H
@@ -0,0 +1,141 @@
+#include "tools/der.h"
+#include <QList>
+
+Der::Reader::Reader(const QByteArray &data) : data(data)
+{
+    position = 0;
+}
+
+bool Der::Reader::atEnd() const
+{
+    return position >= data.size();
+}
+
+bool Der::Reader::read(quint8 *tag, QByteArray *content, QByteArray *element)
+{
+    const int start = position;
+    int offset = position;
+    if (offset + 2 > data.size()) {
+        return false;
+    }
+    const quint8 type = static_cast<quint8>(data.at(offset++));
+    if ((type & 0x1F) == 0x1F) {
+        return false; // Multi-byte tags are not supported
+    }
+    qint64 length = static_cast<quint8>(data.at(offset++));
+    if (length & 0x80) {
+        const int count = length & 0x7F;
+        if (count < 1 || count > 4 || offset + count > data.size()) {
+            return false;
+        }
+        length = 0;
+        for (int i = 0; i < count; ++i) {
+            length = (length << 8) | static_cast<quint8>(data.at(offset++));
+        }
+    }
+    if (offset + length > data.size()) {
+        return false;
+    }
+    position = offset + static_cast<int>(length);
+    if (tag) {
+        *tag = type;
+    }
+    if (content) {
+        *content = data.mid(offset, static_cast<int>(length));
+    }
+    if (element) {
+        *element = data.mid(start, position - start);
+    }
+    return true;
+}
+
+bool Der::Reader::read(quint8 expectedTag, QByteArray *content, QByteArray *element)
+{
+    const int start = position;
+    quint8 tag;
+    if (!read(&tag, content, element) || tag != expectedTag) {
+        position = start;
+        return false;
+    }
+    return true;
+}
+
+bool Der::Reader::skip()
+{
+    return read(nullptr, nullptr);
+}
+
+QByteArray Der::encode(quint8 tag, const QByteArray &content)
+{
+    QByteArray result;
+    result.append(static_cast<char>(tag));
+    const int length = content.size();
+    if (length < 0x80) {
+        result.append(static_cast<char>(length));
+    } else {
+        QByteArray bytes;
+        for (int value = length; value > 0; value >>= 8) {
+            bytes.prepend(static_cast<char>(value & 0xFF));
+        }
+        result.append(static_cast<char>(0x80 | bytes.size()));
+        result.append(bytes);
+    }
+    return result + content;
+}
+
+QByteArray Der::integer(const QByteArray &value)
+{
+    // Encodes an unsigned big-endian integer.
+    QByteArray content = magnitude(value);
+    if (content.isEmpty() || (static_cast<quint8>(content.at(0)) & 0x80)) {
+        content.prepend('\0');
+    }
+    return encode(Integer, content);
+}
+
+QByteArray Der::integer(int value)
+{
+    QByteArray bytes;
+    for (quint32 remainder = static_cast<quint32>(qMax(0, value)); remainder > 0; remainder >>= 8) {
+        bytes.prepend(static_cast<char>(remainder & 0xFF));
+    }
+    return integer(bytes);
+}
+
+QByteArray Der::oid(const QByteArray &dotted)
+{
+    QList<quint64> arcs;
+    for (const QByteArray &arc : dotted.split('.')) {
+        arcs.append(arc.toULongLong());
+    }
+    if (arcs.size() < 2) {
+        return QByteArray();
+    }
+    arcs[1] += arcs.takeFirst() * 40;
+
+    QByteArray content;
+    for (quint64 arc : arcs) {
+        QByteArray bytes;
+        bytes.prepend(static_cast<char>(arc & 0x7F));
+        while (arc >>= 7) {
+            bytes.prepend(static_cast<char>(0x80 | (arc & 0x7F)));
+        }
+        content.append(bytes);
+    }
+    return encode(ObjectIdentifier, content);
+}
+
+QByteArray Der::null()
+{
+    return encode(Null, QByteArray());
+}
+
+QByteArray Der::magnitude(const QByteArray &integerContent)
+{
+    // Strips the leading zeros (including the sign byte) of a big-endian integer.
+    int start = 0;
+    while (start < integerContent.size() && integerContent.at(start) == '\0') {
+        ++start;
+    }
+    return integerContent.mid(start);
+}
@@ -0,0 +1,47 @@
+#ifndef DER_H
+#define DER_H
+
+#include <QByteArray>
+
+// Minimal ASN.1 DER encoder and decoder (single-byte tags, definite lengths).
+
+class Der
+{
+public:
+    enum Tag : quint8 {
+        Integer = 0x02,
+        BitString = 0x03,
+        OctetString = 0x04,
+        Null = 0x05,
+        ObjectIdentifier = 0x06,
+        BmpString = 0x1E,
+        Sequence = 0x30,
+        Set = 0x31,
+        ContextSpecific = 0xA0
+    };
+
+    class Reader
+    {
+    public:
+        explicit Reader(const QByteArray &data);
+
+        bool atEnd() const;
+        bool read(quint8 *tag, QByteArray *content, QByteArray *element = nullptr);
+        bool read(quint8 expectedTag, QByteArray *content, QByteArray *element = nullptr);
+        bool skip();
+
+    private:
+        QByteArray data;
+        int position;
+    };
+
+    static QByteArray encode(quint8 tag, const QByteArray &content);
+    static QByteArray integer(const QByteArray &value);
+    static QByteArray integer(int value);
+    static QByteArray oid(const QByteArray &dotted);
+    static QByteArray null();
+
+    static QByteArray magnitude(const QByteArray &integerContent);
+};
+
+#endif // DER_H
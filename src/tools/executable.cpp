@@ -1,8 +1,12 @@
 #include "tools/executable.h"
 #include <QDebug>
+#include <QTimer>
 
 Executable::Executable(QObject *parent) : QObject(parent)
 {
+    timeout = 0;
+    bytesWritten = -1;
+
 #ifndef Q_OS_OSX
     const int processKillCode = 0xF291; // Windows kill code (Qt magic number)
 #else
@@ -21,17 +25,39 @@ Executable::Executable(QObject *parent) : QObject(parent)
         }
     });
 
+    // The output is streamed line by line; only its tail is retained in memory for the final message.
+
+    connect(&process, &QProcess::readyReadStandardOutput, [=]() {
+        read(standardOutput, process.readAllStandardOutput());
+    });
+
+    connect(&process, &QProcess::readyReadStandardError, [=]() {
+        read(standardError, process.readAllStandardError());
+    });
+
     connect(&process, static_cast<void (QProcess::*)(int)>(&QProcess::finished), [=]() {
-        const QString output =
-            process.readAllStandardOutput().replace("\r\n", "\n").trimmed() +
-            process.readAllStandardError().replace("\r\n", "\n").trimmed();
+        read(standardOutput, process.readAllStandardOutput());
+        read(standardError, process.readAllStandardError());
+        for (const QString &line : standardOutput.flush() + standardError.flush()) {
+            emit output(line);
+        }
+        const QString message = standardOutput.getText().trimmed() + standardError.getText().trimmed();
+        standardOutput.clear();
+        standardError.clear();
         const int exitCode = process.exitCode();
-        if (exitCode == 0 && process.exitStatus() == QProcess::NormalExit) {
-            emit success(output);
+        if (isCancelled()) {
+            emit error(cancelReason);
+        } else if (exitCode == 0 && process.exitStatus() == QProcess::NormalExit) {
+            const QString failure = complete();
+            if (failure.isNull()) {
+                emit success(message);
+            } else {
+                emit error(failure);
+            }
         } else if (exitCode == processKillCode && process.exitStatus() == QProcess::CrashExit) {
             // Process killed
         } else {
-            emit error(output);
+            emit error(message);
         }
         emit finished();
     });
@@ -42,8 +68,50 @@ Executable::Executable(const QString &executable, QObject *parent) : Executable(
     this->executable = executable;
 }
 
+void Executable::cancel(const QString &reason)
+{
+    // The process is asked to terminate and is killed if it is still running after the grace period.
+    // The "error" signal with the given reason is emitted once the process is finished.
+
+    if (isCancelled()) {
+        return;
+    }
+    cancelReason = reason.isEmpty() ? QString("Cancelled.") : reason;
+    if (process.state() != QProcess::NotRunning) {
+        process.terminate();
+        QTimer::singleShot(3000, &process, [=]() {
+            if (process.state() != QProcess::NotRunning) {
+                process.kill();
+            }
+        });
+    }
+}
+
+void Executable::setTimeout(int seconds)
+{
+    // Applies to the synchronous calls. Zero stands for no timeout.
+    timeout = seconds;
+}
+
+qint64 Executable::getBytesWritten() const
+{
+    // Bytes written to disk by the native implementation; -1 if they were not measured (e.g., written by the external tool).
+    return bytesWritten;
+}
+
+void Executable::setBytesWritten(qint64 bytes)
+{
+    bytesWritten = bytes;
+}
+
 void Executable::startAsync(const QStringList &arguments)
 {
+    if (isCancelled()) {
+        emitCancelled();
+        return;
+    }
+    standardOutput.clear();
+    standardError.clear();
     process.start(executable, arguments);
 }
 
@@ -57,7 +125,13 @@ Result<QString> Executable::startSync(const QStringList &arguments) const
         return Result<QString>(false, error);
     }
 
-    if (!process.waitForFinished(-1)) {
+    if (!process.waitForFinished(timeout > 0 ? timeout * 1000 : -1)) {
+        if (process.state() != QProcess::NotRunning) {
+            process.kill();
+            process.waitForFinished();
+            const QString error = QString("\"%1\" timed out after %2 s.").arg(executable).arg(timeout);
+            return Result<QString>(false, error);
+        }
         const QString error = process.readAllStandardError().replace("\r\n", "\n").trimmed();
         return Result<QString>(false, error);
     }
@@ -73,3 +147,28 @@ Result<QString> Executable::startSync(const QStringList &arguments) const
         process.readAllStandardError().replace("\r\n", "\n").trimmed();
     return Result<QString>(true, output);
 }
+
+QString Executable::complete()
+{
+    // Called when the process has succeeded, before the "success" signal is emitted, to finish its work
+    // (e.g., to move the output into place). Returns an error message, or a null string on success.
+    return QString();
+}
+
+bool Executable::isCancelled() const
+{
+    return !cancelReason.isNull();
+}
+
+void Executable::emitCancelled()
+{
+    emit error(cancelReason);
+    emit finished();
+}
+
+void Executable::read(OutputBuffer &buffer, const QByteArray &data)
+{
+    for (const QString &line : buffer.append(data)) {
+        emit output(line);
+    }
+}
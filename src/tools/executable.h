@@ -2,6 +2,7 @@
 #define EXECUTABLE_H
 
 #include "base/result.h"
+#include "tools/outputbuffer.h"
 #include <QProcess>
 
 class Executable : public QObject
@@ -13,10 +14,15 @@ public:
     Executable(const QString &executable, QObject *parent = nullptr);
     ~Executable() override = default;
 
+    virtual void cancel(const QString &reason);
+    void setTimeout(int seconds);
+    qint64 getBytesWritten() const;
+
 signals:
     void success(const QString &message) const;
     void error(const QString &message) const;
     void finished() const;
+    void output(const QString &line) const;
 
 protected:
     QProcess process;
@@ -24,6 +30,19 @@ protected:
 
     virtual void startAsync(const QStringList &arguments);
     virtual Result<QString> startSync(const QStringList &arguments) const;
+    virtual QString complete();
+    bool isCancelled() const;
+    void emitCancelled();
+    void setBytesWritten(qint64 bytes);
+
+private:
+    void read(OutputBuffer &buffer, const QByteArray &data);
+
+    OutputBuffer standardOutput;
+    OutputBuffer standardError;
+    QString cancelReason;
+    int timeout;
+    qint64 bytesWritten;
 };
 
 #endif // EXECUTABLE_H
@@ -11,7 +11,7 @@ public:
     void startAsync(const QStringList &options) override;
     Result<QString> startSync(const QStringList &options) const override;
 
-private:
+protected:
     QString jar;
 };
 
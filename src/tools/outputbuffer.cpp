@@ -0,0 +1,70 @@
+#include "tools/outputbuffer.h"
+
+OutputBuffer::OutputBuffer(int limit)
+{
+    // Keeps the last lines of the process output up to the given number of characters.
+    this->limit = limit;
+    size = 0;
+    isTruncated = false;
+}
+
+QStringList OutputBuffer::append(const QByteArray &data)
+{
+    // Returns the lines completed by the data. Overlong lines are split at the limit.
+
+    QStringList completed;
+    partial.append(data);
+    int start = 0;
+    int newline;
+    while ((newline = partial.indexOf('\n', start)) != -1) {
+        const QString line = QString::fromUtf8(partial.constData() + start, newline - start).remove('\r');
+        push(line);
+        completed.append(line);
+        start = newline + 1;
+    }
+    partial.remove(0, start);
+    if (partial.size() > limit) {
+        const QString line = QString::fromUtf8(partial);
+        push(line);
+        completed.append(line);
+        partial.clear();
+    }
+    return completed;
+}
+
+QStringList OutputBuffer::flush()
+{
+    // Returns the trailing line which is not terminated by a newline.
+
+    if (partial.isEmpty()) {
+        return QStringList();
+    }
+    const QString line = QString::fromUtf8(partial).remove('\r');
+    partial.clear();
+    push(line);
+    return QStringList(line);
+}
+
+QString OutputBuffer::getText() const
+{
+    const QString text = QStringList(lines).join('\n');
+    return isTruncated ? QString("[...]\n%1").arg(text) : text;
+}
+
+void OutputBuffer::clear()
+{
+    lines.clear();
+    partial.clear();
+    size = 0;
+    isTruncated = false;
+}
+
+void OutputBuffer::push(const QString &line)
+{
+    lines.enqueue(line);
+    size += line.size() + 1;
+    while (size > limit && lines.size() > 1) {
+        size -= lines.dequeue().size() + 1;
+        isTruncated = true;
+    }
+}
@@ -0,0 +1,27 @@
+#ifndef OUTPUTBUFFER_H
+#define OUTPUTBUFFER_H
+
+#include <QQueue>
+#include <QStringList>
+
+class OutputBuffer
+{
+public:
+    explicit OutputBuffer(int limit = 1024 * 1024);
+
+    QStringList append(const QByteArray &data);
+    QStringList flush();
+    QString getText() const;
+    void clear();
+
+private:
+    void push(const QString &line);
+
+    QQueue<QString> lines;
+    QByteArray partial;
+    int size;
+    int limit;
+    bool isTruncated;
+};
+
+#endif // OUTPUTBUFFER_H
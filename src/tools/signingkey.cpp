@@ -0,0 +1,688 @@
+#include "tools/signingkey.h"
+#include "tools/der.h"
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFile>
+#include <QStringList>
+#include <QVector>
+#ifndef QT_NO_SSL
+#include <QSslCertificate>
+#include <QSslKey>
+#endif
+
+namespace
+{
+    // Big unsigned integers are stored as little-endian vectors of 32-bit words.
+
+    typedef QVector<quint32> Words;
+
+    Words toWords(const QByteArray &bigEndian, int count)
+    {
+        Words words(count, 0);
+        const int size = bigEndian.size();
+        for (int i = 0; i < size && i / 4 < count; ++i) {
+            const quint32 byte = static_cast<quint8>(bigEndian.at(size - 1 - i));
+            words[i / 4] |= byte << (8 * (i % 4));
+        }
+        return words;
+    }
+
+    QByteArray fromWords(const Words &words, int length)
+    {
+        QByteArray bigEndian(length, '\0');
+        for (int i = 0; i < length && i / 4 < words.size(); ++i) {
+            bigEndian[length - 1 - i] = static_cast<char>((words.at(i / 4) >> (8 * (i % 4))) & 0xFF);
+        }
+        return bigEndian;
+    }
+
+    bool isLess(const Words &a, const Words &b)
+    {
+        for (int i = b.size() - 1; i >= 0; --i) {
+            if (a.at(i) != b.at(i)) {
+                return a.at(i) < b.at(i);
+            }
+        }
+        return false;
+    }
+
+    quint32 subtract(Words &a, const Words &b)
+    {
+        // Subtracts b from the same number of lower words of a. Returns the borrow.
+
+        quint64 borrow = 0;
+        for (int i = 0; i < b.size(); ++i) {
+            const quint64 difference = static_cast<quint64>(a.at(i)) - b.at(i) - borrow;
+            a[i] = static_cast<quint32>(difference);
+            borrow = difference >> 63;
+        }
+        return static_cast<quint32>(borrow);
+    }
+
+    void add(Words &a, const Words &b)
+    {
+        // Adds b to a (of at least the same size). The carry out of the top word of a is dropped.
+
+        quint64 carry = 0;
+        for (int i = 0; i < a.size(); ++i) {
+            const quint64 sum = static_cast<quint64>(a.at(i)) + (i < b.size() ? b.at(i) : 0) + carry;
+            a[i] = static_cast<quint32>(sum);
+            carry = sum >> 32;
+        }
+    }
+
+    Words multiply(const Words &a, const Words &b)
+    {
+        // Schoolbook product, used once per signature to combine the CRT halves.
+
+        Words product(a.size() + b.size(), 0);
+        for (int i = 0; i < a.size(); ++i) {
+            quint64 carry = 0;
+            for (int j = 0; j < b.size(); ++j) {
+                const quint64 sum = static_cast<quint64>(product.at(i + j)) + static_cast<quint64>(a.at(i)) * b.at(j) + carry;
+                product[i + j] = static_cast<quint32>(sum);
+                carry = sum >> 32;
+            }
+            product[i + b.size()] = static_cast<quint32>(carry);
+        }
+        return product;
+    }
+
+    void select(Words &a, const Words &b, quint32 condition)
+    {
+        // Replaces a with b if the condition (0 or 1) is set, without branching on it: the operands are secret.
+
+        const quint32 mask = 0 - condition;
+        for (int i = 0; i < a.size(); ++i) {
+            a[i] = (b.at(i) & mask) | (a.at(i) & ~mask);
+        }
+    }
+
+    class Montgomery
+    {
+    public:
+        explicit Montgomery(const Words &modulus) : modulus(modulus)
+        {
+            // Precompute -modulus^-1 mod 2^32 (Newton's iteration) and R^2 mod modulus, where R = 2^(32 * size).
+
+            size = modulus.size();
+            quint32 inverse = 1;
+            for (int i = 0; i < 5; ++i) {
+                inverse *= 2 - modulus.at(0) * inverse;
+            }
+            factor = 0 - inverse;
+
+            r2 = Words(size, 0);
+            r2[0] = 1;
+            for (int i = 0; i < 64 * size; ++i) {
+                quint32 carry = 0;
+                for (int j = 0; j < size; ++j) {
+                    const quint32 word = r2.at(j);
+                    r2[j] = (word << 1) | carry;
+                    carry = word >> 31;
+                }
+                if (carry || !isLess(r2, modulus)) {
+                    subtract(r2, modulus);
+                }
+            }
+        }
+
+        Words power(const Words &base, const QByteArray &exponent) const
+        {
+            // Left-to-right binary exponentiation. The product is computed for every bit of the exponent and kept
+            // for the set bits only, so that the sequence of operations does not depend on the (private) exponent.
+
+            Words one(size, 0);
+            one[0] = 1;
+            Words result = multiply(one, r2);
+            const Words converted = multiply(base, r2);
+            for (char byte : exponent) {
+                for (int bit = 7; bit >= 0; --bit) {
+                    result = multiply(result, result);
+                    const Words product = multiply(result, converted);
+                    select(result, product, (static_cast<quint8>(byte) >> bit) & 1);
+                }
+            }
+            return multiply(result, one);
+        }
+
+        Words multiplyModular(const Words &a, const Words &b) const
+        {
+            // a * b mod modulus, for a and b less than the modulus.
+            return multiply(multiply(a, b), r2);
+        }
+
+        Words reduce(const Words &value) const
+        {
+            // value mod modulus, for a value of up to 2 * size words which is less than modulus * R.
+            // Montgomery reduction yields value / R mod modulus, which is then multiplied by R.
+
+            Words t = value;
+            t.resize(2 * size + 1);
+            for (int i = 0; i < size; ++i) {
+                const quint32 m = t.at(i) * factor;
+                quint64 carry = 0;
+                for (int j = 0; j < size; ++j) {
+                    const quint64 sum = static_cast<quint64>(t.at(i + j)) + static_cast<quint64>(m) * modulus.at(j) + carry;
+                    t[i + j] = static_cast<quint32>(sum);
+                    carry = sum >> 32;
+                }
+                for (int j = i + size; j < t.size(); ++j) {
+                    const quint64 sum = static_cast<quint64>(t.at(j)) + carry;
+                    t[j] = static_cast<quint32>(sum);
+                    carry = sum >> 32;
+                }
+            }
+            Words result = t.mid(size, size);
+            Words reduced = result;
+            const quint32 borrow = subtract(reduced, modulus);
+            select(result, reduced, static_cast<quint32>(t.at(2 * size) != 0) | (borrow ^ 1));
+            return multiply(result, r2);
+        }
+
+    private:
+        Words multiply(const Words &a, const Words &b) const
+        {
+            // Coarsely integrated operand scanning (CIOS) Montgomery multiplication: a * b / R mod modulus.
+
+            Words t(size + 2, 0);
+            for (int i = 0; i < size; ++i) {
+                quint64 carry = 0;
+                for (int j = 0; j < size; ++j) {
+                    const quint64 sum = static_cast<quint64>(t.at(j)) + static_cast<quint64>(a.at(j)) * b.at(i) + carry;
+                    t[j] = static_cast<quint32>(sum);
+                    carry = sum >> 32;
+                }
+                quint64 sum = static_cast<quint64>(t.at(size)) + carry;
+                t[size] = static_cast<quint32>(sum);
+                t[size + 1] = static_cast<quint32>(sum >> 32);
+
+                const quint32 m = t.at(0) * factor;
+                carry = (static_cast<quint64>(t.at(0)) + static_cast<quint64>(m) * modulus.at(0)) >> 32;
+                for (int j = 1; j < size; ++j) {
+                    sum = static_cast<quint64>(t.at(j)) + static_cast<quint64>(m) * modulus.at(j) + carry;
+                    t[j - 1] = static_cast<quint32>(sum);
+                    carry = sum >> 32;
+                }
+                sum = static_cast<quint64>(t.at(size)) + carry;
+                t[size - 1] = static_cast<quint32>(sum);
+                t[size] = t.at(size + 1) + static_cast<quint32>(sum >> 32);
+            }
+            Words result = t.mid(0, size);
+            Words reduced = result;
+            const quint32 borrow = subtract(reduced, modulus);
+            select(result, reduced, static_cast<quint32>(t.at(size) != 0) | (borrow ^ 1));
+            return result;
+        }
+
+        Words modulus;
+        Words r2;
+        quint32 factor;
+        int size;
+    };
+
+    bool readCertificate(const QByteArray &certificate, QByteArray *serialNumber, QByteArray *issuer, QByteArray *publicKey)
+    {
+        // Certificate: SEQUENCE { tbsCertificate, signatureAlgorithm, signature }
+        // TBSCertificate: SEQUENCE { [0] version OPTIONAL, serialNumber, signature, issuer, validity, subject, subjectPublicKeyInfo, ... }
+
+        QByteArray content;
+        Der::Reader reader(certificate);
+        if (!reader.read(Der::Sequence, &content)) {
+            return false;
+        }
+        Der::Reader certificateReader(content);
+        if (!certificateReader.read(Der::Sequence, &content)) {
+            return false;
+        }
+        Der::Reader tbs(content);
+        tbs.read(Der::ContextSpecific, nullptr);
+        return tbs.read(Der::Integer, nullptr, serialNumber)
+            && tbs.skip()
+            && tbs.read(Der::Sequence, nullptr, issuer)
+            && tbs.skip()
+            && tbs.skip()
+            && tbs.read(Der::Sequence, nullptr, publicKey);
+    }
+
+#ifndef QT_NO_SSL
+    QString fromUtf16(const QByteArray &bytes)
+    {
+        QString string;
+        for (int i = 0; i + 1 < bytes.size(); i += 2) {
+            string.append(QChar(static_cast<ushort>((static_cast<quint8>(bytes.at(i)) << 8) | static_cast<quint8>(bytes.at(i + 1)))));
+        }
+        return string;
+    }
+
+    bool readPkcs12KeyAliases(const QByteArray &keystore, QStringList *aliases)
+    {
+        // PFX: SEQUENCE { version, authSafe ContentInfo, macData OPTIONAL }; ContentInfo: SEQUENCE { contentType, [0] content }
+        // AuthenticatedSafe: SEQUENCE OF ContentInfo; SafeBag: SEQUENCE { bagId, [0] bagValue, bagAttributes SET OF Attribute OPTIONAL }
+        // The key bags are stored in the unencrypted "data" content infos, so their friendly names (aliases) are read without
+        // the password. Returns false if the structure is not supported (e.g., BER-encoded) or no keys are found.
+
+        const QByteArray dataOid = Der::oid("1.2.840.113549.1.7.1");
+        const QByteArray keyBagOid = Der::oid("1.2.840.113549.1.12.10.1.1");
+        const QByteArray shroudedKeyBagOid = Der::oid("1.2.840.113549.1.12.10.1.2");
+        const QByteArray friendlyNameOid = Der::oid("1.2.840.113549.1.9.20");
+
+        auto readData = [&](const QByteArray &contentInfo, QByteArray *sequence) -> bool {
+            QByteArray type;
+            QByteArray content;
+            QByteArray octets;
+            Der::Reader reader(contentInfo);
+            if (!reader.read(Der::ObjectIdentifier, nullptr, &type) || type != dataOid || !reader.read(Der::ContextSpecific, &content)) {
+                return false;
+            }
+            Der::Reader contentReader(content);
+            if (!contentReader.read(Der::OctetString, &octets)) {
+                return false;
+            }
+            Der::Reader octetsReader(octets);
+            return octetsReader.read(Der::Sequence, sequence);
+        };
+
+        QByteArray pfx;
+        QByteArray authSafe;
+        QByteArray contentInfos;
+        Der::Reader keystoreReader(keystore);
+        if (!keystoreReader.read(Der::Sequence, &pfx)) {
+            return false;
+        }
+        Der::Reader pfxReader(pfx);
+        if (!pfxReader.read(Der::Integer, nullptr) || !pfxReader.read(Der::Sequence, &authSafe) || !readData(authSafe, &contentInfos)) {
+            return false;
+        }
+        Der::Reader contentInfosReader(contentInfos);
+        while (!contentInfosReader.atEnd()) {
+            QByteArray contentInfo;
+            QByteArray bags;
+            if (!contentInfosReader.read(Der::Sequence, &contentInfo)) {
+                return false;
+            }
+            if (!readData(contentInfo, &bags)) {
+                continue; // Encrypted content (e.g., certificates)
+            }
+            Der::Reader bagsReader(bags);
+            while (!bagsReader.atEnd()) {
+                QByteArray bag;
+                QByteArray bagId;
+                QByteArray attributes;
+                if (!bagsReader.read(Der::Sequence, &bag)) {
+                    return false;
+                }
+                Der::Reader bagReader(bag);
+                if (!bagReader.read(Der::ObjectIdentifier, nullptr, &bagId) || !bagReader.skip()) {
+                    return false;
+                }
+                if (bagId != keyBagOid && bagId != shroudedKeyBagOid) {
+                    continue;
+                }
+                QString alias;
+                if (bagReader.read(Der::Set, &attributes)) {
+                    Der::Reader attributesReader(attributes);
+                    QByteArray attribute;
+                    while (attributesReader.read(Der::Sequence, &attribute)) {
+                        QByteArray attributeId;
+                        QByteArray values;
+                        QByteArray name;
+                        Der::Reader attributeReader(attribute);
+                        if (attributeReader.read(Der::ObjectIdentifier, nullptr, &attributeId) && attributeId == friendlyNameOid
+                                && attributeReader.read(Der::Set, &values)) {
+                            Der::Reader valuesReader(values);
+                            if (valuesReader.read(Der::BmpString, &name)) {
+                                alias = fromUtf16(name);
+                            }
+                        }
+                    }
+                }
+                aliases->append(alias);
+            }
+        }
+        return !aliases->isEmpty();
+    }
+#endif
+
+    QByteArray toUtf16(const QString &password)
+    {
+        QByteArray bytes;
+        for (const QChar &character : password) {
+            bytes.append(static_cast<char>(character.unicode() >> 8));
+            bytes.append(static_cast<char>(character.unicode() & 0xFF));
+        }
+        return bytes;
+    }
+}
+
+bool SigningKey::load(const QString &keystorePath, const QString &keystorePassword, const QString &keyAlias, const QString &keyPassword)
+{
+    // Supports RSA keys stored in JKS or PKCS #12 keystores.
+
+    QFile file(keystorePath);
+    if (!file.open(QFile::ReadOnly)) {
+        return fail(file.errorString());
+    }
+    const QByteArray keystore = file.readAll();
+    if (keystore.startsWith("\xFE\xED\xFE\xED")) {
+        return loadJks(keystore, keystorePassword, keyAlias, keyPassword);
+    }
+    return loadPkcs12(keystore, keystorePassword, keyAlias, keyPassword);
+}
+
+const QString &SigningKey::getError() const
+{
+    return error;
+}
+
+const QList<QByteArray> &SigningKey::getCertificates() const
+{
+    return certificates;
+}
+
+QByteArray SigningKey::getPublicKey() const
+{
+    // Returns the DER-encoded SubjectPublicKeyInfo of the signer certificate.
+    QByteArray publicKey;
+    if (certificates.isEmpty() || !readCertificate(certificates.first(), nullptr, nullptr, &publicKey)) {
+        return QByteArray();
+    }
+    return publicKey;
+}
+
+QByteArray SigningKey::getIssuerAndSerialNumber() const
+{
+    QByteArray serialNumber;
+    QByteArray issuer;
+    if (certificates.isEmpty() || !readCertificate(certificates.first(), &serialNumber, &issuer, nullptr)) {
+        return QByteArray();
+    }
+    return Der::encode(Der::Sequence, issuer + serialNumber);
+}
+
+QByteArray SigningKey::sign(const QByteArray &message, Digest digest) const
+{
+    // RSASSA-PKCS1-v1_5. The signature is verified with the public exponent before it is returned,
+    // so that an arithmetic error never results in a broken APK. Returns an empty array on failure.
+
+    const QByteArray algorithm = (digest == Sha1) ? Der::oid("1.3.14.3.2.26") : Der::oid("2.16.840.1.101.3.4.2.1");
+    const QByteArray hash = QCryptographicHash::hash(message, (digest == Sha1) ? QCryptographicHash::Sha1 : QCryptographicHash::Sha256);
+    const QByteArray digestInfo = Der::encode(Der::Sequence, Der::encode(Der::Sequence, algorithm + Der::null()) + Der::encode(Der::OctetString, hash));
+
+    const int length = modulus.size();
+    if (length < digestInfo.size() + 11) {
+        return QByteArray();
+    }
+    const QByteArray encoded = QByteArray("\x00\x01", 2) + QByteArray(length - digestInfo.size() - 3, '\xFF') + '\0' + digestInfo;
+
+    const int words = (length + 3) / 4;
+    const int primeWords = (prime1.size() + 3) / 4;
+    const Words message = toWords(encoded, words);
+    const Montgomery montgomery(toWords(modulus, words));
+    Words result;
+    if (!prime1.isEmpty() && (prime2.size() + 3) / 4 == primeWords && 2 * primeWords >= words) {
+        // Chinese remainder theorem (Garner's formula), for primes of the same number of words:
+        // m1 = c^dP mod p, m2 = c^dQ mod q, h = qInv * (m1 - m2) mod p, s = m2 + h * q
+        const Words p = toWords(prime1, primeWords);
+        const Words q = toWords(prime2, primeWords);
+        const Montgomery montgomeryP(p);
+        const Montgomery montgomeryQ(q);
+        const Words m1 = montgomeryP.power(montgomeryP.reduce(message), exponent1);
+        const Words m2 = montgomeryQ.power(montgomeryQ.reduce(message), exponent2);
+        Words difference = m1;
+        const quint32 borrow = subtract(difference, montgomeryP.reduce(m2));
+        Words corrected = difference;
+        add(corrected, p);
+        select(difference, corrected, borrow);
+        result = multiply(montgomeryP.multiplyModular(difference, toWords(coefficient, primeWords)), q);
+        add(result, m2);
+    } else {
+        result = montgomery.power(message, privateExponent);
+    }
+    const QByteArray signature = fromWords(result, length);
+    if (fromWords(montgomery.power(toWords(signature, words), publicExponent), length) != encoded) {
+        return QByteArray();
+    }
+    return signature;
+}
+
+bool SigningKey::loadJks(const QByteArray &keystore, const QString &keystorePassword, const QString &keyAlias, const QString &keyPassword)
+{
+    QDataStream stream(keystore);
+    quint32 magic;
+    quint32 version;
+    quint32 count;
+    stream >> magic >> version >> count;
+    if (version != 1 && version != 2) {
+        return fail("Unsupported keystore version.");
+    }
+
+    auto readBytes = [&](int lengthSize) -> QByteArray {
+        quint32 length = 0;
+        if (lengthSize == 2) {
+            quint16 shortLength;
+            stream >> shortLength;
+            length = shortLength;
+        } else {
+            stream >> length;
+        }
+        if (stream.status() != QDataStream::Ok || length > static_cast<quint32>(keystore.size())) {
+            stream.setStatus(QDataStream::ReadCorruptData);
+            return QByteArray();
+        }
+        QByteArray bytes(static_cast<int>(length), '\0');
+        if (stream.readRawData(bytes.data(), bytes.size()) != bytes.size()) {
+            stream.setStatus(QDataStream::ReadPastEnd);
+        }
+        return bytes;
+    };
+
+    QByteArray protectedKey;
+    QList<QByteArray> chain;
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        quint32 tag;
+        qint64 timestamp;
+        stream >> tag;
+        const QString alias = QString::fromUtf8(readBytes(2));
+        stream >> timestamp;
+        if (tag == 1) {
+            // Private key entry: protected key, certificate chain
+            const QByteArray key = readBytes(4);
+            quint32 chainLength;
+            stream >> chainLength;
+            QList<QByteArray> certificates;
+            for (quint32 j = 0; j < chainLength && stream.status() == QDataStream::Ok; ++j) {
+                if (version == 2) {
+                    readBytes(2); // Certificate type
+                }
+                certificates.append(readBytes(4));
+            }
+            if (protectedKey.isNull() && (keyAlias.isEmpty() || alias.compare(keyAlias, Qt::CaseInsensitive) == 0)) {
+                protectedKey = key;
+                chain = certificates;
+            }
+        } else if (tag == 2) {
+            // Trusted certificate entry
+            if (version == 2) {
+                readBytes(2);
+            }
+            readBytes(4);
+        } else {
+            return fail("Unsupported keystore entry.");
+        }
+    }
+    if (stream.status() != QDataStream::Ok) {
+        return fail("Keystore is corrupted.");
+    }
+
+    // Keystore integrity: SHA-1 (password, "Mighty Aphrodite", keystore data)
+
+    const QByteArray password = toUtf16(keystorePassword);
+    const qint64 dataSize = stream.device()->pos();
+    QCryptographicHash integrity(QCryptographicHash::Sha1);
+    integrity.addData(password);
+    integrity.addData("Mighty Aphrodite");
+    integrity.addData(keystore.constData(), static_cast<int>(dataSize));
+    if (keystore.mid(static_cast<int>(dataSize), 20) != integrity.result()) {
+        return fail("Invalid keystore password.");
+    }
+    if (protectedKey.isNull()) {
+        return fail(QString("Key \"%1\" not found.").arg(keyAlias));
+    }
+
+    // Private key protection: EncryptedPrivateKeyInfo { algorithm (Sun KeyProtector), salt + encrypted key + check }
+
+    QByteArray content;
+    QByteArray algorithm;
+    QByteArray algorithmOid;
+    QByteArray encrypted;
+    Der::Reader keyReader(protectedKey);
+    if (!keyReader.read(Der::Sequence, &content)) {
+        return fail("Invalid private key entry.");
+    }
+    Der::Reader infoReader(content);
+    if (!infoReader.read(Der::Sequence, &algorithm) || !infoReader.read(Der::OctetString, &encrypted)) {
+        return fail("Invalid private key entry.");
+    }
+    Der::Reader algorithmReader(algorithm);
+    if (!algorithmReader.read(Der::ObjectIdentifier, nullptr, &algorithmOid) || algorithmOid != Der::oid("1.3.6.1.4.1.42.2.17.1.1")) {
+        return fail("Unsupported private key protection algorithm.");
+    }
+    if (encrypted.size() <= 40) {
+        return fail("Invalid private key entry.");
+    }
+
+    const QByteArray keyPasswordBytes = toUtf16(keyPassword);
+    const QByteArray salt = encrypted.left(20);
+    const QByteArray check = encrypted.right(20);
+    QByteArray key = encrypted.mid(20, encrypted.size() - 40);
+    QByteArray keystream = salt;
+    for (int offset = 0; offset < key.size(); offset += 20) {
+        keystream = QCryptographicHash::hash(keyPasswordBytes + keystream, QCryptographicHash::Sha1);
+        for (int i = 0; i < 20 && offset + i < key.size(); ++i) {
+            key[offset + i] = static_cast<char>(key.at(offset + i) ^ keystream.at(i));
+        }
+    }
+    if (QCryptographicHash::hash(keyPasswordBytes + key, QCryptographicHash::Sha1) != check) {
+        return fail("Invalid key password.");
+    }
+
+    certificates = chain;
+    return setPrivateKey(key);
+}
+
+bool SigningKey::loadPkcs12(const QByteArray &keystore, const QString &keystorePassword, const QString &keyAlias, const QString &keyPassword)
+{
+    // QSslCertificate::importPkcs12() imports the first key of the keystore with the keystore password. So the keystore
+    // is only used if that key is the requested one; other keystores are left to the apksigner fallback.
+#ifndef QT_NO_SSL
+    QStringList aliases;
+    if (!readPkcs12KeyAliases(keystore, &aliases)) {
+        return fail("Unsupported PKCS #12 keystore structure.");
+    }
+    if (aliases.count() > 1) {
+        return fail("PKCS #12 keystores with multiple keys are not supported.");
+    }
+    if (!keyAlias.isEmpty() && aliases.first().compare(keyAlias, Qt::CaseInsensitive) != 0) {
+        return fail(QString("Key \"%1\" not found.").arg(keyAlias));
+    }
+    if (!keyPassword.isEmpty() && keyPassword != keystorePassword) {
+        return fail("PKCS #12 keys protected with a separate password are not supported.");
+    }
+    QBuffer buffer;
+    buffer.setData(keystore);
+    buffer.open(QIODevice::ReadOnly);
+    QSslKey key;
+    QSslCertificate certificate;
+    QList<QSslCertificate> caCertificates;
+    if (!QSslCertificate::importPkcs12(&buffer, &key, &certificate, &caCertificates, keystorePassword.toUtf8())) {
+        return fail("Unsupported keystore format or invalid keystore password.");
+    }
+    if (key.algorithm() != QSsl::Rsa) {
+        return fail("Only RSA keys are supported.");
+    }
+    certificates.clear();
+    certificates.append(certificate.toDer());
+    for (const QSslCertificate &caCertificate : caCertificates) {
+        certificates.append(caCertificate.toDer());
+    }
+    return setPrivateKey(key.toDer());
+#else
+    Q_UNUSED(keystore)
+    Q_UNUSED(keystorePassword)
+    Q_UNUSED(keyAlias)
+    Q_UNUSED(keyPassword)
+    return fail("Unsupported keystore format.");
+#endif
+}
+
+bool SigningKey::setPrivateKey(const QByteArray &key)
+{
+    // Accepts PKCS #8 PrivateKeyInfo and PKCS #1 RSAPrivateKey structures.
+
+    QByteArray content;
+    Der::Reader keyReader(key);
+    if (!keyReader.read(Der::Sequence, &content)) {
+        return fail("Invalid private key.");
+    }
+    Der::Reader reader(content);
+    QByteArray algorithm;
+    if (!reader.read(Der::Integer, nullptr)) {
+        return fail("Invalid private key.");
+    }
+    if (reader.read(Der::Sequence, &algorithm)) {
+        QByteArray algorithmOid;
+        QByteArray rsaKey;
+        Der::Reader algorithmReader(algorithm);
+        if (!algorithmReader.read(Der::ObjectIdentifier, nullptr, &algorithmOid) || algorithmOid != Der::oid("1.2.840.113549.1.1.1")) {
+            return fail("Only RSA keys are supported.");
+        }
+        if (!reader.read(Der::OctetString, &rsaKey)) {
+            return fail("Invalid private key.");
+        }
+        return setPrivateKey(rsaKey);
+    }
+
+    QByteArray n;
+    QByteArray e;
+    QByteArray d;
+    if (!reader.read(Der::Integer, &n) || !reader.read(Der::Integer, &e) || !reader.read(Der::Integer, &d)) {
+        return fail("Invalid private key.");
+    }
+    modulus = Der::magnitude(n);
+    publicExponent = Der::magnitude(e);
+    privateExponent = Der::magnitude(d);
+
+    // The CRT parameters are optional here; the signature is computed with the private exponent without them.
+    QByteArray p;
+    QByteArray q;
+    QByteArray dP;
+    QByteArray dQ;
+    QByteArray qInv;
+    if (reader.read(Der::Integer, &p) && reader.read(Der::Integer, &q) && reader.read(Der::Integer, &dP)
+            && reader.read(Der::Integer, &dQ) && reader.read(Der::Integer, &qInv)) {
+        prime1 = Der::magnitude(p);
+        prime2 = Der::magnitude(q);
+        exponent1 = Der::magnitude(dP);
+        exponent2 = Der::magnitude(dQ);
+        coefficient = Der::magnitude(qInv);
+    }
+    if (prime1.isEmpty() || prime2.isEmpty() || exponent1.isEmpty() || exponent2.isEmpty() || coefficient.isEmpty()
+            || !(prime1.at(prime1.size() - 1) & 1) || !(prime2.at(prime2.size() - 1) & 1)) {
+        prime1.clear();
+    }
+    if (modulus.isEmpty() || !(modulus.at(modulus.size() - 1) & 1) || publicExponent.isEmpty() || privateExponent.isEmpty()) {
+        return fail("Invalid private key.");
+    }
+    if (certificates.isEmpty() || getPublicKey().isEmpty()) {
+        return fail("Invalid certificate chain.");
+    }
+    return true;
+}
+
+bool SigningKey::fail(const QString &error)
+{
+    this->error = error;
+    return false;
+}
@@ -0,0 +1,43 @@
+#ifndef SIGNINGKEY_H
+#define SIGNINGKEY_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+class SigningKey
+{
+public:
+    enum Digest {
+        Sha1,
+        Sha256
+    };
+
+    bool load(const QString &keystorePath, const QString &keystorePassword, const QString &keyAlias, const QString &keyPassword);
+    const QString &getError() const;
+
+    const QList<QByteArray> &getCertificates() const;
+    QByteArray getPublicKey() const;
+    QByteArray getIssuerAndSerialNumber() const;
+
+    QByteArray sign(const QByteArray &message, Digest digest) const;
+
+private:
+    bool loadJks(const QByteArray &keystore, const QString &keystorePassword, const QString &keyAlias, const QString &keyPassword);
+    bool loadPkcs12(const QByteArray &keystore, const QString &keystorePassword, const QString &keyAlias, const QString &keyPassword);
+    bool setPrivateKey(const QByteArray &key);
+    bool fail(const QString &error);
+
+    QByteArray modulus;
+    QByteArray publicExponent;
+    QByteArray privateExponent;
+    QByteArray prime1;
+    QByteArray prime2;
+    QByteArray exponent1;
+    QByteArray exponent2;
+    QByteArray coefficient;
+    QList<QByteArray> certificates;
+    QString error;
+};
+
+#endif // SIGNINGKEY_H
@@ -10,6 +10,18 @@ public:
     explicit Zipalign(const QString &executable, QObject *parent = nullptr) : Executable(executable, parent) {}
 
     void align(const QString &apk);
+
+    static bool alignArchive(const QString &source, const QString &target, int alignment, QString *error = nullptr, qint64 *written = nullptr);
+    static bool isAligned(const QString &apk, int alignment);
+
+protected:
+    QString complete() override;
+
+private:
+    void alignExternally(const QString &apk);
+
+    QString alignedApk; // Output of the zipalign binary, renamed over the APK once it has succeeded
+    QString targetApk;
 };
 
 #endif // ZIPALIGN_H
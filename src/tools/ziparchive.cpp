@@ -0,0 +1,240 @@
+#include "tools/ziparchive.h"
+#include <cstring>
+#ifdef Q_OS_WIN
+#include <QtZlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
+
+ZipArchive::ZipArchive(const QString &path) : file(path)
+{
+    data = nullptr;
+    size = 0;
+    centralDirectoryOffset = 0;
+    centralDirectorySize = 0;
+    endOfCentralDirectoryOffset = 0;
+}
+
+bool ZipArchive::open()
+{
+    // The archive is memory-mapped; ZIP64 and multi-disk archives are not supported.
+
+    if (!file.open(QFile::ReadOnly)) {
+        return fail(file.errorString());
+    }
+    size = file.size();
+    if (size < EndOfCentralDirectorySize) {
+        return fail("File is too small.");
+    }
+    data = file.map(0, size);
+    if (!data) {
+        return fail(file.errorString());
+    }
+
+    // Find the end of central directory record (followed by a comment of up to 64 KiB):
+
+    const qint64 lowest = qMax<qint64>(0, size - EndOfCentralDirectorySize - 0xFFFF);
+    endOfCentralDirectoryOffset = -1;
+    for (qint64 offset = size - EndOfCentralDirectorySize; offset >= lowest; --offset) {
+        if (readUInt32(data + offset) == EndOfCentralDirectorySignature
+                && offset + EndOfCentralDirectorySize + readUInt16(data + offset + 20) == size) {
+            endOfCentralDirectoryOffset = offset;
+            break;
+        }
+    }
+    if (endOfCentralDirectoryOffset < 0) {
+        return fail("End of central directory not found.");
+    }
+
+    const uchar *eocd = data + endOfCentralDirectoryOffset;
+    const quint16 diskEntryCount = readUInt16(eocd + 8);
+    const quint16 entryCount = readUInt16(eocd + 10);
+    centralDirectorySize = readUInt32(eocd + 12);
+    centralDirectoryOffset = readUInt32(eocd + 16);
+    if (entryCount == 0xFFFF || centralDirectorySize == 0xFFFFFFFF || centralDirectoryOffset == 0xFFFFFFFF) {
+        return fail("ZIP64 archives are not supported.");
+    }
+    if (readUInt16(eocd + 4) != 0 || readUInt16(eocd + 6) != 0 || diskEntryCount != entryCount) {
+        return fail("Multi-disk archives are not supported.");
+    }
+    if (centralDirectoryOffset + centralDirectorySize > endOfCentralDirectoryOffset) {
+        return fail("Invalid central directory.");
+    }
+
+    // Read the central directory:
+
+    entries.clear();
+    entries.reserve(entryCount);
+    qint64 offset = centralDirectoryOffset;
+    for (int i = 0; i < entryCount; ++i) {
+        if (offset + CentralHeaderSize > endOfCentralDirectoryOffset || readUInt32(data + offset) != CentralHeaderSignature) {
+            return fail("Invalid central directory entry.");
+        }
+        const uchar *header = data + offset;
+        const quint16 nameLength = readUInt16(header + 28);
+        const quint16 extraLength = readUInt16(header + 30);
+        const quint16 commentLength = readUInt16(header + 32);
+
+        Entry entry;
+        entry.flags = readUInt16(header + 8);
+        entry.method = readUInt16(header + 10);
+        entry.crc = readUInt32(header + 16);
+        entry.compressedSize = readUInt32(header + 20);
+        entry.uncompressedSize = readUInt32(header + 24);
+        entry.localHeaderOffset = readUInt32(header + 42);
+        entry.centralHeaderOffset = offset;
+        entry.centralHeaderSize = CentralHeaderSize + nameLength + extraLength + commentLength;
+        if (offset + entry.centralHeaderSize > endOfCentralDirectoryOffset) {
+            return fail("Invalid central directory entry.");
+        }
+        entry.name = QByteArray(reinterpret_cast<const char *>(header + CentralHeaderSize), nameLength);
+
+        // Locate the entry data using the local header (its extra field may differ from the central one):
+
+        const qint64 local = entry.localHeaderOffset;
+        if (local + LocalHeaderSize > centralDirectoryOffset || readUInt32(data + local) != LocalHeaderSignature) {
+            return fail(QString("Invalid local header: %1").arg(QString::fromUtf8(entry.name)));
+        }
+        entry.dataOffset = local + LocalHeaderSize + readUInt16(data + local + 26) + readUInt16(data + local + 28);
+        if (entry.dataOffset + entry.compressedSize > centralDirectoryOffset) {
+            return fail(QString("Invalid entry size: %1").arg(QString::fromUtf8(entry.name)));
+        }
+
+        entry.dataDescriptorSize = 0;
+        if (entry.flags & 0x08) {
+            const qint64 descriptor = entry.dataOffset + entry.compressedSize;
+            if (descriptor + 4 <= centralDirectoryOffset && readUInt32(data + descriptor) == DataDescriptorSignature) {
+                entry.dataDescriptorSize = 16;
+            } else {
+                entry.dataDescriptorSize = 12;
+            }
+            if (descriptor + entry.dataDescriptorSize > centralDirectoryOffset) {
+                return fail(QString("Invalid data descriptor: %1").arg(QString::fromUtf8(entry.name)));
+            }
+        }
+
+        entries.append(entry);
+        offset += entry.centralHeaderSize;
+    }
+
+    return true;
+}
+
+const QString &ZipArchive::getError() const
+{
+    return error;
+}
+
+const QVector<ZipArchive::Entry> &ZipArchive::getEntries() const
+{
+    return entries;
+}
+
+const uchar *ZipArchive::getData() const
+{
+    return data;
+}
+
+qint64 ZipArchive::getSize() const
+{
+    return size;
+}
+
+qint64 ZipArchive::getCentralDirectoryOffset() const
+{
+    return centralDirectoryOffset;
+}
+
+qint64 ZipArchive::getCentralDirectorySize() const
+{
+    return centralDirectorySize;
+}
+
+qint64 ZipArchive::getEndOfCentralDirectoryOffset() const
+{
+    return endOfCentralDirectoryOffset;
+}
+
+QByteArray ZipArchive::getComment() const
+{
+    const qint64 offset = endOfCentralDirectoryOffset + EndOfCentralDirectorySize;
+    return QByteArray(reinterpret_cast<const char *>(data + offset), static_cast<int>(size - offset));
+}
+
+bool ZipArchive::read(const Entry &entry, const Consumer &consumer) const
+{
+    // Passes the uncompressed entry data to the consumer: stored entries in one piece, deflated ones
+    // in blocks of up to 64 KiB. Returns false if the entry is corrupted or uses an unsupported method.
+
+    const uchar *source = data + entry.dataOffset;
+    if (entry.method == 0) {
+        if (entry.compressedSize != entry.uncompressedSize) {
+            return false;
+        }
+        consumer(reinterpret_cast<const char *>(source), entry.compressedSize);
+        return true;
+    }
+    if (entry.method != 8) {
+        return false;
+    }
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+        return false;
+    }
+    stream.next_in = const_cast<Bytef *>(source);
+    stream.avail_in = entry.compressedSize;
+
+    char buffer[64 * 1024];
+    qint64 total = 0;
+    int status = Z_OK;
+    while (status == Z_OK) {
+        stream.next_out = reinterpret_cast<Bytef *>(buffer);
+        stream.avail_out = sizeof(buffer);
+        status = inflate(&stream, Z_NO_FLUSH);
+        const qint64 produced = static_cast<qint64>(sizeof(buffer) - stream.avail_out);
+        if (status != Z_OK && status != Z_STREAM_END) {
+            break;
+        }
+        if (produced > 0) {
+            consumer(buffer, produced);
+            total += produced;
+        } else if (status == Z_OK && stream.avail_in == 0) {
+            break; // Truncated stream
+        }
+    }
+    inflateEnd(&stream);
+    return status == Z_STREAM_END && total == entry.uncompressedSize;
+}
+
+quint16 ZipArchive::readUInt16(const uchar *data)
+{
+    return static_cast<quint16>(data[0] | (data[1] << 8));
+}
+
+quint32 ZipArchive::readUInt32(const uchar *data)
+{
+    return static_cast<quint32>(data[0]) | (static_cast<quint32>(data[1]) << 8)
+         | (static_cast<quint32>(data[2]) << 16) | (static_cast<quint32>(data[3]) << 24);
+}
+
+void ZipArchive::writeUInt16(uchar *data, quint16 value)
+{
+    data[0] = value & 0xFF;
+    data[1] = (value >> 8) & 0xFF;
+}
+
+void ZipArchive::writeUInt32(uchar *data, quint32 value)
+{
+    data[0] = value & 0xFF;
+    data[1] = (value >> 8) & 0xFF;
+    data[2] = (value >> 16) & 0xFF;
+    data[3] = (value >> 24) & 0xFF;
+}
+
+bool ZipArchive::fail(const QString &error)
+{
+    this->error = error;
+    return false;
+}
@@ -0,0 +1,74 @@
+#ifndef ZIPARCHIVE_H
+#define ZIPARCHIVE_H
+
+#include <QFile>
+#include <QVector>
+#include <functional>
+
+class ZipArchive
+{
+public:
+    struct Entry
+    {
+        QByteArray name;
+        quint16 flags;
+        quint16 method;
+        quint32 crc;
+        quint32 compressedSize;
+        quint32 uncompressedSize;
+        qint64 localHeaderOffset;
+        qint64 dataOffset;
+        qint64 dataDescriptorSize;
+        qint64 centralHeaderOffset;
+        qint64 centralHeaderSize;
+    };
+
+    enum Signature : quint32 {
+        LocalHeaderSignature = 0x04034b50,
+        DataDescriptorSignature = 0x08074b50,
+        CentralHeaderSignature = 0x02014b50,
+        EndOfCentralDirectorySignature = 0x06054b50
+    };
+
+    enum Size {
+        LocalHeaderSize = 30,
+        CentralHeaderSize = 46,
+        EndOfCentralDirectorySize = 22
+    };
+
+    typedef std::function<void(const char *data, qint64 size)> Consumer;
+
+    explicit ZipArchive(const QString &path);
+
+    bool open();
+    const QString &getError() const;
+
+    const QVector<Entry> &getEntries() const;
+    const uchar *getData() const;
+    qint64 getSize() const;
+    qint64 getCentralDirectoryOffset() const;
+    qint64 getCentralDirectorySize() const;
+    qint64 getEndOfCentralDirectoryOffset() const;
+    QByteArray getComment() const;
+
+    bool read(const Entry &entry, const Consumer &consumer) const;
+
+    static quint16 readUInt16(const uchar *data);
+    static quint32 readUInt32(const uchar *data);
+    static void writeUInt16(uchar *data, quint16 value);
+    static void writeUInt32(uchar *data, quint32 value);
+
+private:
+    bool fail(const QString &error);
+
+    QFile file;
+    const uchar *data;
+    qint64 size;
+    QVector<Entry> entries;
+    qint64 centralDirectoryOffset;
+    qint64 centralDirectorySize;
+    qint64 endOfCentralDirectoryOffset;
+    QString error;
+};
+
+#endif // ZIPARCHIVE_H
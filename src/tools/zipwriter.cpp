@@ -0,0 +1,200 @@
+#include "tools/zipwriter.h"
+#include <cstring>
+#ifdef Q_OS_WIN
+#include <QtZlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
+
+ZipWriter::ZipWriter(QIODevice *device, int alignment)
+{
+    this->device = device;
+    this->alignment = qMax(1, alignment);
+    position = 0;
+    entryCount = 0;
+}
+
+void ZipWriter::setObserver(const Observer &observer)
+{
+    // The observer receives every byte written to the device, in order.
+    this->observer = observer;
+}
+
+bool ZipWriter::copyEntry(const ZipArchive &archive, const ZipArchive::Entry &entry)
+{
+    // Local headers are rebuilt from the central directory, and the data of the stored (uncompressed)
+    // entries is aligned by padding the local extra field with zeros (the layout of "zipalign -f").
+
+    const uchar *data = archive.getData();
+    const uchar *central = data + entry.centralHeaderOffset;
+    const uchar *local = data + entry.localHeaderOffset;
+    const quint16 nameLength = static_cast<quint16>(entry.name.size());
+    const quint16 extraLength = ZipArchive::readUInt16(local + 28);
+    const uchar *extra = local + ZipArchive::LocalHeaderSize + ZipArchive::readUInt16(local + 26);
+
+    const int padding = (entry.method == 0) ? getPadding(ZipArchive::LocalHeaderSize + nameLength + extraLength) : 0;
+    if (extraLength + padding > 0xFFFF) {
+        return fail(QString("Extra field overflow: %1").arg(QString::fromUtf8(entry.name)));
+    }
+
+    uchar header[ZipArchive::LocalHeaderSize];
+    ZipArchive::writeUInt32(header, ZipArchive::LocalHeaderSignature);
+    memcpy(header + 4, central + 6, 4);   // Version needed to extract, general purpose flags
+    memcpy(header + 8, central + 10, 18); // Method, time, date, CRC-32, sizes, name length
+    ZipArchive::writeUInt16(header + 26, nameLength);
+    ZipArchive::writeUInt16(header + 28, static_cast<quint16>(extraLength + padding));
+
+    QByteArray centralHeader(reinterpret_cast<const char *>(central), static_cast<int>(entry.centralHeaderSize));
+    ZipArchive::writeUInt32(reinterpret_cast<uchar *>(centralHeader.data()) + 42, static_cast<quint32>(position));
+    centralDirectory.append(centralHeader);
+    ++entryCount;
+
+    return write(reinterpret_cast<const char *>(header), sizeof(header))
+        && write(entry.name.constData(), nameLength)
+        && write(reinterpret_cast<const char *>(extra), extraLength)
+        && write(QByteArray(padding, '\0'))
+        && write(reinterpret_cast<const char *>(data + entry.dataOffset), entry.compressedSize + entry.dataDescriptorSize);
+}
+
+bool ZipWriter::addEntry(const QByteArray &name, const QByteArray &data, bool compress)
+{
+    // Adds an entry dated 1981-01-01. Stored (uncompressed) entries are aligned.
+
+    QByteArray content = data;
+    if (compress) {
+        content = deflate(data);
+        if (content.isNull()) {
+            return fail(QString("Could not compress %1").arg(QString::fromUtf8(name)));
+        }
+    }
+
+    const quint16 nameLength = static_cast<quint16>(name.size());
+    const int padding = compress ? 0 : getPadding(ZipArchive::LocalHeaderSize + nameLength);
+    const quint32 crc = static_cast<quint32>(crc32(0, reinterpret_cast<const Bytef *>(data.constData()), static_cast<uInt>(data.size())));
+
+    uchar header[ZipArchive::LocalHeaderSize];
+    ZipArchive::writeUInt32(header, ZipArchive::LocalHeaderSignature);
+    ZipArchive::writeUInt16(header + 4, compress ? 20 : 10); // Version needed to extract
+    ZipArchive::writeUInt16(header + 6, 0);                  // General purpose flags
+    ZipArchive::writeUInt16(header + 8, compress ? 8 : 0);   // Method
+    ZipArchive::writeUInt16(header + 10, 0);                 // Time
+    ZipArchive::writeUInt16(header + 12, 0x0021);            // Date
+    ZipArchive::writeUInt32(header + 14, crc);
+    ZipArchive::writeUInt32(header + 18, static_cast<quint32>(content.size()));
+    ZipArchive::writeUInt32(header + 22, static_cast<quint32>(data.size()));
+    ZipArchive::writeUInt16(header + 26, nameLength);
+    ZipArchive::writeUInt16(header + 28, static_cast<quint16>(padding));
+
+    uchar central[ZipArchive::CentralHeaderSize];
+    memset(central, 0, sizeof(central));
+    ZipArchive::writeUInt32(central, ZipArchive::CentralHeaderSignature);
+    ZipArchive::writeUInt16(central + 4, 20); // Version made by
+    memcpy(central + 6, header + 4, 24);      // Version needed to extract ... name length
+    ZipArchive::writeUInt32(central + 42, static_cast<quint32>(position));
+    centralDirectory.append(reinterpret_cast<const char *>(central), sizeof(central));
+    centralDirectory.append(name);
+    ++entryCount;
+
+    return write(reinterpret_cast<const char *>(header), sizeof(header))
+        && write(name)
+        && write(QByteArray(padding, '\0'))
+        && write(content);
+}
+
+bool ZipWriter::write(const QByteArray &data)
+{
+    return write(data.constData(), data.size());
+}
+
+bool ZipWriter::finish(const QByteArray &comment)
+{
+    // Writes the central directory and the end of central directory record at the current position.
+
+    const QByteArray end = getEndOfCentralDirectory(position, comment);
+    if (end.isNull()) {
+        return fail("ZIP64 archives are not supported.");
+    }
+    return write(centralDirectory) && write(end);
+}
+
+qint64 ZipWriter::getPosition() const
+{
+    return position;
+}
+
+const QByteArray &ZipWriter::getCentralDirectory() const
+{
+    return centralDirectory;
+}
+
+QByteArray ZipWriter::getEndOfCentralDirectory(qint64 centralDirectoryOffset, const QByteArray &comment) const
+{
+    if (entryCount > 0xFFFF || centralDirectoryOffset + centralDirectory.size() > 0xFFFFFFFFll || comment.size() > 0xFFFF) {
+        return QByteArray();
+    }
+    QByteArray end(ZipArchive::EndOfCentralDirectorySize, '\0');
+    uchar *record = reinterpret_cast<uchar *>(end.data());
+    ZipArchive::writeUInt32(record, ZipArchive::EndOfCentralDirectorySignature);
+    ZipArchive::writeUInt16(record + 8, static_cast<quint16>(entryCount));
+    ZipArchive::writeUInt16(record + 10, static_cast<quint16>(entryCount));
+    ZipArchive::writeUInt32(record + 12, static_cast<quint32>(centralDirectory.size()));
+    ZipArchive::writeUInt32(record + 16, static_cast<quint32>(centralDirectoryOffset));
+    ZipArchive::writeUInt16(record + 20, static_cast<quint16>(comment.size()));
+    return end + comment;
+}
+
+const QString &ZipWriter::getError() const
+{
+    return error;
+}
+
+bool ZipWriter::write(const char *data, qint64 size)
+{
+    if (size == 0) {
+        return true;
+    }
+    if (device->write(data, size) != size) {
+        return fail(device->errorString());
+    }
+    if (observer) {
+        observer(data, size);
+    }
+    position += size;
+    return true;
+}
+
+QByteArray ZipWriter::deflate(const QByteArray &data)
+{
+    // Raw deflate stream (without the zlib header), as stored in ZIP entries.
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return QByteArray();
+    }
+    QByteArray result(static_cast<int>(deflateBound(&stream, static_cast<uLong>(data.size()))), '\0');
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.constData()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef *>(result.data());
+    stream.avail_out = static_cast<uInt>(result.size());
+    const int status = ::deflate(&stream, Z_FINISH);
+    const qint64 size = static_cast<qint64>(stream.total_out);
+    deflateEnd(&stream);
+    if (status != Z_STREAM_END) {
+        return QByteArray();
+    }
+    result.truncate(static_cast<int>(size));
+    return result;
+}
+
+int ZipWriter::getPadding(qint64 headerSize) const
+{
+    const qint64 dataPosition = position + headerSize;
+    return static_cast<int>((alignment - dataPosition % alignment) % alignment);
+}
+
+bool ZipWriter::fail(const QString &error)
+{
+    this->error = error;
+    return false;
+}
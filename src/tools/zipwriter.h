@@ -0,0 +1,41 @@
+#ifndef ZIPWRITER_H
+#define ZIPWRITER_H
+
+#include "tools/ziparchive.h"
+#include <functional>
+
+class ZipWriter
+{
+public:
+    typedef std::function<void(const char *data, qint64 size)> Observer;
+
+    ZipWriter(QIODevice *device, int alignment);
+
+    void setObserver(const Observer &observer);
+
+    bool copyEntry(const ZipArchive &archive, const ZipArchive::Entry &entry);
+    bool addEntry(const QByteArray &name, const QByteArray &data, bool compress = false);
+    bool write(const QByteArray &data);
+    bool finish(const QByteArray &comment);
+
+    qint64 getPosition() const;
+    const QByteArray &getCentralDirectory() const;
+    QByteArray getEndOfCentralDirectory(qint64 centralDirectoryOffset, const QByteArray &comment) const;
+    const QString &getError() const;
+
+private:
+    bool write(const char *data, qint64 size);
+    static QByteArray deflate(const QByteArray &data);
+    int getPadding(qint64 headerSize) const;
+    bool fail(const QString &error);
+
+    QIODevice *device;
+    int alignment;
+    Observer observer;
+    qint64 position;
+    int entryCount;
+    QByteArray centralDirectory;
+    QString error;
+};
+
+#endif // ZIPWRITER_H
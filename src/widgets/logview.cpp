@@ -60,8 +60,14 @@ void LogView::paintEvent(QPaintEvent *event)
     if (logModel && logModel->getLoadingState()) {
         QPainter painter(viewport());
         painter.setPen(Qt::NoPen);
-        painter.setBrush(QBrush(loading->currentValue().value<QColor>()));
         const int height = 4;
-        painter.drawRect(0, viewport()->height() - height, viewport()->width(), height);
+        const int progress = logModel->getLoadingProgress();
+        if (progress < 0) {
+            painter.setBrush(QBrush(loading->currentValue().value<QColor>()));
+            painter.drawRect(0, viewport()->height() - height, viewport()->width(), height);
+        } else {
+            painter.setBrush(QBrush(app->getColor(Application::ColorLogoPrimary)));
+            painter.drawRect(0, viewport()->height() - height, viewport()->width() * progress / 100, height);
+        }
     }
 }
@@ -1,6 +1,11 @@
 #include "widgets/projectswidget.h"
 #include "editors/fileeditor.h"
+#include "windows/devicemanager.h"
+#include "windows/dialogs.h"
+#include "windows/projectselector.h"
 #include "base/application.h"
+#include <QFutureWatcher>
+#include <QPointer>
 
 ProjectsWidget::ProjectsWidget(QWidget *parent) : QWidget(parent)
 {
@@ -94,6 +99,60 @@ bool ProjectsWidget::installCurrentProject()
     return getCurrentProjectTabs()->installProject();
 }
 
+bool ProjectsWidget::cancelCurrentProject()
+{
+    Project *project = getCurrentProject();
+    if (!project || !project->getState().canCancel()) {
+        return false;
+    }
+    project->cancel();
+    return true;
+}
+
+bool ProjectsWidget::decodeCurrentProject()
+{
+    Project *project = getCurrentProject();
+    if (!project || !project->getState().canSave() || project->getDecodeProfile() == Project::DecodeFull) {
+        return false;
+    }
+
+    // The decoded files replace the open ones, so the editors are closed first:
+
+    if (!getCurrentProjectTabs()->closeEditorTabs()) {
+        return false;
+    }
+
+    // The conflicts are collected in background, as the whole contents tree is compared with the opened APK.
+    // The project may be closed or busy by the time they are ready, so its state is checked again:
+
+    QPointer<Project> target(project);
+    auto conflicts = new QFutureWatcher<QStringList>(this);
+    connect(conflicts, &QFutureWatcher<QStringList>::finished, this, [=]() {
+        conflicts->deleteLater();
+        if (!target || !target->getState().canSave() || target->getDecodeProfile() == Project::DecodeFull) {
+            return;
+        }
+        const QStringList files = conflicts->result();
+        if (!files.isEmpty()) {
+            const int limit = 10;
+            QStringList list = files.mid(0, limit);
+            if (files.count() > limit) {
+                //: "%1" will be replaced with a number of files.
+                list.append(tr("...and %1 more.").arg(files.count() - limit));
+            }
+            //: "%1" will be replaced with a list of files.
+            const QString question = tr("The following changed files will be replaced by their decoded versions, "
+                                        "and the changes will be lost:\n\n%1\n\nDo you want to continue?").arg(list.join('\n'));
+            if (QMessageBox::question(this, QString(), question) != QMessageBox::Yes) {
+                return;
+            }
+        }
+        target->decodeFully();
+    });
+    conflicts->setFuture(project->getDecodeConflicts());
+    return true;
+}
+
 bool ProjectsWidget::exploreCurrentProject()
 {
     return getCurrentProjectTabs()->exploreProject();
@@ -104,6 +163,119 @@ bool ProjectsWidget::closeCurrentProject()
     return getCurrentProjectTabs()->closeProject();
 }
 
+bool ProjectsWidget::saveProjects()
+{
+    // Each of the selected projects is packed into the chosen directory. Their tasks are queued
+    // in the shared scheduler, so the projects are processed in parallel within its limits.
+
+    auto canSave = [](const Project *project) {
+        return project->getState().canSave();
+    };
+    const QList<Project *> projects = ProjectSelector::select(tr("Save APKs"), tr("Select the APKs to save:"), canSave, this);
+    if (projects.isEmpty() || !saveProjectTabs(projects)) {
+        return false;
+    }
+    const QString directory = Dialogs::getOpenDirectory(app->settings->getLastDirectory(), this);
+    if (directory.isEmpty()) {
+        return false;
+    }
+    const QStringList targets = getProjectTargets(projects, directory);
+    if (!confirmProjectTargets(targets) || !setProjectKeystores(projects)) {
+        return false;
+    }
+    for (int i = 0; i < projects.count(); ++i) {
+        projects.at(i)->save(targets.at(i));
+    }
+    return true;
+}
+
+bool ProjectsWidget::installProjects()
+{
+    auto canInstall = [](const Project *project) {
+        return project->getState().canInstall();
+    };
+    const QList<Project *> projects = ProjectSelector::select(tr("Install APKs"), tr("Select the APKs to install:"), canInstall, this);
+    if (projects.isEmpty()) {
+        return false;
+    }
+    DeviceManager deviceManager(this);
+    const QList<Device> devices = deviceManager.getTargetDevices();
+    if (devices.isEmpty()) {
+        return false;
+    }
+
+    // Projects with unsaved changes are optionally packed before installing:
+
+    QList<Project *> unsaved;
+    for (Project *project : projects) {
+        ProjectTabsWidget *tabs = map.value(project, nullptr);
+        if (tabs && tabs->isUnsaved()) {
+            unsaved.append(project);
+        }
+    }
+    if (!unsaved.isEmpty()) {
+        const QString question = tr("Do you want to save changes and pack the APKs before installing?");
+        const int answer = QMessageBox::question(this, QString(), question, QMessageBox::Yes | QMessageBox::No | QMessageBox::Cancel);
+        switch (answer) {
+        case QMessageBox::Yes: {
+            for (Project *project : unsaved) {
+                map.value(project)->saveTabs();
+            }
+            const QString directory = Dialogs::getOpenDirectory(app->settings->getLastDirectory(), this);
+            if (directory.isEmpty()) {
+                return false;
+            }
+            const QStringList targets = getProjectTargets(unsaved, directory);
+            if (!confirmProjectTargets(targets) || !setProjectKeystores(unsaved)) {
+                return false;
+            }
+            for (int i = 0; i < unsaved.count(); ++i) {
+                unsaved.at(i)->saveAndInstall(targets.at(i), devices);
+            }
+            break;
+        }
+        case QMessageBox::No:
+            unsaved.clear();
+            break;
+        default:
+            return false;
+        }
+    }
+
+    for (Project *project : projects) {
+        if (!unsaved.contains(project)) {
+            project->install(devices);
+        }
+    }
+    return true;
+}
+
+bool ProjectsWidget::replaceProjectIcons()
+{
+    auto canEdit = [](const Project *project) {
+        return project->getState().canEdit();
+    };
+    const QList<Project *> projects = ProjectSelector::select(tr("Replace Icons"), tr("Select the APKs to replace the application icons in:"), canEdit, this);
+    if (projects.isEmpty()) {
+        return false;
+    }
+    const QString path = Dialogs::getOpenImageFilename(this);
+    if (path.isEmpty()) {
+        return false;
+    }
+    QStringList failed;
+    for (Project *project : projects) {
+        if (!project->iconsProxy.replaceApplicationIcons(path)) {
+            failed.append(project->getTitle());
+        }
+    }
+    if (!failed.isEmpty()) {
+        QMessageBox::warning(this, QString(), tr("Could not replace the icons in the following APKs:\n%1").arg(failed.join('\n')));
+        return false;
+    }
+    return true;
+}
+
 bool ProjectsWidget::saveCurrentTab()
 {
     auto editor = qobject_cast<Editor *>(getCurrentProjectTab());
@@ -188,6 +360,115 @@ Viewer *ProjectsWidget::getCurrentProjectTab() const
     return tabs ? qobject_cast<Viewer *>(tabs->currentWidget()) : nullptr;
 }
 
+bool ProjectsWidget::saveProjectTabs(const QList<Project *> &projects)
+{
+    bool hasUnsavedTabs = false;
+    for (Project *project : projects) {
+        ProjectTabsWidget *tabs = map.value(project, nullptr);
+        if (tabs && tabs->hasUnsavedTabs()) {
+            hasUnsavedTabs = true;
+            break;
+        }
+    }
+    if (hasUnsavedTabs) {
+        const int answer = QMessageBox::question(this, QString(), tr("Do you want to save changes before packing?"), QMessageBox::Yes | QMessageBox::No | QMessageBox::Cancel);
+        switch (answer) {
+        case QMessageBox::Yes:
+            for (Project *project : projects) {
+                map.value(project)->saveTabs();
+            }
+            break;
+        case QMessageBox::No:
+            break;
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ProjectsWidget::setProjectKeystores(const QList<Project *> &projects)
+{
+    // The keystore details are requested once for all of the projects.
+
+    if (!app->settings->getSignApk()) {
+        return true;
+    }
+    const Keystore *keystore = Project::createKeystore();
+    if (!keystore) {
+        return false;
+    }
+    for (Project *project : projects) {
+        project->setKeystore(*keystore);
+    }
+    delete keystore;
+    return true;
+}
+
+QStringList ProjectsWidget::getProjectTargets(const QList<Project *> &projects, const QString &directory)
+{
+    // Projects are saved under their original file names; duplicate names (e.g., of the APKs
+    // opened from different directories) are numbered.
+
+    QStringList targets;
+    QSet<QString> names;
+    for (const Project *project : projects) {
+        const QFileInfo fileInfo(project->getOriginalPath());
+        QString filename = fileInfo.fileName();
+        for (int number = 2; names.contains(filename.toLower()); ++number) {
+            filename = QString("%1 (%2).%3").arg(fileInfo.completeBaseName()).arg(number).arg(fileInfo.suffix());
+        }
+        names.insert(filename.toLower());
+        targets.append(QDir::toNativeSeparators(QString("%1/%2").arg(directory, filename)));
+    }
+    return targets;
+}
+
+bool ProjectsWidget::confirmProjectTargets(const QStringList &targets)
+{
+    // The APKs of the open projects are never overwritten by the batch save: their contents are decoded from them
+    // and they may still be patched or decoded again. The other existing files are overwritten once confirmed.
+
+    auto join = [](const QStringList &paths) {
+        const int limit = 10;
+        QStringList list = paths.mid(0, limit);
+        if (paths.count() > limit) {
+            //: "%1" will be replaced with a number of files.
+            list.append(tr("...and %1 more.").arg(paths.count() - limit));
+        }
+        return list.join('\n');
+    };
+
+    QStringList originals;
+    QStringList existing;
+    for (const QString &target : targets) {
+        const QFileInfo fileInfo(target);
+        bool isOriginal = false;
+        for (const Project *project : map.keys()) {
+            isOriginal |= (QFileInfo(project->getOriginalPath()) == fileInfo);
+        }
+        if (isOriginal) {
+            originals.append(target);
+        } else if (fileInfo.exists()) {
+            existing.append(target);
+        }
+    }
+
+    if (!originals.isEmpty()) {
+        //: "%1" will be replaced with a list of files.
+        const QString message = tr("The following files are the original APKs of the open projects and can't be overwritten:\n\n%1\n\n"
+                                   "Please choose a different directory.").arg(join(originals));
+        QMessageBox::warning(this, QString(), message);
+        return false;
+    }
+    if (!existing.isEmpty()) {
+        //: "%1" will be replaced with a list of files.
+        const QString question = tr("The following files already exist:\n\n%1\n\nDo you want to replace them?").arg(join(existing));
+        return QMessageBox::question(this, QString(), question) == QMessageBox::Yes;
+    }
+    return true;
+}
+
 void ProjectsWidget::retranslate()
 {
     actionSave->setText(tr("&Save"));
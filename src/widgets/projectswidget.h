@@ -21,9 +21,15 @@ public:
 
     bool saveCurrentProject();
     bool installCurrentProject();
+    bool cancelCurrentProject();
+    bool decodeCurrentProject();
     bool exploreCurrentProject();
     bool closeCurrentProject();
 
+    bool saveProjects();
+    bool installProjects();
+    bool replaceProjectIcons();
+
     bool saveCurrentTab();
     bool saveCurrentTabAs();
 
@@ -45,6 +51,10 @@ protected:
 private:
     ProjectTabsWidget *getCurrentProjectTabs() const;
     Viewer *getCurrentProjectTab() const;
+    bool saveProjectTabs(const QList<Project *> &projects);
+    bool setProjectKeystores(const QList<Project *> &projects);
+    static QStringList getProjectTargets(const QList<Project *> &projects, const QString &directory);
+    bool confirmProjectTargets(const QStringList &targets);
 
     void retranslate();
 
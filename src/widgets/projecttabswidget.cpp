@@ -90,6 +90,19 @@ bool ProjectTabsWidget::saveTabs()
     return result;
 }
 
+bool ProjectTabsWidget::closeEditorTabs()
+{
+    // Unsaved editors ask whether to save their changes first. Returns false if any of the editors is kept open.
+
+    for (int index = count() - 1; index >= 0; --index) {
+        Editor *tab = qobject_cast<Editor *>(widget(index));
+        if (tab && !closeTab(tab)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool ProjectTabsWidget::isUnsaved() const
 {
     return project->getState().isModified() || hasUnsavedTabs();
@@ -122,8 +135,8 @@ bool ProjectTabsWidget::saveProject()
 bool ProjectTabsWidget::installProject()
 {
     DeviceManager devices(this);
-    const Device *device = devices.getTargetDevice();
-    if (!device) {
+    const QList<Device> targets = devices.getTargetDevices();
+    if (targets.isEmpty()) {
         return false;
     }
 
@@ -138,7 +151,7 @@ bool ProjectTabsWidget::installProject()
             if (target.isEmpty()) {
                 return false;
             }
-            project->saveAndInstall(target, device->getSerial());
+            project->saveAndInstall(target, targets);
             return true;
         }
         case QMessageBox::No:
@@ -149,7 +162,7 @@ bool ProjectTabsWidget::installProject()
         }
     }
 
-    project->install(device->getSerial());
+    project->install(targets);
     return true;
 }
 
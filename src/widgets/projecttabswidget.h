@@ -18,7 +18,9 @@ public:
     Viewer *openResourceTab(const ResourceModelIndex &index);
 
     bool saveTabs();
+    bool closeEditorTabs();
     bool isUnsaved() const;
+    bool hasUnsavedTabs() const;
 
     bool saveProject();
     bool installProject();
@@ -28,7 +30,6 @@ public:
 private:
     int addTab(Viewer *tab);
     bool closeTab(Viewer *editor);
-    bool hasUnsavedTabs() const;
     Viewer *getTabByIdentifier(const QString &identifier) const;
 
     Project *project;
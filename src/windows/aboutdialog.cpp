@@ -204,6 +204,7 @@ QWidget *AboutDialog::createLibrariesTab()
         labelApktool->setText(!versionApktool.isEmpty() ? versionApktool : mdash);
 
         Adb adb(app->settings->getAdbPath());
+        adb.setTimeout(app->settings->getTaskTimeout("Devices"));
         const QString versionAdb = adb.version();
         labelAdb->setText(!versionAdb.isEmpty() ? versionAdb : mdash);
     });
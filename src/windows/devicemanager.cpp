@@ -6,6 +6,7 @@
 #include <QPushButton>
 #include <QLineEdit>
 #include <QHeaderView>
+#include <algorithm>
 
 DeviceManager::DeviceManager(QWidget *parent) : QDialog(parent)
 {
@@ -80,27 +81,38 @@ void DeviceManager::refreshDevices()
     deviceModel.refresh();
 }
 
-const Device *DeviceManager::getTargetDevice()
+QList<Device> DeviceManager::getTargetDevices()
 {
+    // Several devices can be selected to install the APK to all of them at once.
+
     setWindowTitle(tr("Install APK"));
     setWindowIcon(app->icons.get("install.png"));
 
+    deviceList->setSelectionMode(QAbstractItemView::ExtendedSelection);
+
     QPushButton *btnInstall = dialogButtons->button(QDialogButtonBox::Ok);
     btnInstall->setText(tr("Install"));
     btnInstall->setIcon(app->icons.get("install.png"));
     btnInstall->setEnabled(false);
 
-    connect(deviceList->selectionModel(), &QItemSelectionModel::currentChanged, [=](const QModelIndex &index) {
-        const Device *device = deviceModel.get(index);
-        btnInstall->setEnabled(device);
-    });
+    auto updateButton = [=]() {
+        btnInstall->setEnabled(deviceList->selectionModel()->hasSelection());
+    };
+    connect(deviceList->selectionModel(), &QItemSelectionModel::selectionChanged, updateButton);
+    connect(&deviceModel, &DeviceItemsModel::rowsRemoved, updateButton);
 
+    QList<Device> devices;
     if (exec() == QDialog::Accepted) {
-        const Device *device = deviceModel.get(deviceList->currentIndex());
-        return device;
+        QModelIndexList indexes = deviceList->selectionModel()->selectedRows();
+        std::sort(indexes.begin(), indexes.end());
+        for (const QModelIndex &index : indexes) {
+            const Device *device = deviceModel.get(index);
+            if (device) {
+                devices.append(*device);
+            }
+        }
     }
-
-    return nullptr;
+    return devices;
 }
 
 bool DeviceManager::setCurrentDevice(const Device *device)
@@ -15,7 +15,7 @@ public:
     explicit DeviceManager(QWidget *parent = nullptr);
 
     void refreshDevices();
-    const Device *getTargetDevice();
+    QList<Device> getTargetDevices();
 
 private:
     bool setCurrentDevice(const Device *device);
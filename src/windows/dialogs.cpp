@@ -121,6 +121,18 @@ bool Dialogs::openApk(const QString &defaultPath, QWidget *parent)
     return true;
 }
 
+bool Dialogs::openApk(Project::DecodeProfile profile, QWidget *parent)
+{
+    const QStringList paths = getOpenApkFilenames(parent);
+    if (paths.isEmpty()) {
+        return false;
+    }
+    for (const QString &path : paths) {
+        app->openApk(path, true, profile);
+    }
+    return true;
+}
+
 QString Dialogs::getOpenDirectory(const QString &defaultPath, QWidget *parent)
 {
     const QString path = makePath(defaultPath);
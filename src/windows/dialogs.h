@@ -28,6 +28,7 @@ namespace Dialogs
 
     bool openApk(QWidget *parent = nullptr);
     bool openApk(const QString &defaultPath, QWidget *parent = nullptr);
+    bool openApk(Project::DecodeProfile profile, QWidget *parent = nullptr);
 
     QString getOpenDirectory(const QString &defaultPath, QWidget *parent = nullptr);
 
@@ -155,10 +155,15 @@ void MainWindow::initMenus()
     actionApkOpen->setShortcut(QKeySequence::Open);
     actionApkSave = new QAction(app->icons.get("pack.png"), QString(), this);
     actionApkSave->setShortcut(QKeySequence("Ctrl+Alt+S"));
+    actionApkSaveAll = new QAction(app->icons.get("pack.png"), QString(), this);
     actionApkInstall = new QAction(app->icons.get("install.png"), QString(), this);
     actionApkInstall->setShortcut(QKeySequence("Ctrl+I"));
     actionApkInstallExternal = new QAction(app->icons.get("install.png"), QString(), this);
     actionApkInstallExternal->setShortcut(QKeySequence("Ctrl+Shift+I"));
+    actionApkInstallAll = new QAction(app->icons.get("install.png"), QString(), this);
+    actionApkCancel = new QAction(app->icons.get("close.png"), QString(), this);
+    actionApkCancel->setShortcut(QKeySequence("Ctrl+Alt+C"));
+    actionApkDecode = new QAction(app->icons.get("open.png"), QString(), this);
     actionApkExplore = new QAction(app->icons.get("explore.png"), QString(), this);
     actionApkExplore->setShortcut(QKeySequence("Ctrl+E"));
     actionApkClose = new QAction(app->icons.get("close-project.png"), QString(), this);
@@ -167,6 +172,17 @@ void MainWindow::initMenus()
     actionExit->setShortcut(QKeySequence::Quit);
     actionExit->setMenuRole(QAction::QuitRole);
 
+    // Open As Menu:
+
+    menuOpenAs = new QMenu(this);
+    menuOpenAs->setIcon(app->icons.get("open.png"));
+    actionOpenManifest = new QAction(this);
+    actionOpenResources = new QAction(this);
+    actionOpenFull = new QAction(this);
+    menuOpenAs->addAction(actionOpenManifest);
+    menuOpenAs->addAction(actionOpenResources);
+    menuOpenAs->addAction(actionOpenFull);
+
     // Recent Menu:
 
     menuRecent = new QMenu(this);
@@ -189,6 +205,8 @@ void MainWindow::initMenus()
     actionTitleEditor = new QAction(this);
     actionTitleEditor->setIcon(app->icons.get("title.png"));
     actionTitleEditor->setShortcut(QKeySequence("Ctrl+T"));
+    actionIconsReplaceAll = new QAction(this);
+    actionIconsReplaceAll->setIcon(app->icons.get("application.png"));
 
     // Settings Menu:
 
@@ -215,12 +233,18 @@ void MainWindow::initMenus()
 
     menuFile = menuBar()->addMenu(QString());
     menuFile->addAction(actionApkOpen);
+    menuFile->addMenu(menuOpenAs);
     menuFile->addMenu(menuRecent);
     menuFile->addSeparator();
     menuFile->addAction(actionApkSave);
+    menuFile->addAction(actionApkSaveAll);
     menuFile->addSeparator();
     menuFile->addAction(actionApkInstall);
     menuFile->addAction(actionApkInstallExternal);
+    menuFile->addAction(actionApkInstallAll);
+    menuFile->addSeparator();
+    menuFile->addAction(actionApkCancel);
+    menuFile->addAction(actionApkDecode);
     menuFile->addSeparator();
     menuFile->addAction(actionApkExplore);
     menuFile->addSeparator();
@@ -235,6 +259,7 @@ void MainWindow::initMenus()
     menuTools->addSeparator();
     menuTools->addAction(actionProjectManager);
     menuTools->addAction(actionTitleEditor);
+    menuTools->addAction(actionIconsReplaceAll);
     menuSettings = menuBar()->addMenu(QString());
     menuSettings->addAction(actionOptions);
     menuSettings->addSeparator();
@@ -274,9 +299,17 @@ void MainWindow::initMenus()
     // Signals / Slots
 
     connect(actionApkOpen, &QAction::triggered, [=]() { Dialogs::openApk(this); });
+    connect(actionOpenManifest, &QAction::triggered, [=]() { Dialogs::openApk(Project::DecodeManifest, this); });
+    connect(actionOpenResources, &QAction::triggered, [=]() { Dialogs::openApk(Project::DecodeResources, this); });
+    connect(actionOpenFull, &QAction::triggered, [=]() { Dialogs::openApk(Project::DecodeFull, this); });
     connect(actionApkSave, &QAction::triggered, projectsWidget, &ProjectsWidget::saveCurrentProject);
     connect(actionApkInstall, &QAction::triggered, projectsWidget, &ProjectsWidget::installCurrentProject);
     connect(actionApkInstallExternal, &QAction::triggered, app, &Application::installExternalApk);
+    connect(actionApkSaveAll, &QAction::triggered, projectsWidget, &ProjectsWidget::saveProjects);
+    connect(actionApkInstallAll, &QAction::triggered, projectsWidget, &ProjectsWidget::installProjects);
+    connect(actionIconsReplaceAll, &QAction::triggered, projectsWidget, &ProjectsWidget::replaceProjectIcons);
+    connect(actionApkCancel, &QAction::triggered, projectsWidget, &ProjectsWidget::cancelCurrentProject);
+    connect(actionApkDecode, &QAction::triggered, projectsWidget, &ProjectsWidget::decodeCurrentProject);
     connect(actionApkExplore, &QAction::triggered, projectsWidget, &ProjectsWidget::exploreCurrentProject);
     connect(actionApkClose, &QAction::triggered, projectsWidget, &ProjectsWidget::closeCurrentProject);
     connect(actionExit, &QAction::triggered, this, &MainWindow::close);
@@ -361,10 +394,21 @@ void MainWindow::retranslate()
     actionApkSave->setText(tr("&Save APK..."));
     actionApkInstall->setText(tr("&Install APK..."));
     actionApkInstallExternal->setText(tr("Install &External APK..."));
+    actionApkSaveAll->setText(tr("Save &Multiple APKs..."));
+    actionApkInstallAll->setText(tr("Install M&ultiple APKs..."));
+    actionApkCancel->setText(tr("C&ancel Operation"));
+    actionApkDecode->setText(tr("&Decode Fully"));
     actionApkExplore->setText(tr("O&pen Contents"));
     actionApkClose->setText(tr("&Close APK"));
     actionExit->setText(tr("E&xit"));
 
+    // Open As Menu:
+
+    menuOpenAs->setTitle(tr("Open APK &As"));
+    actionOpenManifest->setText(tr("&Manifest Only..."));
+    actionOpenResources->setText(tr("&Resources Only..."));
+    actionOpenFull->setText(tr("&Full Decode..."));
+
     // Recent Menu:
 
     menuRecent->setTitle(tr("Open &Recent"));
@@ -380,6 +424,7 @@ void MainWindow::retranslate()
     //: This string refers to a single project (as in "Manager of a project").
     actionProjectManager->setText(tr("&Project Manager"));
     actionTitleEditor->setText(tr("Edit Application &Title"));
+    actionIconsReplaceAll->setText(tr("Replace Icons in &Multiple APKs..."));
 
     // Settings Menu:
 
@@ -436,6 +481,7 @@ Viewer *MainWindow::openResource(const QModelIndex &index)
 
 bool MainWindow::setCurrentProject(Project *project)
 {
+    app->scheduler.setForeground(project);
     updateWindowForProject(project);
     resourceTree->setModel(project ? &project->resourcesModel : nullptr);
     filesystemTree->setModel(project ? &project->filesystemModel : nullptr);
@@ -452,10 +498,15 @@ void MainWindow::setActionsEnabled(const Project *project)
 {
     actionApkSave->setEnabled(project ? project->getState().canSave() : false);
     actionApkInstall->setEnabled(project ? project->getState().canInstall() : false);
+    actionApkCancel->setEnabled(project ? project->getState().canCancel() : false);
+    actionApkDecode->setEnabled(project ? project->getState().canSave() && project->getDecodeProfile() != Project::DecodeFull : false);
     actionApkExplore->setEnabled(project ? project->getState().canExplore() : false);
     actionApkClose->setEnabled(project ? project->getState().canClose() : false);
     actionTitleEditor->setEnabled(project ? project->getState().canEdit() : false);
     actionProjectManager->setEnabled(project);
+    actionApkSaveAll->setEnabled(app->projects.rowCount() > 0);
+    actionApkInstallAll->setEnabled(app->projects.rowCount() > 0);
+    actionIconsReplaceAll->setEnabled(app->projects.rowCount() > 0);
 }
 
 void MainWindow::updateWindowForProject(const Project *project)
@@ -68,20 +68,29 @@ private:
     QMenu *menuWindow;
     QMenu *menuHelp;
     QMenu *menuRecent;
+    QMenu *menuOpenAs;
     QMenu *menuLanguage;
     QAction *actionApkOpen;
     QAction *actionApkSave;
+    QAction *actionApkSaveAll;
     QAction *actionApkInstall;
     QAction *actionApkInstallExternal;
+    QAction *actionApkInstallAll;
+    QAction *actionApkCancel;
+    QAction *actionApkDecode;
     QAction *actionApkExplore;
     QAction *actionApkClose;
     QAction *actionExit;
     QAction *actionRecentClear;
     QAction *actionRecentNone;
+    QAction *actionOpenManifest;
+    QAction *actionOpenResources;
+    QAction *actionOpenFull;
     QAction *actionKeyManager;
     QAction *actionDeviceManager;
     QAction *actionProjectManager;
     QAction *actionTitleEditor;
+    QAction *actionIconsReplaceAll;
     QAction *actionOptions;
     QAction *actionSettingsReset;
     QAction *actionWebsite;
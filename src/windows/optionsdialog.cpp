@@ -75,7 +75,9 @@ void OptionsDialog::load()
     fileboxOutput->setDefaultPath(app->settings->getDefaultOutputDirectory());
     fileboxFrameworks->setCurrentPath(app->settings->getFrameworksDirectory());
     fileboxFrameworks->setDefaultPath(app->getLocalConfigPath("frameworks"));
-    checkboxSources->setChecked(app->settings->getDecompileSources());
+    comboProfile->setCurrentIndex(comboProfile->findData(app->settings->getDecodeProfile()));
+    checkboxIncremental->setChecked(app->settings->getIncrementalRepack());
+    spinboxCache->setValue(app->settings->getUnpackCacheSize());
 
     // Signing
 
@@ -88,6 +90,7 @@ void OptionsDialog::load()
     groupZipalign->setChecked(app->settings->getOptimizeApk());
     fileboxZipalign->setCurrentPath(app->settings->getZipalignPath());
     fileboxZipalign->setDefaultPath(app->getBinaryPath("zipalign"));
+    checkboxSinglePass->setChecked(app->settings->getSinglePassOutput());
 
     // Installing
 
@@ -145,7 +148,9 @@ void OptionsDialog::save()
     app->settings->setApktoolPath(fileboxApktool->getCurrentPath());
     app->settings->setOutputDirectory(fileboxOutput->getCurrentPath());
     app->settings->setFrameworksDirectory(fileboxFrameworks->getCurrentPath());
-    app->settings->setDecompileSources(checkboxSources->isChecked());
+    app->settings->setDecodeProfile(comboProfile->currentData().toString());
+    app->settings->setIncrementalRepack(checkboxIncremental->isChecked());
+    app->settings->setUnpackCacheSize(spinboxCache->value());
 
     // Signing
 
@@ -156,6 +161,7 @@ void OptionsDialog::save()
 
     app->settings->setOptimizeApk(groupZipalign->isChecked());
     app->settings->setZipalignPath(fileboxZipalign->getCurrentPath());
+    app->settings->setSinglePassOutput(checkboxSinglePass->isChecked());
 
     // Installing
 
@@ -235,12 +241,23 @@ void OptionsDialog::initialize()
     fileboxApktool = new FileBox(QString(), QString(), false, this);
     fileboxOutput = new FileBox(QString(), QString(), true, this);
     fileboxFrameworks = new FileBox(QString(), QString(), true, this);
-    checkboxSources = new QCheckBox(tr("Decompile source code (smali)"), this);
+    comboProfile = new QComboBox(this);
+    comboProfile->addItem(Project::getDecodeProfileTitle(Project::DecodeManifest), "manifest");
+    comboProfile->addItem(Project::getDecodeProfileTitle(Project::DecodeResources), "resources");
+    comboProfile->addItem(Project::getDecodeProfileTitle(Project::DecodeFull), "full");
+    checkboxIncremental = new QCheckBox(tr("Patch the original APK if only images or assets were changed"), this);
+    spinboxCache = new QSpinBox(this);
+    spinboxCache->setRange(0, 1024 * 1024);
+    spinboxCache->setSingleStep(256);
+    //: "MiB" stands for mebibytes. Zero disables the cache.
+    spinboxCache->setSuffix(tr(" MiB"));
     //: "Apktool" is the name of the tool, don't translate it.
     pageRepack->addRow(tr("Apktool path:"), fileboxApktool);
     pageRepack->addRow(tr("Extraction path:"), fileboxOutput);
     pageRepack->addRow(tr("Frameworks path:"), fileboxFrameworks);
-    pageRepack->addRow(checkboxSources);
+    pageRepack->addRow(tr("Unpack cache size:"), spinboxCache);
+    pageRepack->addRow(tr("Decode profile:"), comboProfile);
+    pageRepack->addRow(checkboxIncremental);
     pageRepack->setFieldGrowthPolicy(QFormLayout::ExpandingFieldsGrow);
     tr("Java path:"); // TODO For future usage
 
@@ -273,7 +290,9 @@ void OptionsDialog::initialize()
     fileboxZipalign = new FileBox(QString(), QString(), false, this);
     QFormLayout *layoutZipalign = new QFormLayout(groupZipalign);
     //: "Zipalign" is the name of the tool, don't translate it.
+    checkboxSinglePass = new QCheckBox(tr("Optimize and sign APK in a single pass"), this);
     layoutZipalign->addRow(tr("Zipalign path:"), fileboxZipalign);
+    layoutZipalign->addRow(checkboxSinglePass);
     layoutZipalign->setFieldGrowthPolicy(QFormLayout::ExpandingFieldsGrow);
     pageZipalign->addWidget(groupZipalign);
 
@@ -48,13 +48,16 @@ private:
     FileBox *fileboxApktool;
     FileBox *fileboxOutput;
     FileBox *fileboxFrameworks;
-    QCheckBox *checkboxSources;
+    QComboBox *comboProfile;
+    QCheckBox *checkboxIncremental;
+    QSpinBox *spinboxCache;
 
     QGroupBox *groupSign;
     QGroupBox *groupZipalign;
     FileBox *fileboxApksigner;
 
     FileBox *fileboxZipalign;
+    QCheckBox *checkboxSinglePass;
 
     FileBox *fileboxAdb;
 
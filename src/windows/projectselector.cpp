@@ -0,0 +1,82 @@
+#include "windows/projectselector.h"
+#include "base/application.h"
+#include <QLabel>
+#include <QBoxLayout>
+#include <QDialogButtonBox>
+#include <QPushButton>
+
+ProjectSelector::ProjectSelector(const QString &title, const QString &text, QWidget *parent) : QDialog(parent)
+{
+    setWindowTitle(title);
+    setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+    resize(app->scale(400, 300));
+
+    auto layout = new QVBoxLayout(this);
+
+    layout->addWidget(new QLabel(text, this));
+
+    list = new QListWidget(this);
+    list->setIconSize(app->scale(32, 32));
+    layout->addWidget(list);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    QPushButton *btnAll = buttons->addButton(tr("Select All"), QDialogButtonBox::ResetRole);
+    connect(btnAll, &QPushButton::clicked, [=]() {
+        for (int row = 0; row < list->count(); ++row) {
+            QListWidgetItem *item = list->item(row);
+            if (item->flags() & Qt::ItemIsEnabled) {
+                item->setCheckState(Qt::Checked);
+            }
+        }
+    });
+    connect(list, &QListWidget::itemChanged, [=]() {
+        buttons->button(QDialogButtonBox::Ok)->setEnabled(!getSelectedProjects().isEmpty());
+    });
+    connect(buttons, &QDialogButtonBox::accepted, this, &ProjectSelector::accept);
+    connect(buttons, &QDialogButtonBox::rejected, this, &ProjectSelector::reject);
+    layout->addWidget(buttons);
+}
+
+QList<Project *> ProjectSelector::select(const QString &title, const QString &text, const std::function<bool(const Project *)> &isAvailable, QWidget *parent)
+{
+    ProjectSelector dialog(title, text, parent);
+    QList<Project *> projects;
+    for (int row = 0; row < app->projects.rowCount(); ++row) {
+        projects.append(static_cast<Project *>(app->projects.index(row).internalPointer()));
+    }
+    dialog.addProjects(projects, isAvailable);
+    if (dialog.exec() == QDialog::Accepted) {
+        return dialog.getSelectedProjects();
+    }
+    return QList<Project *>();
+}
+
+void ProjectSelector::addProjects(const QList<Project *> &projects, const std::function<bool(const Project *)> &isAvailable)
+{
+    // Projects which are busy or not unpacked are shown, but can't be selected.
+
+    for (Project *project : projects) {
+        auto item = new QListWidgetItem(project->getThumbnail(), project->getTitle());
+        item->setToolTip(project->getOriginalPath());
+        if (isAvailable(project)) {
+            item->setFlags(Qt::ItemIsEnabled | Qt::ItemIsUserCheckable);
+            item->setCheckState(Qt::Checked);
+        } else {
+            item->setFlags(Qt::ItemIsUserCheckable);
+            item->setCheckState(Qt::Unchecked);
+        }
+        list->addItem(item);
+        this->projects.append(project);
+    }
+}
+
+QList<Project *> ProjectSelector::getSelectedProjects() const
+{
+    QList<Project *> selected;
+    for (int row = 0; row < list->count(); ++row) {
+        if (list->item(row)->checkState() == Qt::Checked) {
+            selected.append(projects.at(row));
+        }
+    }
+    return selected;
+}
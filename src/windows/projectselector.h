@@ -0,0 +1,26 @@
+#ifndef PROJECTSELECTOR_H
+#define PROJECTSELECTOR_H
+
+#include "apk/project.h"
+#include <QDialog>
+#include <QListWidget>
+#include <functional>
+
+class ProjectSelector : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ProjectSelector(const QString &title, const QString &text, QWidget *parent = nullptr);
+
+    static QList<Project *> select(const QString &title, const QString &text, const std::function<bool(const Project *)> &isAvailable, QWidget *parent = nullptr);
+
+    void addProjects(const QList<Project *> &projects, const std::function<bool(const Project *)> &isAvailable);
+    QList<Project *> getSelectedProjects() const;
+
+private:
+    QListWidget *list;
+    QList<Project *> projects;
+};
+
+#endif // PROJECTSELECTOR_H
@@ -0,0 +1,14 @@
+include(../tests.pri)
+
+TARGET = tst_apkinfo
+
+SOURCES += \
+    tst_apkinfo.cpp \
+    $$SRC/tools/apkinfo.cpp \
+    $$SRC/tools/ziparchive.cpp
+
+HEADERS += \
+    $$SRC/tools/apkinfo.h \
+    $$SRC/tools/ziparchive.h
+
+unix: LIBS += -lz
@@ -0,0 +1,97 @@
+#include "tools/apkinfo.h"
+#include <QtTest>
+
+// Tests of the compiled manifest and resource table reader on sample APKs:
+//   utf8.apk: UTF-8 string pools, two-byte string lengths, localized label, chained references, bitmaps of two densities
+//   utf16.apk: UTF-16 string pools, attributes without the resource map, hexadecimal and string integers
+//   sparse.apk: sparse string type, 16-bit entry offsets and compact entries in the mipmap type
+//   adaptive.apk: adaptive icon with the foreground and background bitmaps of different sizes
+//   truncated.apk: manifest cut in the middle of its string pool
+//   corrupt.apk: manifest with an invalid chunk size
+//   notanapk.apk: not a ZIP archive
+
+class TestApkInfo : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void read_data();
+    void read();
+    void readInvalid_data();
+    void readInvalid();
+};
+
+void TestApkInfo::read_data()
+{
+    QTest::addColumn<QString>("sample");
+    QTest::addColumn<QString>("packageName");
+    QTest::addColumn<QString>("applicationLabel");
+    QTest::addColumn<int>("versionCode");
+    QTest::addColumn<QString>("versionName");
+    QTest::addColumn<int>("minSdk");
+    QTest::addColumn<int>("targetSdk");
+    QTest::addColumn<int>("iconSize");
+
+    QTest::newRow("UTF-8 strings")
+        << QString("utf8.apk") << QString("com.example.utf8") << QString::fromUtf8("Café 例")
+        << 12 << QString("1.2.3-") + QString(130, QChar(0x00FC)) << 21 << 33 << 96;
+    QTest::newRow("UTF-16 strings")
+        << QString("utf16.apk") << QString("com.example.utf16") << QString::fromUtf8("Ünïcode ✓")
+        << 32 << QString("2.0") << 19 << 30 << 32;
+    QTest::newRow("sparse type")
+        << QString("sparse.apk") << QString("com.example.sparse") << QString("Sparse")
+        << 3 << QString("3.0") << 24 << 34 << 72;
+    QTest::newRow("adaptive icon")
+        << QString("adaptive.apk") << QString("com.example.adaptive") << QString("Adaptive")
+        << 1 << QString("1.0") << 26 << 34 << 72;
+}
+
+void TestApkInfo::read()
+{
+    QFETCH(QString, sample);
+    QFETCH(QString, packageName);
+    QFETCH(QString, applicationLabel);
+    QFETCH(int, versionCode);
+    QFETCH(QString, versionName);
+    QFETCH(int, minSdk);
+    QFETCH(int, targetSdk);
+    QFETCH(int, iconSize);
+
+    const ApkInfo info = ApkInfo::read(QFINDTESTDATA("data/" + sample));
+    QVERIFY2(info.isValid(), qPrintable(info.getError()));
+    QCOMPARE(info.getPackageName(), packageName);
+    QCOMPARE(info.getApplicationLabel(), applicationLabel);
+    QCOMPARE(info.getVersionCode(), versionCode);
+    QCOMPARE(info.getVersionName(), versionName);
+    QCOMPARE(info.getMinSdk(), minSdk);
+    QCOMPARE(info.getTargetSdk(), targetSdk);
+
+    // Icon sizes differ between the densities, so the size tells which of the bitmaps was chosen:
+
+    QVERIFY(!info.getIcon().isNull());
+    QCOMPARE(info.getIcon().size(), QSize(iconSize, iconSize));
+}
+
+void TestApkInfo::readInvalid_data()
+{
+    QTest::addColumn<QString>("sample");
+
+    QTest::newRow("truncated manifest") << QString("truncated.apk");
+    QTest::newRow("corrupt manifest") << QString("corrupt.apk");
+    QTest::newRow("not an archive") << QString("notanapk.apk");
+}
+
+void TestApkInfo::readInvalid()
+{
+    QFETCH(QString, sample);
+
+    const ApkInfo info = ApkInfo::read(QFINDTESTDATA("data/" + sample));
+    QVERIFY(!info.isValid());
+    QVERIFY(!info.getError().isEmpty());
+    QVERIFY(info.getPackageName().isEmpty());
+    QVERIFY(info.getIcon().isNull());
+}
+
+QTEST_GUILESS_MAIN(TestApkInfo)
+
+#include "tst_apkinfo.moc"
@@ -0,0 +1,18 @@
+include(../tests.pri)
+
+QT -= gui
+
+TARGET = tst_apkpatcher
+
+SOURCES += \
+    tst_apkpatcher.cpp \
+    $$SRC/tools/apkpatcher.cpp \
+    $$SRC/tools/ziparchive.cpp \
+    $$SRC/tools/zipwriter.cpp
+
+HEADERS += \
+    $$SRC/tools/apkpatcher.h \
+    $$SRC/tools/ziparchive.h \
+    $$SRC/tools/zipwriter.h
+
+unix: LIBS += -lz
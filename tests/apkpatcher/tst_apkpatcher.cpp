@@ -0,0 +1,237 @@
+#include "tools/apkpatcher.h"
+#include "tools/ziparchive.h"
+#include <QTemporaryDir>
+#include <QtTest>
+
+// Tests of the in-place APK patching on a sample archive with stored and compressed entries,
+// signature files and an archive comment (original.apk).
+
+class TestApkPatcher : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void getEntryName_data();
+    void getEntryName();
+    void isPatchable_data();
+    void isPatchable();
+    void patch();
+    void patchMissingFile();
+    void getFingerprint();
+
+private:
+    static bool write(const QString &path, const QByteArray &data);
+    static QByteArray read(const ZipArchive &archive, const ZipArchive::Entry &entry);
+    static QHash<QByteArray, ZipArchive::Entry> index(const ZipArchive &archive);
+};
+
+void TestApkPatcher::getEntryName_data()
+{
+    QTest::addColumn<QString>("path");
+    QTest::addColumn<QString>("name");
+
+    QTest::newRow("asset") << QString("assets/data.txt") << QString("assets/data.txt");
+    QTest::newRow("native library") << QString("lib/x86/libfoo.so") << QString("lib/x86/libfoo.so");
+    QTest::newRow("unknown file") << QString("unknown/extra/file.bin") << QString("extra/file.bin");
+    QTest::newRow("bitmap") << QString("res/drawable/icon.png") << QString("res/drawable/icon.png");
+    QTest::newRow("dex") << QString("classes2.dex") << QString("classes2.dex");
+    QTest::newRow("nine-patch") << QString("res/drawable/button.9.png") << QString();
+    QTest::newRow("XML resource") << QString("res/layout/main.xml") << QString();
+    QTest::newRow("values") << QString("res/values/strings.xml") << QString();
+    QTest::newRow("manifest") << QString("AndroidManifest.xml") << QString();
+    QTest::newRow("smali") << QString("smali/com/example/Main.smali") << QString();
+}
+
+void TestApkPatcher::getEntryName()
+{
+    QFETCH(QString, path);
+    QFETCH(QString, name);
+
+    QCOMPARE(ApkPatcher::getEntryName(path), name);
+    QCOMPARE(ApkPatcher::getEntryName(path).isNull(), name.isNull());
+}
+
+void TestApkPatcher::isPatchable_data()
+{
+    QTest::addColumn<QStringList>("modified");
+    QTest::addColumn<QStringList>("added");
+    QTest::addColumn<QStringList>("removed");
+    QTest::addColumn<bool>("patchable");
+
+    QTest::newRow("raw files")
+        << QStringList{"res/drawable/icon.png", "assets/data.txt", "classes.dex"}
+        << QStringList{"assets/new.txt", "lib/x86/libbar.so", "unknown/extra.bin"}
+        << QStringList{"assets/old.txt"} << true;
+    QTest::newRow("modified manifest") << QStringList{"AndroidManifest.xml"} << QStringList() << QStringList() << false;
+    QTest::newRow("modified layout") << QStringList{"res/layout/main.xml"} << QStringList() << QStringList() << false;
+    QTest::newRow("modified values") << QStringList{"res/values/strings.xml"} << QStringList() << QStringList() << false;
+    QTest::newRow("modified smali") << QStringList{"smali/com/example/Main.smali"} << QStringList() << QStringList() << false;
+    QTest::newRow("modified missing entry") << QStringList{"assets/missing.txt"} << QStringList() << QStringList() << false;
+    QTest::newRow("added resource") << QStringList() << QStringList{"res/drawable/new.png"} << QStringList() << false;
+    QTest::newRow("added dex") << QStringList() << QStringList{"classes2.dex"} << QStringList() << false;
+    QTest::newRow("added existing entry") << QStringList() << QStringList{"assets/data.txt"} << QStringList() << false;
+    QTest::newRow("removed resource") << QStringList() << QStringList() << QStringList{"res/drawable/icon.png"} << false;
+}
+
+void TestApkPatcher::isPatchable()
+{
+    QFETCH(QStringList, modified);
+    QFETCH(QStringList, added);
+    QFETCH(QStringList, removed);
+    QFETCH(bool, patchable);
+
+    QCOMPARE(ApkPatcher::isPatchable(QFINDTESTDATA("data/original.apk"), modified, added, removed), patchable);
+}
+
+void TestApkPatcher::patch()
+{
+    // Round trip: the patched APK is read back and compared with the source APK and the decoded contents.
+
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    const QString source = QFINDTESTDATA("data/original.apk");
+    const QString contents = directory.path() + "/contents";
+    const QString target = directory.path() + "/patched.apk";
+
+    const QByteArray icon = QByteArray("\x89PNG modified icon").repeated(11);
+    const QByteArray data = QByteArray("modified data\n").repeated(60);
+    const QByteArray asset = QByteArray("added asset\n").repeated(20);
+    const QByteArray library = QByteArray("\x7f" "ELF").append(QByteArray("\0bar", 4).repeated(50));
+    const QByteArray unknown = QByteArray("unknown file");
+    QVERIFY(write(contents + "/res/drawable/icon.png", icon));
+    QVERIFY(write(contents + "/assets/data.txt", data));
+    QVERIFY(write(contents + "/assets/new.txt", asset));
+    QVERIFY(write(contents + "/lib/x86/libbar.so", library));
+    QVERIFY(write(contents + "/unknown/extra/file.bin", unknown));
+
+    const QStringList modified{"res/drawable/icon.png", "assets/data.txt"};
+    const QStringList added{"assets/new.txt", "lib/x86/libbar.so", "unknown/extra/file.bin"};
+    const QStringList removed{"assets/old.txt"};
+    QVERIFY(ApkPatcher::isPatchable(source, modified, added, removed));
+
+    QString error;
+    qint64 written = 0;
+    QVERIFY2(ApkPatcher::patch(source, target, contents, modified, added, removed, &error, &written), qPrintable(error));
+    QCOMPARE(written, QFileInfo(target).size());
+
+    ZipArchive original(source);
+    ZipArchive patched(target);
+    QVERIFY2(original.open(), qPrintable(original.getError()));
+    QVERIFY2(patched.open(), qPrintable(patched.getError()));
+    QCOMPARE(patched.getComment(), original.getComment());
+
+    // Source entries keep their order, except for the removed and signature ones; added entries follow:
+
+    QList<QByteArray> names;
+    for (const ZipArchive::Entry &entry : patched.getEntries()) {
+        names.append(entry.name);
+    }
+    const QList<QByteArray> expected{
+        "AndroidManifest.xml",
+        "classes.dex",
+        "resources.arsc",
+        "res/drawable/icon.png",
+        "res/layout/main.xml",
+        "assets/data.txt",
+        "lib/armeabi-v7a/libfoo.so",
+        "META-INF/services/com.example.Service",
+        "assets/new.txt",
+        "lib/x86/libbar.so",
+        "extra/file.bin"
+    };
+    QCOMPARE(names, expected);
+
+    const QHash<QByteArray, ZipArchive::Entry> before = index(original);
+    const QHash<QByteArray, ZipArchive::Entry> after = index(patched);
+    for (const QByteArray &name : {"AndroidManifest.xml", "classes.dex", "resources.arsc", "res/layout/main.xml",
+                                   "lib/armeabi-v7a/libfoo.so", "META-INF/services/com.example.Service"}) {
+        QCOMPARE(after.value(name).method, before.value(name).method);
+        QCOMPARE(after.value(name).crc, before.value(name).crc);
+        QCOMPARE(read(patched, after.value(name)), read(original, before.value(name)));
+    }
+
+    // Replaced entries keep their compression method; added native libraries are stored, the other files are compressed:
+
+    QCOMPARE(read(patched, after.value("res/drawable/icon.png")), icon);
+    QCOMPARE(read(patched, after.value("assets/data.txt")), data);
+    QCOMPARE(read(patched, after.value("assets/new.txt")), asset);
+    QCOMPARE(read(patched, after.value("lib/x86/libbar.so")), library);
+    QCOMPARE(read(patched, after.value("extra/file.bin")), unknown);
+    QCOMPARE(after.value("res/drawable/icon.png").method, before.value("res/drawable/icon.png").method);
+    QCOMPARE(after.value("assets/data.txt").method, before.value("assets/data.txt").method);
+    QCOMPARE(after.value("assets/new.txt").method, quint16(8));
+    QCOMPARE(after.value("lib/x86/libbar.so").method, quint16(0));
+    QCOMPARE(after.value("extra/file.bin").method, quint16(8));
+
+    for (const ZipArchive::Entry &entry : patched.getEntries()) {
+        if (entry.method == 0) {
+            QCOMPARE(entry.dataOffset % 4, Q_INT64_C(0));
+        }
+    }
+}
+
+void TestApkPatcher::patchMissingFile()
+{
+    // A modified file which can't be read fails the patching with an error:
+
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    const QString source = QFINDTESTDATA("data/original.apk");
+    const QString target = directory.path() + "/patched.apk";
+
+    QString error;
+    QVERIFY(!ApkPatcher::patch(source, target, directory.path() + "/contents", {"assets/data.txt"}, {}, {}, &error));
+    QVERIFY(error.contains("assets/data.txt"));
+}
+
+void TestApkPatcher::getFingerprint()
+{
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    const QString apk = directory.path() + "/sample.apk";
+    QVERIFY(QFile::copy(QFINDTESTDATA("data/original.apk"), apk));
+
+    const QByteArray fingerprint = ApkPatcher::getFingerprint(apk);
+    QVERIFY(!fingerprint.isEmpty());
+    QCOMPARE(ApkPatcher::getFingerprint(apk), fingerprint);
+
+    // Changing the contents without changing the size changes the fingerprint:
+
+    QFile file(apk);
+    QVERIFY(file.open(QFile::ReadWrite));
+    QVERIFY(file.seek(file.size() - 1));
+    QVERIFY(file.putChar('!'));
+    file.close();
+    QCOMPARE(QFileInfo(apk).size(), QFileInfo(QFINDTESTDATA("data/original.apk")).size());
+    QVERIFY(ApkPatcher::getFingerprint(apk) != fingerprint);
+
+    QVERIFY(ApkPatcher::getFingerprint(directory.path() + "/missing.apk").isEmpty());
+}
+
+bool TestApkPatcher::write(const QString &path, const QByteArray &data)
+{
+    QFile file(path);
+    return QDir().mkpath(QFileInfo(path).path()) && file.open(QFile::WriteOnly) && file.write(data) == data.size();
+}
+
+QByteArray TestApkPatcher::read(const ZipArchive &archive, const ZipArchive::Entry &entry)
+{
+    QByteArray data;
+    archive.read(entry, [&](const char *chunk, qint64 size) {
+        data.append(chunk, static_cast<int>(size));
+    });
+    return data;
+}
+
+QHash<QByteArray, ZipArchive::Entry> TestApkPatcher::index(const ZipArchive &archive)
+{
+    QHash<QByteArray, ZipArchive::Entry> entries;
+    for (const ZipArchive::Entry &entry : archive.getEntries()) {
+        entries.insert(entry.name, entry);
+    }
+    return entries;
+}
+
+QTEST_GUILESS_MAIN(TestApkPatcher)
+
+#include "tst_apkpatcher.moc"
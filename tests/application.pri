@@ -0,0 +1,12 @@
+# Links the application sources (except for main()) for the tests which need the Application instance,
+# e.g., for the models which refer to the shared icon and thumbnail providers. See testapplication.h.
+
+QT += gui widgets xml network concurrent
+
+include($$SRC/apk-editor-studio.pri)
+include($$SRC/../lib/qtkeychain/qt5keychain.pri)
+include($$SRC/../lib/qtsingleapplication/src/qtsingleapplication.pri)
+
+SOURCES -= $$SRC/base/main.cpp
+HEADERS += $$PWD/testapplication.h
+INCLUDEPATH += $$PWD
@@ -0,0 +1,119 @@
+#include "base/batchrunner.h"
+#include "testapplication.h"
+#include <QJsonDocument>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+
+// Tests of the command line and job list validation of the batch mode, and of its report format.
+// The jobs themselves are not run, as they require apktool.
+
+class TestBatchRunner : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void isRequested();
+    void parse_data();
+    void parse();
+    void emptyReport();
+
+private:
+    QString write(const QString &name, const QByteArray &data) const;
+
+    QTemporaryDir *directory;
+};
+
+void TestBatchRunner::init()
+{
+    directory = new QTemporaryDir;
+    QVERIFY(directory->isValid());
+}
+
+void TestBatchRunner::cleanup()
+{
+    delete directory;
+}
+
+void TestBatchRunner::isRequested()
+{
+    char program[] = "apk-editor-studio";
+    char batch[] = "--batch";
+    char jobs[] = "jobs.json";
+    char apk[] = "app.apk";
+    char *batchArguments[] = {program, batch, jobs};
+    char *openArguments[] = {program, apk};
+    QVERIFY(BatchRunner::isRequested(3, batchArguments));
+    QVERIFY(!BatchRunner::isRequested(2, openArguments));
+    QVERIFY(!BatchRunner::isRequested(1, batchArguments));
+}
+
+void TestBatchRunner::parse_data()
+{
+    QTest::addColumn<QByteArray>("jobs");
+    QTest::addColumn<QStringList>("options");
+    QTest::addColumn<bool>("valid");
+
+    const QByteArray job = R"([{"input": "app.apk", "output": "out/app.apk", "versionCode": "+1"}])";
+    QTest::newRow("valid") << job << QStringList() << true;
+    QTest::newRow("workers") << job << QStringList({"--workers", "4"}) << true;
+    QTest::newRow("report") << job << QStringList({"--report", "report.jsonl"}) << true;
+    QTest::newRow("no jobs") << QByteArray("[]") << QStringList() << true;
+    QTest::newRow("zero workers") << job << QStringList({"--workers", "0"}) << false;
+    QTest::newRow("missing value") << job << QStringList({"--workers"}) << false;
+    QTest::newRow("unexpected argument") << job << QStringList({"--verbose"}) << false;
+    QTest::newRow("invalid JSON") << QByteArray("[{") << QStringList() << false;
+    QTest::newRow("not an array") << QByteArray(R"({"input": "app.apk"})") << QStringList() << false;
+    QTest::newRow("no output") << QByteArray(R"([{"input": "app.apk"}])") << QStringList() << false;
+    QTest::newRow("no input") << QByteArray(R"([{"output": "app.apk"}])") << QStringList() << false;
+}
+
+void TestBatchRunner::parse()
+{
+    QFETCH(QByteArray, jobs);
+    QFETCH(QStringList, options);
+    QFETCH(bool, valid);
+
+    const QString path = write("jobs.json", jobs);
+    BatchRunner runner;
+    QCOMPARE(runner.parse(QStringList({"apk-editor-studio", "--batch", path}) + options), valid);
+}
+
+void TestBatchRunner::emptyReport()
+{
+    // The summary line is written even if there are no jobs:
+
+    const QString jobs = write("jobs.json", "[]");
+    const QString report = directory->path() + "/report.jsonl";
+    BatchRunner runner;
+    QSignalSpy finished(&runner, &BatchRunner::finished);
+    QVERIFY(runner.parse({"apk-editor-studio", "--batch", jobs, "--report", report}));
+    runner.start();
+    QCOMPARE(finished.count(), 1);
+    QCOMPARE(finished.first().first().toInt(), 0);
+
+    QFile file(report);
+    QVERIFY(file.open(QFile::ReadOnly));
+    const QList<QByteArray> lines = file.readAll().trimmed().split('\n');
+    QCOMPARE(lines.count(), 1);
+    const QJsonObject summary = QJsonDocument::fromJson(lines.first()).object();
+    QCOMPARE(summary.value("summary").toBool(), true);
+    QCOMPARE(summary.value("succeeded").toInt(), 0);
+    QCOMPARE(summary.value("failed").toInt(), 0);
+    QVERIFY(summary.contains("total_ms"));
+}
+
+QString TestBatchRunner::write(const QString &name, const QByteArray &data) const
+{
+    const QString path = directory->path() + '/' + name;
+    QFile file(path);
+    if (!file.open(QFile::WriteOnly) || file.write(data) != data.size()) {
+        return QString();
+    }
+    return path;
+}
+
+TEST_APPLICATION_MAIN(TestBatchRunner)
+
+#include "tst_batchrunner.moc"
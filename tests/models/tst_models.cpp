@@ -0,0 +1,312 @@
+#include "apk/filesystemmodel.h"
+#include "apk/resourceitemsmodel.h"
+#include "apk/resourcescanner.h"
+#include "apk/xmlmodel.h"
+#include "testapplication.h"
+#include <QAbstractItemModelTester>
+#include <QTemporaryDir>
+
+// The models are checked by QAbstractItemModelTester while their rows are inserted, removed and moved
+// (a moved file is removed from one parent and inserted into another). The parent() throughput is measured
+// on wide trees, where the parent of each index is one of tens of thousands of siblings.
+
+class TestModels : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void resourceItemsModel();
+    void fetchInBackground();
+    void fileSystemModel();
+    void parentThroughput_data();
+    void parentThroughput();
+
+private:
+    QString path(const QString &relative) const;
+    bool create(const QString &relative) const;
+    static QModelIndex find(const QAbstractItemModel *model, const QString &caption, const QModelIndex &parent = QModelIndex());
+
+    QTemporaryDir *directory;
+    QString resources;
+};
+
+void TestModels::init()
+{
+    directory = new QTemporaryDir;
+    QVERIFY(directory->isValid());
+    resources = directory->path() + "/res";
+    QVERIFY(create("drawable/icon.png"));
+    QVERIFY(create("drawable/logo.png"));
+    QVERIFY(create("drawable-hdpi/icon.png"));
+    QVERIFY(create("layout/main.xml"));
+    QVERIFY(create("values/strings.xml"));
+    QVERIFY(create("values-ru/strings.xml"));
+}
+
+void TestModels::cleanup()
+{
+    delete directory;
+}
+
+void TestModels::resourceItemsModel()
+{
+    ResourceItemsModel model(nullptr);
+    QAbstractItemModelTester tester(&model, QAbstractItemModelTester::FailureReportingMode::QtTest);
+
+    model.setDirectories(ResourceScanner::listDirectories(resources));
+    QCOMPARE(model.rowCount(), 3);
+
+    // Populate a type on demand and the rest at once:
+
+    const QModelIndex drawable = find(&model, "drawable");
+    QVERIFY(drawable.isValid());
+    if (model.canFetchMore(drawable)) {
+        model.fetchMore(drawable);
+    }
+    QTRY_COMPARE(model.rowCount(drawable), 2);
+    model.merge(ResourceScanner::read(ResourceScanner::listDirectories(resources)));
+    QTRY_COMPARE(model.rowCount(find(&model, "values")), 1);
+    QCOMPARE(model.rowCount(find(&model, "strings.xml", find(&model, "values"))), 2);
+
+    // Insert into an existing group, a new group and a new type:
+
+    QVERIFY(create("drawable-xhdpi/icon.png"));
+    QVERIFY(create("drawable/banner.png"));
+    QVERIFY(create("raw/sound.ogg"));
+    model.addFiles({path("drawable-xhdpi/icon.png"), path("drawable/banner.png"), path("raw/sound.ogg")});
+    QCOMPARE(model.rowCount(find(&model, "icon.png", drawable)), 3);
+    QCOMPARE(model.rowCount(drawable), 3);
+    QCOMPARE(model.rowCount(), 4);
+    QVERIFY(model.findIndex(path("raw/sound.ogg")).isValid());
+
+    // Refresh:
+
+    model.refreshFiles({path("drawable/icon.png"), path("drawable-hdpi/icon.png")});
+
+    // Remove a file and the last file of a group:
+
+    QVERIFY(QFile::remove(path("drawable-hdpi/icon.png")));
+    QVERIFY(QFile::remove(path("drawable/logo.png")));
+    model.dropFiles({path("drawable-hdpi/icon.png"), path("drawable/logo.png")});
+    QCOMPARE(model.rowCount(find(&model, "icon.png", drawable)), 2);
+    QVERIFY(!find(&model, "logo.png", drawable).isValid());
+    QVERIFY(!model.findIndex(path("drawable/logo.png")).isValid());
+
+    // Move between the groups and between the types:
+
+    QVERIFY(QFile::rename(path("drawable/banner.png"), path("drawable/cover.png")));
+    QVERIFY(QDir().mkpath(path("mipmap")));
+    QVERIFY(QFile::rename(path("drawable-xhdpi/icon.png"), path("mipmap/icon.png")));
+    model.dropFiles({path("drawable/banner.png"), path("drawable-xhdpi/icon.png")});
+    model.addFiles({path("drawable/cover.png"), path("mipmap/icon.png")});
+    QVERIFY(model.findIndex(path("drawable/cover.png")).isValid());
+    QVERIFY(model.findIndex(path("mipmap/icon.png")).isValid());
+    QVERIFY(!model.findIndex(path("drawable/banner.png")).isValid());
+
+    // Remove through the model (the file is removed from disk):
+
+    const QModelIndex layout = model.findIndex(path("layout/main.xml"));
+    QVERIFY(model.removeResource(layout.sibling(layout.row(), 0)));
+    QVERIFY(!QFile::exists(path("layout/main.xml")));
+    QVERIFY(!model.findIndex(path("layout/main.xml")).isValid());
+}
+
+void TestModels::fetchInBackground()
+{
+    ResourceItemsModel model(nullptr);
+    QAbstractItemModelTester tester(&model, QAbstractItemModelTester::FailureReportingMode::QtTest);
+    model.setDirectories(ResourceScanner::listDirectories(resources));
+
+    // The tester fetches every type as a view would, so the placeholders are shown until the types are read:
+
+    const QModelIndex drawable = find(&model, "drawable");
+    const QModelIndex layout = find(&model, "layout");
+    const QModelIndex values = find(&model, "values");
+    QVERIFY(!model.canFetchMore(drawable));
+    QCOMPARE(model.rowCount(drawable), 1);
+    QVERIFY(!model.getResource(model.index(0, 0, drawable)));
+
+    // Files added while the type is being read are not lost:
+
+    QVERIFY(create("layout/extra.xml"));
+    model.addFiles({path("layout/extra.xml")});
+    QTRY_COMPARE(model.rowCount(drawable), 2);
+    QTRY_COMPARE(model.rowCount(layout), 2);
+    QVERIFY(model.findIndex(path("layout/extra.xml")).isValid());
+    QCOMPARE(model.rowCount(find(&model, "strings.xml", values)), 2);
+
+    // The background scanner result takes over the types which are still being read:
+
+    model.setDirectories(ResourceScanner::listDirectories(resources));
+    model.merge(ResourceScanner::read(ResourceScanner::listDirectories(resources)));
+    QCOMPARE(model.rowCount(find(&model, "drawable")), 2);
+    QCOMPARE(model.rowCount(find(&model, "layout")), 2);
+    QTest::qWait(100);
+    QCOMPARE(model.rowCount(find(&model, "drawable")), 2);
+    QCOMPARE(model.rowCount(find(&model, "layout")), 2);
+}
+
+void TestModels::fileSystemModel()
+{
+    ResourceItemsModel resourcesModel(nullptr);
+    resourcesModel.setDirectories(ResourceScanner::listDirectories(resources));
+    resourcesModel.merge(ResourceScanner::read(ResourceScanner::listDirectories(resources)));
+
+    FileSystemModel model;
+    model.setSourceModel(&resourcesModel);
+    QAbstractItemModelTester tester(&model, QAbstractItemModelTester::FailureReportingMode::QtTest);
+
+    const QModelIndex root = model.setRootPath(resources);
+    QTRY_COMPARE(model.rowCount(root), 5);
+    const QModelIndex drawable = model.index(path("drawable"));
+    model.fetchMore(drawable);
+    QTRY_COMPARE(model.rowCount(drawable), 2);
+
+    // Insert:
+
+    QVERIFY(create("drawable/banner.png"));
+    resourcesModel.addFiles({path("drawable/banner.png")});
+    QTRY_COMPARE(model.rowCount(drawable), 3);
+
+    // Updates of the resource model are mapped to the files (the rows of a group span several directories):
+
+    QSignalSpy updated(&model, &QAbstractItemModel::dataChanged);
+    resourcesModel.refreshFiles({path("drawable/icon.png"), path("drawable-hdpi/icon.png")});
+    QTRY_VERIFY(updated.count() > 0);
+
+    // Move:
+
+    QVERIFY(QFile::rename(path("drawable/banner.png"), path("drawable/cover.png")));
+    resourcesModel.dropFiles({path("drawable/banner.png")});
+    resourcesModel.addFiles({path("drawable/cover.png")});
+    QTRY_VERIFY(model.index(path("drawable/cover.png")).isValid());
+    QTRY_VERIFY(!model.index(path("drawable/banner.png")).isValid());
+    QCOMPARE(model.rowCount(drawable), 3);
+
+    // Remove through the resource model and directly (the file is not a part of the resources):
+
+    QVERIFY(create("drawable/notes.txt"));
+    QTRY_COMPARE(model.rowCount(drawable), 4);
+    const QModelIndex logo = model.index(path("drawable/logo.png"));
+    QVERIFY(model.removeResource(logo));
+    const QModelIndex notes = model.index(path("drawable/notes.txt"));
+    QVERIFY(model.removeResource(notes));
+    QVERIFY(!QFile::exists(path("drawable/logo.png")));
+    QVERIFY(!QFile::exists(path("drawable/notes.txt")));
+    QVERIFY(!resourcesModel.findIndex(path("drawable/logo.png")).isValid());
+    QTRY_COMPARE(model.rowCount(drawable), 2);
+}
+
+void TestModels::parentThroughput_data()
+{
+    QTest::addColumn<bool>("xml");
+    QTest::addColumn<bool>("cached");
+    QTest::addColumn<int>("count");
+
+    for (const int count : {10000, 40000}) {
+        QTest::newRow(qPrintable(QString("TreeNode, %1 siblings, search").arg(count))) << false << false << count;
+        QTest::newRow(qPrintable(QString("TreeNode, %1 siblings, cached").arg(count))) << false << true << count;
+        QTest::newRow(qPrintable(QString("XmlNode, %1 siblings, search").arg(count))) << true << false << count;
+        QTest::newRow(qPrintable(QString("XmlNode, %1 siblings, cached").arg(count))) << true << true << count;
+    }
+}
+
+void TestModels::parentThroughput()
+{
+    // parent() is called for an index below each of the siblings. The baseline repeats the former lookup of the row,
+    // which searched the siblings for the node, the cached figures call parent() of the model itself:
+    //   TreeNode: ResourceItemsModel, a type with <count> groups of a single file each
+    //   XmlNode: XmlResourceModel, <count> top-level plurals of a single item each
+
+    QFETCH(bool, xml);
+    QFETCH(bool, cached);
+    QFETCH(int, count);
+
+    QScopedPointer<QAbstractItemModel> model;
+    if (xml) {
+        QFile file(directory->path() + "/plurals.xml");
+        QVERIFY(file.open(QFile::WriteOnly));
+        QByteArray contents("<resources>\n");
+        for (int i = 0; i < count; ++i) {
+            contents.append(QString("<plurals name=\"plural_%1\"><item quantity=\"other\">%1</item></plurals>\n").arg(i).toUtf8());
+        }
+        contents.append("</resources>\n");
+        file.write(contents);
+        file.close();
+        model.reset(new XmlResourceModel(file.fileName()));
+    } else {
+        auto root = new ResourceNode();
+        auto type = new ResourceNode("drawable", nullptr);
+        root->addChild(type);
+        for (int i = 0; i < count; ++i) {
+            const QString filename = QString("image_%1.png").arg(i);
+            auto group = new ResourceNode(filename, nullptr);
+            group->addChild(new ResourceNode(filename, new ResourceFile(path("drawable/" + filename))));
+            type->addChild(group);
+        }
+        auto resourcesModel = new ResourceItemsModel(nullptr);
+        resourcesModel->setRoot(root);
+        model.reset(resourcesModel);
+    }
+
+    const QModelIndex parent = xml ? QModelIndex() : model->index(0, 0);
+    QCOMPARE(model->rowCount(parent), count);
+    QModelIndexList indexes;
+    for (int row = 0; row < count; ++row) {
+        indexes.append(model->index(0, 0, model->index(row, 0, parent)));
+    }
+    QVERIFY(indexes.last().isValid());
+
+    qint64 sum = 0;
+    QBENCHMARK {
+        sum = 0;
+        for (const QModelIndex &index : indexes) {
+            if (cached) {
+                sum += model->parent(index).row();
+            } else if (xml) {
+                XmlNode *node = static_cast<XmlNode *>(index.internalPointer())->getParent();
+                XmlNode *siblings = node->getParent();
+                for (int row = 0; row < siblings->childCount(); ++row) {
+                    if (siblings->getChild(row) == node) {
+                        sum += row;
+                        break;
+                    }
+                }
+            } else {
+                TreeNode *node = static_cast<ResourceNode *>(index.internalPointer())->getParent();
+                sum += node->getParent()->getChildren().indexOf(node);
+            }
+        }
+    }
+    QCOMPARE(sum, static_cast<qint64>(count) * (count - 1) / 2);
+}
+
+QString TestModels::path(const QString &relative) const
+{
+    return QString("%1/%2").arg(resources, relative);
+}
+
+bool TestModels::create(const QString &relative) const
+{
+    const QString filePath = path(relative);
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    QFile file(filePath);
+    return file.open(QFile::WriteOnly) && file.write(relative.toUtf8()) > 0;
+}
+
+QModelIndex TestModels::find(const QAbstractItemModel *model, const QString &caption, const QModelIndex &parent)
+{
+    for (int row = 0; row < model->rowCount(parent); ++row) {
+        const QModelIndex index = model->index(row, 0, parent);
+        if (index.data().toString() == caption) {
+            return index;
+        }
+    }
+    return QModelIndex();
+}
+
+TEST_APPLICATION_MAIN(TestModels)
+
+#include "tst_models.moc"
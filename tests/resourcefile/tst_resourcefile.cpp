@@ -0,0 +1,367 @@
+#include "apk/resourcefile.h"
+#include "testapplication.h"
+#include <QRegularExpression>
+#ifdef __GLIBC__
+    #include <malloc.h>
+#endif
+
+// Tests of the qualifier parser on synthetic resource paths. The directory names combine the qualifiers in the order
+// defined by Android, see https://developer.android.com/guide/topics/resources/providing-resources.html?hl=en
+
+class TestResourceFile : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void matchRegexParser_data();
+    void matchRegexParser();
+    void matchRegexParserSynthetic();
+    void parse_data();
+    void parse();
+    void memoryReport();
+
+private:
+    static QStringList createPaths(int count);
+    static QString directoryName(const QString &path);
+    static qint64 heapUsage();
+
+    QStringList paths;
+};
+
+namespace Reference
+{
+    // The former regular expression based parser, kept to check the token table against it.
+    // Unlike this parser, the token table anchors the numeric qualifiers (e.g., "sw600dp") to the whole qualifier,
+    // so the directories with such a substring inside of another qualifier are not compared.
+
+    struct Qualifiers
+    {
+        QString type;
+        QString readableQualifiers;
+        QString localeLegacy;
+        QString values[ResourceQualifiers::QualifierCount];
+    };
+
+    const QStringList layoutDirection = {"ldrtl", "ldltr"};
+    const QStringList screenSize = {"small", "normal", "large", "xlarge"};
+    const QStringList screenAspect = {"long", "notlong"};
+    const QStringList roundScreen = {"round", "notround"};
+    const QStringList wideColorGamut = {"widecg", "nowidecg"};
+    const QStringList hdr = {"highdr", "lowdr"};
+    const QStringList screenOrientation = {"port", "land"};
+    const QStringList uiMode = {"car", "desk", "television", "appliance", "watch", "vrheadset"};
+    const QStringList nightMode = {"night", "notnight"};
+    const QStringList dpi = {"ldpi", "mdpi", "hdpi", "xhdpi", "xxhdpi", "xxxhdpi", "nodpi", "tvdpi", "anydpi"};
+    const QStringList touchscreenType = {"notouch", "finger"};
+    const QStringList keyboardAvailability = {"keysexposed", "keyshidden", "keyssoft"};
+    const QStringList inputMethod = {"nokeys", "qwerty", "12key"};
+    const QStringList navigationAvailability = {"navexposed", "navhidden"};
+    const QStringList navigationMethod = {"nonav", "dpad", "trackball", "wheel"};
+
+    Qualifiers parse(const QString &directory)
+    {
+        Qualifiers result;
+        QStringList qualifiersParts = directory.split('-');
+        result.type = qualifiersParts.takeFirst();
+        // Replace "-r" region code prefix with "_":
+        qualifiersParts = qualifiersParts.join('-').replace(QRegularExpression("(-r)(?=[A-Za-z]{2}(?=\\z|-))"), "_").split('-');
+        result.readableQualifiers = qualifiersParts.join(" - ");
+
+        QString *values = result.values;
+        for (const QString &qualifier : qualifiersParts) {
+            if (layoutDirection.contains(qualifier)) {
+                values[ResourceQualifiers::LayoutDirection] = qualifier;
+            } else if (qualifier.contains(QRegularExpression("sw\\d+dp"))) {
+                values[ResourceQualifiers::SmallestWidth] = qualifier;
+            } else if (qualifier.contains(QRegularExpression("w\\d+dp"))) {
+                values[ResourceQualifiers::AvailableWidth] = qualifier;
+            } else if (qualifier.contains(QRegularExpression("h\\d+dp"))) {
+                values[ResourceQualifiers::AvailableHeight] = qualifier;
+            } else if (screenSize.contains(qualifier)) {
+                values[ResourceQualifiers::ScreenSize] = qualifier;
+            } else if (screenAspect.contains(qualifier)) {
+                values[ResourceQualifiers::ScreenAspect] = qualifier;
+            } else if (roundScreen.contains(qualifier)) {
+                values[ResourceQualifiers::RoundScreen] = qualifier;
+            } else if (wideColorGamut.contains(qualifier)) {
+                values[ResourceQualifiers::WideColorGamut] = qualifier;
+            } else if (hdr.contains(qualifier)) {
+                values[ResourceQualifiers::Hdr] = qualifier;
+            } else if (screenOrientation.contains(qualifier)) {
+                values[ResourceQualifiers::ScreenOrientation] = qualifier;
+            } else if (uiMode.contains(qualifier)) {
+                values[ResourceQualifiers::UiMode] = qualifier;
+            } else if (nightMode.contains(qualifier)) {
+                values[ResourceQualifiers::NightMode] = qualifier;
+            } else if (dpi.contains(qualifier)) {
+                values[ResourceQualifiers::Dpi] = qualifier;
+            } else if (touchscreenType.contains(qualifier)) {
+                values[ResourceQualifiers::TouchscreenType] = qualifier;
+            } else if (keyboardAvailability.contains(qualifier)) {
+                values[ResourceQualifiers::KeyboardAvailability] = qualifier;
+            } else if (inputMethod.contains(qualifier)) {
+                values[ResourceQualifiers::InputMethod] = qualifier;
+            } else if (navigationAvailability.contains(qualifier)) {
+                values[ResourceQualifiers::NavigationAvailability] = qualifier;
+            } else if (navigationMethod.contains(qualifier)) {
+                values[ResourceQualifiers::NavigationMethod] = qualifier;
+            } else if (qualifier.contains(QRegularExpression("v\\d+"))) {
+                values[ResourceQualifiers::ApiVersion] = qualifier;
+            } else {
+                values[ResourceQualifiers::Locale] = qualifier;
+                // Handle legacy locales:
+                if (qualifier == "iw") {
+                    result.localeLegacy = "he";
+                } else if (qualifier == "ji") {
+                    result.localeLegacy = "yi";
+                } else if (qualifier == "in") {
+                    result.localeLegacy = "id";
+                } else {
+                    result.localeLegacy = qualifier;
+                }
+            }
+        }
+        return result;
+    }
+}
+
+void TestResourceFile::initTestCase()
+{
+    paths = createPaths(100000);
+}
+
+void TestResourceFile::matchRegexParser_data()
+{
+    QTest::addColumn<QString>("directory");
+
+    const QStringList directories = {
+        "values",
+        "values-ru",
+        "values-en-rUS",
+        "values-pt-rBR-v21",
+        "values-iw",
+        "values-in-rID",
+        "values-b+sr+Latn",
+        "values-mcc310-mnc004-en",
+        "values-sw600dp-w820dp-h720dp",
+        "values-ldrtl-large-long-round-widecg-highdr-land-car-night-xhdpi-finger-keysexposed-qwerty-navhidden-dpad-v26",
+        "values-ldltr-small-notlong-notround-nowidecg-lowdr-port-watch-notnight-ldpi-notouch-keyssoft-12key-navexposed-wheel-v4",
+        "drawable-hdpi",
+        "drawable-xxxhdpi-v4",
+        "drawable-land-hdpi",
+        "mipmap-anydpi-v26",
+        "layout-sw600dp-land",
+        "raw-rUS",
+    };
+    for (const QString &directory : directories) {
+        QTest::newRow(qPrintable(directory)) << directory;
+    }
+}
+
+void TestResourceFile::matchRegexParser()
+{
+    QFETCH(QString, directory);
+
+    const ResourceFile file(QString("res/%1/file.xml").arg(directory));
+    const ResourceQualifiers qualifiers(directory);
+    const Reference::Qualifiers expected = Reference::parse(directory);
+
+    QCOMPARE(file.getType(), expected.type);
+    QCOMPARE(file.getQualifiers(), directory);
+    QCOMPARE(file.getReadableQualifiers(), expected.readableQualifiers);
+    QCOMPARE(file.getLocaleCode(), expected.values[ResourceQualifiers::Locale]);
+    QCOMPARE(file.getDpi(), expected.values[ResourceQualifiers::Dpi].toUpper());
+    QCOMPARE(file.getApiVersion(), expected.values[ResourceQualifiers::ApiVersion]);
+    QCOMPARE(qualifiers.getLocaleLegacy(), expected.localeLegacy);
+    for (int i = 0; i < ResourceQualifiers::QualifierCount; ++i) {
+        const auto qualifier = static_cast<ResourceQualifiers::Qualifier>(i);
+        QCOMPARE(qualifiers.getValue(qualifier), expected.values[qualifier]);
+    }
+}
+
+void TestResourceFile::matchRegexParserSynthetic()
+{
+    // Every distinct directory of the synthetic paths is parsed by both parsers:
+
+    QSet<QString> directories;
+    for (const QString &path : paths) {
+        directories.insert(directoryName(path));
+    }
+    for (const QString &directory : directories) {
+        const ResourceQualifiers qualifiers(directory);
+        const Reference::Qualifiers expected = Reference::parse(directory);
+        QCOMPARE(qualifiers.getType(), expected.type);
+        QCOMPARE(qualifiers.getReadableQualifiers(), expected.readableQualifiers);
+        QCOMPARE(qualifiers.getLocaleLegacy(), expected.localeLegacy);
+        for (int i = 0; i < ResourceQualifiers::QualifierCount; ++i) {
+            const auto qualifier = static_cast<ResourceQualifiers::Qualifier>(i);
+            QVERIFY2(qualifiers.getValue(qualifier) == expected.values[qualifier], qPrintable(directory));
+        }
+    }
+}
+
+void TestResourceFile::parse_data()
+{
+    QTest::addColumn<bool>("table");
+
+    QTest::newRow("token table") << true;
+    QTest::newRow("regular expressions") << false;
+}
+
+void TestResourceFile::parse()
+{
+    // Parses 100k paths, each with its own directory parsed (as the files added one by one are):
+
+    QFETCH(bool, table);
+
+    QBENCHMARK {
+        if (table) {
+            for (const QString &path : paths) {
+                const ResourceFile file(path);
+                Q_UNUSED(file)
+            }
+        } else {
+            for (const QString &path : paths) {
+                const Reference::Qualifiers qualifiers = Reference::parse(directoryName(path));
+                Q_UNUSED(qualifiers)
+            }
+        }
+    }
+}
+
+void TestResourceFile::memoryReport()
+{
+    // Heap used by the resource files of a large synthetic project (50k files in 400 directories), measured
+    // for the former layout, which held the qualifiers as separate strings of each file, and for the current one,
+    // which shares the qualifiers between the files of a directory (as ResourceScanner does).
+
+    if (heapUsage() < 0) {
+        QSKIP("The heap usage is only measured with glibc.");
+    }
+
+    struct LegacyFile
+    {
+        QString path;
+        QString qualifiers;
+        Reference::Qualifiers parsed;
+    };
+
+    QStringList directories;
+    for (const QString &path : paths) {
+        const QString directory = directoryName(path);
+        if (!directories.contains(directory)) {
+            directories.append(directory);
+            if (directories.count() == 400) {
+                break;
+            }
+        }
+    }
+    QVector<QStringList> files;
+    for (const QString &directory : directories) {
+        QStringList directoryFiles;
+        for (int i = 0; i < 125; ++i) {
+            directoryFiles.append(QString("project/res/%1/file_%2.xml").arg(directory).arg(i));
+        }
+        files.append(directoryFiles);
+    }
+    const int count = directories.count() * 125;
+    Reference::parse(directories.first()); // Any lazily allocated state of the regular expressions is not counted
+
+    QVector<LegacyFile *> legacyFiles;
+    legacyFiles.reserve(count);
+    const qint64 legacyBaseline = heapUsage();
+    for (const QStringList &directoryFiles : files) {
+        for (const QString &path : directoryFiles) {
+            auto file = new LegacyFile;
+            file->path = path;
+            file->qualifiers = directoryName(path);
+            file->parsed = Reference::parse(file->qualifiers);
+            legacyFiles.append(file);
+        }
+    }
+    const qint64 legacyUsage = heapUsage() - legacyBaseline;
+    qDeleteAll(legacyFiles);
+
+    QVector<ResourceFile *> resourceFiles;
+    resourceFiles.reserve(count);
+    const qint64 baseline = heapUsage();
+    for (const QStringList &directoryFiles : files) {
+        const ResourceQualifiers qualifiers(directoryName(directoryFiles.first()));
+        for (const QString &path : directoryFiles) {
+            resourceFiles.append(new ResourceFile(path, qualifiers));
+        }
+    }
+    const qint64 usage = heapUsage() - baseline;
+    qDeleteAll(resourceFiles);
+
+    // The paths are shared with the input list, so both figures count the qualifiers and the file objects only:
+    qInfo().noquote() << QString("%1 files in %2 directories:").arg(count).arg(directories.count());
+    qInfo().noquote() << QString("  separate qualifiers: %1 KiB (%2 bytes per file)").arg(legacyUsage / 1024).arg(legacyUsage / count);
+    qInfo().noquote() << QString("  shared qualifiers: %1 KiB (%2 bytes per file)").arg(usage / 1024).arg(usage / count);
+    QVERIFY(usage < legacyUsage);
+}
+
+QStringList TestResourceFile::createPaths(int count)
+{
+    // Qualifiers are picked from each pool by a linear congruential sequence seeded with the path number:
+    const QVector<QStringList> pools = {
+        {"drawable", "mipmap", "layout", "values", "raw", "xml", "anim", "color"},
+        {"", "", "en", "en-rUS", "ru", "pt-rBR", "zh-rCN", "iw", "in", "ji", "b+sr+Latn"},
+        {"", "ldrtl"},
+        {"", "", "sw600dp", "sw720dp"},
+        {"", "w820dp"},
+        {"", "h480dp"},
+        {"", "large", "xlarge"},
+        {"", "", "", "round"},
+        {"", "port", "land"},
+        {"", "", "car", "television", "watch"},
+        {"", "night", "notnight"},
+        {"", "", "hdpi", "xhdpi", "xxhdpi", "xxxhdpi", "nodpi", "anydpi"},
+        {"", "", "", "keyshidden"},
+        {"", "v4", "v21", "v26"},
+    };
+
+    QStringList paths;
+    paths.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        QString directory;
+        quint32 seed = static_cast<quint32>(i);
+        for (const QStringList &pool : pools) {
+            seed = seed * 1103515245u + 12345u;
+            const QString &qualifier = pool.at(static_cast<int>((seed >> 16) % static_cast<quint32>(pool.count())));
+            if (!qualifier.isEmpty()) {
+                if (!directory.isEmpty()) {
+                    directory.append('-');
+                }
+                directory.append(qualifier);
+            }
+        }
+        paths.append(QString("project/res/%1/file_%2.xml").arg(directory).arg(i));
+    }
+    return paths;
+}
+
+QString TestResourceFile::directoryName(const QString &path)
+{
+    const QStringList parts = path.split('/');
+    return parts.at(parts.size() - 2);
+}
+
+qint64 TestResourceFile::heapUsage()
+{
+    // Returns the number of bytes allocated on the heap, or -1 if it's unknown.
+#ifdef __GLIBC__
+    #if __GLIBC_PREREQ(2, 33)
+        return static_cast<qint64>(mallinfo2().uordblks);
+    #else
+        return static_cast<qint64>(static_cast<unsigned int>(mallinfo().uordblks));
+    #endif
+#else
+    return -1;
+#endif
+}
+
+TEST_APPLICATION_MAIN(TestResourceFile)
+
+#include "tst_resourcefile.moc"
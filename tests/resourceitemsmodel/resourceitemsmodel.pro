@@ -0,0 +1,7 @@
+include(../tests.pri)
+include(../application.pri)
+
+TARGET = tst_resourceitemsmodel
+
+SOURCES += \
+    tst_resourceitemsmodel.cpp
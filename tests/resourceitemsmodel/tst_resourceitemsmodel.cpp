@@ -0,0 +1,239 @@
+#include "apk/resourceitemsmodel.h"
+#include "apk/resourcescanner.h"
+#include "apk/sortfilterproxymodel.h"
+#include "testapplication.h"
+#include <QDirIterator>
+#include <QTemporaryDir>
+
+// Benchmarks of the resource model on synthetic projects. The files are spread over a few types and qualifier
+// directories, so that each group holds a file per directory of its type (as the images of different densities do).
+// The sorted proxy stands for the resource tree view. Run with "-iterations N" or "-callgrind" for stable results.
+
+class TestResourceItemsModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void load_data();
+    void load();
+    void remove_data();
+    void remove();
+    void replace_data();
+    void replace();
+
+private:
+    static QStringList createProject(const QString &path, int count);
+    static QStringList pickFiles(const QStringList &directories, int count);
+    static void addPerFile(ResourceItemsModel &model, ResourceNode *scanned);
+};
+
+void TestResourceItemsModel::load_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("batched");
+
+    for (const int count : {1000, 5000, 20000}) {
+        QTest::newRow(qPrintable(QString("%1 resources, per file").arg(count))) << count << false;
+        QTest::newRow(qPrintable(QString("%1 resources, batched").arg(count))) << count << true;
+    }
+}
+
+void TestResourceItemsModel::load()
+{
+    // Project loading: the type nodes are shown first, then the scanned tree is merged into the model.
+    // The former per-file insertion is measured for comparison.
+
+    QFETCH(int, count);
+    QFETCH(bool, batched);
+
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    const QStringList directories = createProject(directory.path() + "/res", count);
+
+    ResourceItemsModel model(nullptr);
+    SortFilterProxyModel proxy;
+    proxy.setSortRole(ResourceItemsModel::SortRole);
+    proxy.setSourceModel(&model);
+    proxy.sort(0);
+    QSignalSpy inserted(&model, &QAbstractItemModel::rowsInserted);
+
+    QBENCHMARK {
+        inserted.clear();
+        if (batched) {
+            model.setDirectories(directories);
+            model.merge(ResourceScanner::read(directories));
+        } else {
+            addPerFile(model, ResourceScanner::read(directories));
+        }
+    }
+
+    int files = 0;
+    int groups = 0;
+    for (int type = 0; type < model.rowCount(); ++type) {
+        const QModelIndex typeIndex = model.index(type, 0);
+        groups += model.rowCount(typeIndex);
+        for (int group = 0; group < model.rowCount(typeIndex); ++group) {
+            files += model.rowCount(model.index(group, 0, typeIndex));
+        }
+    }
+    QCOMPARE(files, count);
+    QCOMPARE(proxy.rowCount(), model.rowCount());
+
+    // Merged types are inserted with a single notification each, instead of one per node:
+    if (batched) {
+        QCOMPARE(inserted.count(), model.rowCount());
+    } else {
+        QCOMPARE(inserted.count(), model.rowCount() + groups + files);
+    }
+}
+
+void TestResourceItemsModel::remove_data()
+{
+    QTest::addColumn<int>("count");
+
+    for (const int count : {1000, 5000, 20000}) {
+        QTest::newRow(qPrintable(QString("%1 resources").arg(count))) << count;
+    }
+}
+
+void TestResourceItemsModel::remove()
+{
+    // Bulk removal from the file system tree: each file is looked up by its path and removed through the resource model
+    // (see FileSystemModel::removeRows). The files are removed from disk, so the removal is measured once.
+
+    QFETCH(int, count);
+
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    const QStringList directories = createProject(directory.path() + "/res", count);
+    const QStringList files = pickFiles(directories, 500);
+
+    ResourceItemsModel model(nullptr);
+    model.setDirectories(directories);
+    model.merge(ResourceScanner::read(directories));
+
+    QBENCHMARK_ONCE {
+        for (const QString &path : files) {
+            model.removeResource(model.findIndex(path));
+        }
+    }
+
+    for (const QString &path : files) {
+        QVERIFY(!model.findIndex(path).isValid());
+        QVERIFY(!QFile::exists(path));
+    }
+}
+
+void TestResourceItemsModel::replace_data()
+{
+    remove_data();
+}
+
+void TestResourceItemsModel::replace()
+{
+    // Bulk replacement from the file system tree: each file is looked up by its path and replaced through the resource model
+    // (see FileSystemModel::replaceResource).
+
+    QFETCH(int, count);
+
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    const QStringList directories = createProject(directory.path() + "/res", count);
+    const QStringList files = pickFiles(directories, 500);
+    const QString replacement = directory.path() + "/replacement.png";
+    QFile file(replacement);
+    QVERIFY(file.open(QFile::WriteOnly) && file.write("replacement") > 0);
+    file.close();
+
+    ResourceItemsModel model(nullptr);
+    model.setDirectories(directories);
+    model.merge(ResourceScanner::read(directories));
+    QSignalSpy changed(&model, &QAbstractItemModel::dataChanged);
+
+    QBENCHMARK {
+        changed.clear();
+        for (const QString &path : files) {
+            model.replaceResource(model.findIndex(path), replacement);
+        }
+    }
+
+    QCOMPARE(changed.count(), files.count());
+    QCOMPARE(QFileInfo(files.first()).size(), QFileInfo(replacement).size());
+}
+
+QStringList TestResourceItemsModel::createProject(const QString &path, int count)
+{
+    struct Type {
+        const char *name;
+        const char *extension;
+        QStringList qualifiers;
+    };
+    const QVector<Type> types = {
+        {"drawable", "png", {"", "-hdpi", "-xhdpi", "-xxhdpi", "-xxxhdpi"}},
+        {"mipmap", "png", {"-mdpi", "-hdpi", "-xhdpi", "-xxhdpi"}},
+        {"layout", "xml", {"", "-land", "-sw600dp"}},
+        {"values", "xml", {"", "-ru", "-de", "-pt-rBR", "-zh-rCN", "-v21"}},
+        {"raw", "ogg", {""}},
+    };
+
+    QStringList directories;
+    for (const Type &type : types) {
+        for (const QString &qualifiers : type.qualifiers) {
+            directories.append(QString("%1/%2%3").arg(path, type.name, qualifiers));
+            QDir().mkpath(directories.last());
+        }
+    }
+    int created = 0;
+    for (int group = 0; created < count; ++group) {
+        const Type &type = types.at(group % types.count());
+        for (const QString &qualifiers : type.qualifiers) {
+            if (created == count) {
+                break;
+            }
+            QFile file(QString("%1/%2%3/file_%4.%5").arg(path, type.name, qualifiers).arg(group).arg(type.extension));
+            if (file.open(QFile::WriteOnly)) {
+                ++created;
+            }
+        }
+    }
+    return directories;
+}
+
+QStringList TestResourceItemsModel::pickFiles(const QStringList &directories, int count)
+{
+    // Takes the files evenly from all of the directories:
+    QStringList files;
+    for (const QString &directory : directories) {
+        QDirIterator it(directory, QDir::Files);
+        while (it.hasNext()) {
+            files.append(it.next());
+        }
+    }
+    QStringList picked;
+    const int step = qMax(1, files.count() / count);
+    for (int i = 0; i < files.count() && picked.count() < count; i += step) {
+        picked.append(files.at(i));
+    }
+    return picked;
+}
+
+void TestResourceItemsModel::addPerFile(ResourceItemsModel &model, ResourceNode *scanned)
+{
+    model.setRoot(nullptr);
+    for (TreeNode *type : scanned->takeChildren()) {
+        const QVector<TreeNode *> groups = type->takeChildren();
+        const QModelIndex typeIndex = model.addNode(static_cast<ResourceNode *>(type));
+        for (TreeNode *group : groups) {
+            const QVector<TreeNode *> files = group->takeChildren();
+            const QModelIndex groupIndex = model.addNode(static_cast<ResourceNode *>(group), typeIndex);
+            for (TreeNode *file : files) {
+                model.addNode(static_cast<ResourceNode *>(file), groupIndex);
+            }
+        }
+    }
+    delete scanned;
+}
+
+TEST_APPLICATION_MAIN(TestResourceItemsModel)
+
+#include "tst_resourceitemsmodel.moc"
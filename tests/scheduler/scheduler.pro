@@ -0,0 +1,7 @@
+include(../tests.pri)
+include(../application.pri)
+
+TARGET = tst_scheduler
+
+SOURCES += \
+    tst_scheduler.cpp
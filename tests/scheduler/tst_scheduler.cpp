@@ -0,0 +1,137 @@
+#include "base/scheduler.h"
+#include "testapplication.h"
+#include <QSignalSpy>
+
+// Tests of the task queue with stub tasks which finish on request. The scheduler starts the tasks
+// synchronously from enqueue() and from the "finished" signal, so the order of starts is checked directly.
+
+class TestScheduler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void deviceLanes();
+    void deviceSlots();
+    void queuePositions();
+    void cancelQueued();
+
+private:
+    class Job : public Tasks::Task
+    {
+    public:
+        void run() override {}
+        void finish() { emit finished(); }
+    };
+
+    Job *enqueue(Scheduler *scheduler, const QString &name, const QString &device = QString());
+
+    QStringList started;
+};
+
+void TestScheduler::init()
+{
+    started.clear();
+    app->settings->setTaskSlots(1);
+    app->settings->setDeviceSlots(1);
+}
+
+void TestScheduler::cleanup()
+{
+    app->settings->setTaskSlots(0);
+    app->settings->setDeviceSlots(1);
+}
+
+void TestScheduler::deviceLanes()
+{
+    // Device tasks don't take the tool slots; each device has a lane of its own:
+
+    Scheduler scheduler;
+    Job *packA = enqueue(&scheduler, "pack A");
+    Job *packB = enqueue(&scheduler, "pack B");
+    Job *installX1 = enqueue(&scheduler, "install X1", "X");
+    Job *installX2 = enqueue(&scheduler, "install X2", "X");
+    Job *installY = enqueue(&scheduler, "install Y", "Y");
+    QCOMPARE(started, QStringList({"pack A", "install X1", "install Y"}));
+
+    installX1->finish();
+    QCOMPARE(started, QStringList({"pack A", "install X1", "install Y", "install X2"}));
+
+    installY->finish();
+    installX2->finish();
+    QCOMPARE(started.count(), 4);
+
+    packA->finish();
+    QCOMPARE(started, QStringList({"pack A", "install X1", "install Y", "install X2", "pack B"}));
+    packB->finish();
+}
+
+void TestScheduler::deviceSlots()
+{
+    // "Preferences/DeviceSlots" limits the concurrent tasks on a single device:
+
+    app->settings->setDeviceSlots(2);
+    Scheduler scheduler;
+    Job *install1 = enqueue(&scheduler, "install 1", "X");
+    Job *install2 = enqueue(&scheduler, "install 2", "X");
+    Job *install3 = enqueue(&scheduler, "install 3", "X");
+    QCOMPARE(started, QStringList({"install 1", "install 2"}));
+
+    install2->finish();
+    QCOMPARE(started, QStringList({"install 1", "install 2", "install 3"}));
+    install1->finish();
+    install3->finish();
+}
+
+void TestScheduler::queuePositions()
+{
+    // Waiting tasks are notified of their queue positions, starting from one; zero stands for the start:
+
+    Scheduler scheduler;
+    Job *packA = enqueue(&scheduler, "pack A");
+    Job *packB = new Job;
+    QSignalSpy queuedB(packB, &Tasks::Task::queued);
+    scheduler.enqueue(packB, [=]() { started.append("pack B"); });
+    Job *packC = new Job;
+    QSignalSpy queuedC(packC, &Tasks::Task::queued);
+    scheduler.enqueue(packC, [=]() { started.append("pack C"); });
+    QCOMPARE(queuedB.last().first().toInt(), 1);
+    QCOMPARE(queuedC.last().first().toInt(), 2);
+
+    packA->finish();
+    QCOMPARE(queuedB.last().first().toInt(), 0);
+    QCOMPARE(queuedC.last().first().toInt(), 1);
+
+    packB->finish();
+    QCOMPARE(queuedC.last().first().toInt(), 0);
+    packC->finish();
+    QCOMPARE(started, QStringList({"pack A", "pack B", "pack C"}));
+}
+
+void TestScheduler::cancelQueued()
+{
+    // Only the waiting tasks can be removed from the queue:
+
+    Scheduler scheduler;
+    Job *packA = enqueue(&scheduler, "pack A");
+    Job *packB = enqueue(&scheduler, "pack B");
+    QVERIFY(!scheduler.cancel(packA));
+    QVERIFY(scheduler.cancel(packB));
+    QVERIFY(!scheduler.cancel(packB));
+
+    packA->finish();
+    QCOMPARE(started, QStringList({"pack A"}));
+    delete packB;
+}
+
+TestScheduler::Job *TestScheduler::enqueue(Scheduler *scheduler, const QString &name, const QString &device)
+{
+    Job *job = new Job;
+    scheduler->enqueue(job, [=]() { started.append(name); }, device);
+    return job;
+}
+
+TEST_APPLICATION_MAIN(TestScheduler)
+
+#include "tst_scheduler.moc"
@@ -0,0 +1,33 @@
+include(../tests.pri)
+
+QT += network concurrent
+QT -= gui
+
+TARGET = tst_signingkey
+
+SOURCES += \
+    tst_signingkey.cpp \
+    $$SRC/tools/apksigner.cpp \
+    $$SRC/tools/der.cpp \
+    $$SRC/tools/executable.cpp \
+    $$SRC/tools/jar.cpp \
+    $$SRC/tools/java.cpp \
+    $$SRC/tools/outputbuffer.cpp \
+    $$SRC/tools/signingkey.cpp \
+    $$SRC/tools/zipalign.cpp \
+    $$SRC/tools/ziparchive.cpp \
+    $$SRC/tools/zipwriter.cpp
+
+HEADERS += \
+    $$SRC/tools/apksigner.h \
+    $$SRC/tools/der.h \
+    $$SRC/tools/executable.h \
+    $$SRC/tools/jar.h \
+    $$SRC/tools/java.h \
+    $$SRC/tools/outputbuffer.h \
+    $$SRC/tools/signingkey.h \
+    $$SRC/tools/zipalign.h \
+    $$SRC/tools/ziparchive.h \
+    $$SRC/tools/zipwriter.h
+
+unix: LIBS += -lz
@@ -0,0 +1,141 @@
+#include "tools/apksigner.h"
+#include "tools/signingkey.h"
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QtTest>
+
+// Known-answer tests of the native signer. The keystores hold 2048-bit RSA keys:
+//   keystore.jks: "first" (key password "android") and "second" (key password "secret"), keystore password "android"
+//   keystore.p12: "first" key under the "release" alias, password "android"
+//   keystore-multiple.p12: "release" and "upload" keys (its MAC is not valid, the keystore is rejected before it's checked)
+// The expected signatures of the message were made with "openssl dgst -sign" from the same keys.
+
+class TestSigningKey : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void signJks_data();
+    void signJks();
+    void rejectJks_data();
+    void rejectJks();
+    void signPkcs12();
+    void rejectPkcs12();
+    void verifyApk();
+
+private:
+    static QByteArray read(const QString &path);
+    static const QByteArray message;
+};
+
+const QByteArray TestSigningKey::message("APK Editor Studio");
+
+void TestSigningKey::signJks_data()
+{
+    QTest::addColumn<QString>("alias");
+    QTest::addColumn<QString>("keyPassword");
+    QTest::addColumn<int>("digest");
+    QTest::addColumn<QString>("expected");
+
+    QTest::newRow("first, SHA-256") << QString("first") << QString("android") << static_cast<int>(SigningKey::Sha256) << QString("first.sha256.sig");
+    QTest::newRow("first, SHA-1") << QString("first") << QString("android") << static_cast<int>(SigningKey::Sha1) << QString("first.sha1.sig");
+    QTest::newRow("second, SHA-256") << QString("second") << QString("secret") << static_cast<int>(SigningKey::Sha256) << QString("second.sha256.sig");
+    QTest::newRow("alias case") << QString("FIRST") << QString("android") << static_cast<int>(SigningKey::Sha256) << QString("first.sha256.sig");
+}
+
+void TestSigningKey::signJks()
+{
+    QFETCH(QString, alias);
+    QFETCH(QString, keyPassword);
+    QFETCH(int, digest);
+    QFETCH(QString, expected);
+
+    SigningKey key;
+    QVERIFY2(key.load(QFINDTESTDATA("data/keystore.jks"), "android", alias, keyPassword), qPrintable(key.getError()));
+    QCOMPARE(key.sign(message, static_cast<SigningKey::Digest>(digest)), read(QFINDTESTDATA("data/" + expected)));
+}
+
+void TestSigningKey::rejectJks_data()
+{
+    QTest::addColumn<QString>("keystorePassword");
+    QTest::addColumn<QString>("alias");
+    QTest::addColumn<QString>("keyPassword");
+
+    QTest::newRow("keystore password") << QString("invalid") << QString("first") << QString("android");
+    QTest::newRow("key password") << QString("android") << QString("second") << QString("android");
+    QTest::newRow("alias") << QString("android") << QString("missing") << QString("android");
+}
+
+void TestSigningKey::rejectJks()
+{
+    QFETCH(QString, keystorePassword);
+    QFETCH(QString, alias);
+    QFETCH(QString, keyPassword);
+
+    SigningKey key;
+    QVERIFY(!key.load(QFINDTESTDATA("data/keystore.jks"), keystorePassword, alias, keyPassword));
+    QVERIFY(!key.getError().isEmpty());
+}
+
+void TestSigningKey::signPkcs12()
+{
+#ifdef QT_NO_SSL
+    QSKIP("PKCS #12 keystores require SSL support.");
+#endif
+    SigningKey key;
+    QVERIFY2(key.load(QFINDTESTDATA("data/keystore.p12"), "android", "release", "android"), qPrintable(key.getError()));
+    QCOMPARE(key.sign(message, SigningKey::Sha256), read(QFINDTESTDATA("data/first.sha256.sig")));
+}
+
+void TestSigningKey::rejectPkcs12()
+{
+    // A key which can't be matched must never be replaced with the first key of the keystore:
+
+    SigningKey unknownAlias;
+    QVERIFY(!unknownAlias.load(QFINDTESTDATA("data/keystore.p12"), "android", "upload", "android"));
+
+    SigningKey separatePassword;
+    QVERIFY(!separatePassword.load(QFINDTESTDATA("data/keystore.p12"), "android", "release", "secret"));
+
+    SigningKey multipleKeys;
+    QVERIFY(!multipleKeys.load(QFINDTESTDATA("data/keystore-multiple.p12"), "android", "release", "android"));
+}
+
+void TestSigningKey::verifyApk()
+{
+    // The signed archive is checked with the reference tool, if it's available:
+    //   APKSIGNER_JAR=/path/to/apksigner.jar make check
+
+    const QString apksigner = qgetenv("APKSIGNER_JAR");
+    if (apksigner.isEmpty()) {
+        QSKIP("Set APKSIGNER_JAR to verify the signed APK with apksigner.");
+    }
+
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    const QString target = directory.path() + "/signed.apk";
+
+    SigningKey key;
+    QVERIFY2(key.load(QFINDTESTDATA("data/keystore.jks"), "android", "second", "secret"), qPrintable(key.getError()));
+    QString error;
+    QVERIFY2(Apksigner::signArchive(QFINDTESTDATA("data/unsigned.apk"), target, key, 4, &error), qPrintable(error));
+
+    QProcess process;
+    process.setProcessChannelMode(QProcess::MergedChannels);
+    process.start("java", {"-jar", apksigner, "verify", "--verbose", "--min-sdk-version", "21", target});
+    QVERIFY(process.waitForFinished(60000));
+    const QString output = QString::fromUtf8(process.readAll());
+    QVERIFY2(process.exitStatus() == QProcess::NormalExit && process.exitCode() == 0, qPrintable(output));
+    QVERIFY2(output.contains("(JAR signing): true"), qPrintable(output));
+    QVERIFY2(output.contains("(APK Signature Scheme v2): true"), qPrintable(output));
+}
+
+QByteArray TestSigningKey::read(const QString &path)
+{
+    QFile file(path);
+    return file.open(QFile::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+QTEST_GUILESS_MAIN(TestSigningKey)
+
+#include "tst_signingkey.moc"
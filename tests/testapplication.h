@@ -0,0 +1,23 @@
+#ifndef TESTAPPLICATION_H
+#define TESTAPPLICATION_H
+
+#include "base/application.h"
+#include <QStandardPaths>
+#include <QtTest>
+
+// Runs the test object within the Application instance. The configuration is written to the test locations
+// (see QStandardPaths::setTestModeEnabled), and no display is required unless QT_QPA_PLATFORM says otherwise.
+
+#define TEST_APPLICATION_MAIN(TestObject) \
+int main(int argc, char *argv[]) \
+{ \
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) { \
+        qputenv("QT_QPA_PLATFORM", "offscreen"); \
+    } \
+    QStandardPaths::setTestModeEnabled(true); \
+    Application application(argc, argv); \
+    TestObject test; \
+    return QTest::qExec(&test, argc, argv); \
+}
+
+#endif // TESTAPPLICATION_H
@@ -0,0 +1,12 @@
+# Common configuration of the test projects. Sources of the application are added by each test project.
+# Usage: qmake tests/tests.pro && make && make check
+
+QT += testlib
+CONFIG += c++11 testcase
+CONFIG -= app_bundle
+
+SRC = $$clean_path($$PWD/../src)
+INCLUDEPATH += $$SRC
+
+DEFINES += APPLICATION='"\\\"APK Editor Studio\\\""'
+DEFINES += VERSION=\\\"test\\\"
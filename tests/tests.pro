@@ -0,0 +1,13 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    apkinfo \
+    apkpatcher \
+    batchrunner \
+    models \
+    resourcefile \
+    resourceitemsmodel \
+    scheduler \
+    signingkey \
+    thumbnailstore \
+    zipalign
@@ -0,0 +1,10 @@
+include(../tests.pri)
+
+TARGET = tst_thumbnailstore
+
+SOURCES += \
+    tst_thumbnailstore.cpp \
+    $$SRC/base/thumbnailstore.cpp
+
+HEADERS += \
+    $$SRC/base/thumbnailstore.h
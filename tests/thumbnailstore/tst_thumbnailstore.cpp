@@ -0,0 +1,108 @@
+#include "base/thumbnailstore.h"
+#include <QTemporaryDir>
+#include <QtTest>
+
+class TestThumbnailStore : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void key();
+    void reopen();
+    void mismatchedIndex();
+
+private:
+    static bool write(const QString &path, const QByteArray &data);
+    static QImage image(const QColor &color);
+};
+
+void TestThumbnailStore::key()
+{
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    const QString path = directory.path() + "/image.png";
+    const QSize size(32, 32);
+
+    // Changes to the beginning and to the end of a large file are noticed:
+
+    QByteArray data(1024 * 1024, 'a');
+    QVERIFY(write(path, data));
+    const QByteArray original = ThumbnailStore::key(path, size);
+    QVERIFY(!original.isEmpty());
+    QCOMPARE(ThumbnailStore::key(path, size), original);
+    QVERIFY(ThumbnailStore::key(path, QSize(64, 64)) != original);
+
+    const QDateTime modified = QFileInfo(path).lastModified();
+    data[0] = 'b';
+    QVERIFY(write(path, data));
+    QFile file(path);
+    QVERIFY(file.open(QFile::ReadWrite) && file.setFileTime(modified, QFileDevice::FileModificationTime));
+    file.close();
+    const QByteArray head = ThumbnailStore::key(path, size);
+    QVERIFY(head != original);
+
+    data[data.size() - 1] = 'b';
+    QVERIFY(write(path, data));
+    QVERIFY(file.open(QFile::ReadWrite) && file.setFileTime(modified, QFileDevice::FileModificationTime));
+    file.close();
+    QVERIFY(ThumbnailStore::key(path, size) != head);
+
+    QVERIFY(ThumbnailStore::key(directory.path() + "/missing.png", size).isEmpty());
+}
+
+void TestThumbnailStore::reopen()
+{
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    const QString path = directory.path() + "/thumbnails";
+
+    {
+        ThumbnailStore store(path, 1024 * 1024);
+        store.write("red", image(Qt::red));
+        store.write("blue", image(Qt::blue));
+    }
+    ThumbnailStore store(path, 1024 * 1024);
+    QCOMPARE(store.read("red").convertToFormat(QImage::Format_RGB32), image(Qt::red));
+    QCOMPARE(store.read("blue").convertToFormat(QImage::Format_RGB32), image(Qt::blue));
+    QVERIFY(store.read("green").isNull());
+}
+
+void TestThumbnailStore::mismatchedIndex()
+{
+    // A pack which doesn't belong to the index (e.g., replaced by the compaction while the index was not saved) is discarded:
+
+    QTemporaryDir first;
+    QTemporaryDir second;
+    QVERIFY(first.isValid() && second.isValid());
+    {
+        ThumbnailStore store(first.path() + "/thumbnails", 1024 * 1024);
+        store.write("red", image(Qt::red));
+    }
+    QTest::qWait(10);
+    {
+        ThumbnailStore store(second.path() + "/thumbnails", 1024 * 1024);
+        store.write("red", image(Qt::blue));
+    }
+    QFile::remove(first.path() + "/thumbnails.idx");
+    QVERIFY(QFile::copy(second.path() + "/thumbnails.idx", first.path() + "/thumbnails.idx"));
+
+    ThumbnailStore store(first.path() + "/thumbnails", 1024 * 1024);
+    QVERIFY(store.read("red").isNull());
+}
+
+bool TestThumbnailStore::write(const QString &path, const QByteArray &data)
+{
+    QFile file(path);
+    return file.open(QFile::WriteOnly) && file.write(data) == data.size();
+}
+
+QImage TestThumbnailStore::image(const QColor &color)
+{
+    QImage image(16, 16, QImage::Format_RGB32);
+    image.fill(color);
+    return image;
+}
+
+QTEST_GUILESS_MAIN(TestThumbnailStore)
+
+#include "tst_thumbnailstore.moc"
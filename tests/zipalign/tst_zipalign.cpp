@@ -0,0 +1,153 @@
+#include "tools/zipalign.h"
+#include "tools/ziparchive.h"
+#include <QProcess>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QtTest>
+
+// Tests of the native aligner on sample archives with stored and compressed entries at unaligned offsets:
+//   plain.apk: sizes in the local headers
+//   descriptors.apk: sizes in the data descriptors (written to a non-seekable stream)
+
+class TestZipalign : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void alignArchive_data();
+    void alignArchive();
+    void skipAligned();
+    void compareWithZipalign_data();
+    void compareWithZipalign();
+
+private:
+    static QByteArray read(const QString &path);
+    static QByteArray read(const ZipArchive &archive, const ZipArchive::Entry &entry);
+};
+
+void TestZipalign::alignArchive_data()
+{
+    QTest::addColumn<QString>("sample");
+
+    QTest::newRow("plain") << QString("plain.apk");
+    QTest::newRow("data descriptors") << QString("descriptors.apk");
+}
+
+void TestZipalign::alignArchive()
+{
+    QFETCH(QString, sample);
+
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    const QString source = QFINDTESTDATA("data/" + sample);
+    const QString target = directory.path() + "/aligned.apk";
+
+    QString error;
+    QVERIFY2(Zipalign::alignArchive(source, target, 4, &error), qPrintable(error));
+    QVERIFY(!Zipalign::isAligned(source, 4));
+    QVERIFY(Zipalign::isAligned(target, 4));
+
+    // Entries must keep their order, attributes and data:
+
+    ZipArchive original(source);
+    ZipArchive aligned(target);
+    QVERIFY2(original.open(), qPrintable(original.getError()));
+    QVERIFY2(aligned.open(), qPrintable(aligned.getError()));
+    QCOMPARE(aligned.getEntries().count(), original.getEntries().count());
+    QCOMPARE(aligned.getComment(), original.getComment());
+    for (int i = 0; i < original.getEntries().count(); ++i) {
+        const ZipArchive::Entry &before = original.getEntries().at(i);
+        const ZipArchive::Entry &after = aligned.getEntries().at(i);
+        QCOMPARE(after.name, before.name);
+        QCOMPARE(after.method, before.method);
+        QCOMPARE(after.crc, before.crc);
+        QCOMPARE(after.compressedSize, before.compressedSize);
+        QCOMPARE(after.uncompressedSize, before.uncompressedSize);
+        QCOMPARE(read(aligned, after), read(original, before));
+        if (after.method == 0) {
+            QCOMPARE(after.dataOffset % 4, Q_INT64_C(0));
+        }
+    }
+}
+
+void TestZipalign::skipAligned()
+{
+    // Archives which are already aligned are not rewritten:
+
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    const QString apk = directory.path() + "/sample.apk";
+    QVERIFY(QFile::copy(QFINDTESTDATA("data/plain.apk"), apk));
+
+    Zipalign first;
+    QSignalSpy firstSuccess(&first, &Executable::success);
+    QSignalSpy firstFinished(&first, &Executable::finished);
+    first.align(apk);
+    QVERIFY(firstFinished.wait());
+    QCOMPARE(firstSuccess.count(), 1);
+    QVERIFY(Zipalign::isAligned(apk, 4));
+
+    const QByteArray aligned = read(apk);
+    const QDateTime modified = QFileInfo(apk).lastModified();
+    QTest::qWait(1100);
+
+    Zipalign second;
+    QSignalSpy secondFinished(&second, &Executable::finished);
+    second.align(apk);
+    QVERIFY(secondFinished.wait());
+    QCOMPARE(read(apk), aligned);
+    QCOMPARE(QFileInfo(apk).lastModified(), modified);
+}
+
+void TestZipalign::compareWithZipalign_data()
+{
+    alignArchive_data();
+}
+
+void TestZipalign::compareWithZipalign()
+{
+    // The output is compared byte for byte with the zipalign binary, if it's available:
+    //   ZIPALIGN=/path/to/zipalign make check
+
+    QFETCH(QString, sample);
+
+    const QString zipalign = qgetenv("ZIPALIGN");
+    if (zipalign.isEmpty()) {
+        QSKIP("Set ZIPALIGN to compare the output with zipalign.");
+    }
+
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    const QString source = QFINDTESTDATA("data/" + sample);
+    const QString expected = directory.path() + "/expected.apk";
+    const QString actual = directory.path() + "/actual.apk";
+
+    QProcess process;
+    process.setProcessChannelMode(QProcess::MergedChannels);
+    process.start(zipalign, {"-f", "4", source, expected});
+    QVERIFY(process.waitForFinished(60000));
+    QVERIFY2(process.exitStatus() == QProcess::NormalExit && process.exitCode() == 0, process.readAll().constData());
+
+    QString error;
+    QVERIFY2(Zipalign::alignArchive(source, actual, 4, &error), qPrintable(error));
+    QCOMPARE(read(actual), read(expected));
+}
+
+QByteArray TestZipalign::read(const QString &path)
+{
+    QFile file(path);
+    return file.open(QFile::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+QByteArray TestZipalign::read(const ZipArchive &archive, const ZipArchive::Entry &entry)
+{
+    QByteArray data;
+    archive.read(entry, [&](const char *chunk, qint64 size) {
+        data.append(chunk, static_cast<int>(size));
+    });
+    return data;
+}
+
+QTEST_GUILESS_MAIN(TestZipalign)
+
+#include "tst_zipalign.moc"
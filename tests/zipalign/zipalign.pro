@@ -0,0 +1,23 @@
+include(../tests.pri)
+
+QT += concurrent
+QT -= gui
+
+TARGET = tst_zipalign
+
+SOURCES += \
+    tst_zipalign.cpp \
+    $$SRC/tools/executable.cpp \
+    $$SRC/tools/outputbuffer.cpp \
+    $$SRC/tools/zipalign.cpp \
+    $$SRC/tools/ziparchive.cpp \
+    $$SRC/tools/zipwriter.cpp
+
+HEADERS += \
+    $$SRC/tools/executable.h \
+    $$SRC/tools/outputbuffer.h \
+    $$SRC/tools/zipalign.h \
+    $$SRC/tools/ziparchive.h \
+    $$SRC/tools/zipwriter.h
+
+unix: LIBS += -lz